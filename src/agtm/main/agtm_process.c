@@ -115,6 +115,10 @@ ProcessAGtmCommand(StringInfo input_message, CommandDest dest)
 			} PG_END_TRY();
 			break;
 
+		case AGTM_MSG_SEQUENCE_GET_RANGE:
+			output = ProcessNextSeqRangeCommand(input_message, &buf);
+			break;
+
 		case AGTM_MSG_SEQUENCE_GET_CUR:
 			output = ProcessCurSeqCommand(input_message, &buf);
 			break;
@@ -56,6 +56,33 @@ ProcessNextSeqCommand(StringInfo message, StringInfo output)
 	return output;
 }
 
+StringInfo
+ProcessNextSeqRangeCommand(StringInfo message, StringInfo output)
+{
+	int64 seq_count;
+	int64 seq_first;
+	int64 seq_last;
+	Datum seq_name_to_oid;
+
+	seq_name_to_oid= prase_to_agtm_sequence_name(message);
+	memcpy(&seq_count, pq_getmsgbytes(message, sizeof(seq_count)),
+		sizeof(seq_count));
+	pq_getmsgend(message);
+
+	if(seq_count <= 0)
+		ereport(ERROR,
+			(errmsg("invalid sequence range size " INT64_FORMAT, seq_count)));
+
+	seq_first = nextval_range_internal(DatumGetObjectId(seq_name_to_oid),
+									   seq_count, &seq_last);
+
+	/* Respond to the client, first and last value of the leased range */
+	RespondSeqToClient(seq_first, AGTM_SEQUENCE_GET_RANGE_RESULT, output);
+	pq_sendbytes(output, (char *)&seq_last, sizeof(seq_last));
+
+	return output;
+}
+
 StringInfo
 ProcessCurSeqCommand(StringInfo message, StringInfo output)
 {
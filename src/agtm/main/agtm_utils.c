@@ -29,6 +29,7 @@ const char *gtm_util_message_name(AGTM_MessageType type)
 	CASE_TYPE_(AGTM_MSG_SEQUENCE_SET_VAL);
 	CASE_TYPE_(AGTM_MSG_SEQUENCE_RESET_CACHE);
 	CASE_TYPE_(AGTM_MSG_GET_STATUS);
+	CASE_TYPE_(AGTM_MSG_SEQUENCE_GET_RANGE);
 	/* here no default, we need a compiler warning */
 	}
 	return "Unknown AGTM_MessageType";
@@ -57,6 +58,7 @@ const char *gtm_util_result_name(AGTM_ResultType type)
 	CASE_TYPE_(AGTM_SEQUENCE_SET_VAL_RESULT);
 	CASE_TYPE_(AGTM_MSG_SEQUENCE_RESET_CACHE_RESULT);
 	CASE_TYPE_(AGTM_COMPLETE_RESULT);
+	CASE_TYPE_(AGTM_SEQUENCE_GET_RANGE_RESULT);
 	/* here no default, we need a compiler warning */
 	}
 	return "Unknown AGTM_ResultType";
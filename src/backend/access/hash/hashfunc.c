@@ -31,9 +31,11 @@
 #ifdef ADB
 #include "catalog/pg_type.h"
 #include "utils/builtins.h"
+#include "utils/fmgroids.h"
 #include "utils/timestamp.h"
 #include "utils/date.h"
 #include "utils/nabstime.h"
+#include "utils/numeric.h"
 #endif
 
 
@@ -645,6 +647,81 @@ compute_hash(Oid type, Datum value, char locator)
 }
 
 
+/*
+ * hash_datum_array()
+ * Hash nvalues values like calling hash function hashfunc on each of them,
+ * without going through fmgr. Fixed-width keys are hashed by a plain loop
+ * over the whole array which the compiler can vectorize, so null values
+ * get a meaningless hash and are left to the caller. Returns false and
+ * leaves hashes alone if hashfunc has no kernel here.
+ */
+bool
+hash_datum_array(Oid hashfunc, const Datum *values, const bool *nulls,
+				 int nvalues, uint32 *hashes)
+{
+	int			i;
+
+#define HASH_UINT32_ARRAY(getkey)								\
+	for (i = 0; i < nvalues; i++)								\
+	{															\
+		uint32		a, b, c;									\
+		a = b = c = 0x9e3779b9 + (uint32) sizeof(uint32) + 3923095;	\
+		a += (getkey);											\
+		final(a, b, c);											\
+		hashes[i] = c;											\
+	}
+
+	switch (hashfunc)
+	{
+		case F_HASHINT2:
+			HASH_UINT32_ARRAY((uint32) (int32) DatumGetInt16(values[i]));
+			break;
+		case F_HASHINT4:
+			HASH_UINT32_ARRAY((uint32) DatumGetInt32(values[i]));
+			break;
+		case F_HASHINT8:
+			/* fold the high half in as hashint8 does */
+			HASH_UINT32_ARRAY((uint32) DatumGetInt64(values[i]) ^
+							  (DatumGetInt64(values[i]) >= 0 ?
+							   (uint32) (DatumGetInt64(values[i]) >> 32) :
+							   ~(uint32) (DatumGetInt64(values[i]) >> 32)));
+			break;
+		case F_HASHTEXT:
+		case F_HASHVARLENA:
+			for (i = 0; i < nvalues; i++)
+			{
+				struct varlena *key;
+
+				if (nulls[i])
+					continue;
+				key = PG_DETOAST_DATUM_PACKED(values[i]);
+				hashes[i] = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(key),
+													VARSIZE_ANY_EXHDR(key)));
+				if ((Pointer) key != DatumGetPointer(values[i]))
+					pfree(key);
+			}
+			break;
+		case F_HASH_NUMERIC:
+			for (i = 0; i < nvalues; i++)
+			{
+				Numeric		key;
+
+				if (nulls[i])
+					continue;
+				key = DatumGetNumeric(values[i]);
+				hashes[i] = numeric_hash_value(key);
+				if ((Pointer) key != DatumGetPointer(values[i]))
+					pfree(key);
+			}
+			break;
+		default:
+			return false;
+	}
+#undef HASH_UINT32_ARRAY
+
+	return true;
+}
+
 /*
  * get_compute_hash_function
  * Get hash function name depending on the hash type.
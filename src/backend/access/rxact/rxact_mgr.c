@@ -23,6 +23,7 @@
 #include "utils/hsearch.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
+#include "utils/timestamp.h"
 #include "utils/tqual.h"
 
 #include <unistd.h>
@@ -64,6 +65,7 @@ typedef struct RxactAgent
 	Oid		dboid;
 	bool	in_error;
 	bool	waiting_gid;
+	bool	waiting_flush;	/* out_buf must wait rxact_flush_lsn flushed */
 	char	last_gid[NAMEDATALEN];
 	StringInfoData out_buf;
 	StringInfoData in_buf;
@@ -118,6 +120,9 @@ static const char rxlf_db_node_filename[] = {"db_node"};
 static const char rxlf_xact_filename[] = {"rxact"};
 static const char rxlf_directory[] = {"pg_rxlog"};
 static StringInfoData rxlf_xlog_buf = {NULL, 0, 0, 0};
+/* last rxact record not flushed yet, and when it must be flushed */
+static XLogRecPtr rxact_flush_lsn = InvalidXLogRecPtr;
+static TimestampTz rxact_flush_time = 0;
 #define MAX_RLOG_FILE_NAME 24
 
 static pgsocket rxact_server_fd = PGINVALID_SOCKET;
@@ -131,6 +136,9 @@ static volatile pgsocket rxact_client_fd = PGINVALID_SOCKET;
 static bool sended_db_info = false;
 static volatile bool rxact_need_exit = false;
 
+/* GUC variable */
+int RxactGroupCommitDelay = 0;
+
 /*
  * Flag to mark SIGHUP. Whenever the main loop comes around it
  * will reread the configuration file. (Better than doing the
@@ -193,6 +201,8 @@ static void rxact_build_2pc_cmd(StringInfo cmd, const char *gid, RemoteXactType
 static void rxact_close_timeout_remote_conn(time_t cur_time);
 static File rxact_log_open_file(const char *log_name, int fileFlags, int fileMode);
 static void rxact_xlog_insert(char *data, int len, uint8 info, bool flush);
+static void rxact_xlog_flush_pending(bool force);
+static void rxact_agent_try_output(RxactAgent *agent);
 static const char* RemoteXactType2String(RemoteXactType type);
 
 /* interface for client */
@@ -235,7 +245,7 @@ CreateRxactAgent(pgsocket agent_fd)
 
 	agent->sock = agent_fd;
 	pg_set_noblock(agent_fd);
-	agent->in_error = agent->waiting_gid = false;
+	agent->in_error = agent->waiting_gid = agent->waiting_flush = false;
 	indexRxactAgent[agentCount++] = agent->index;
 	resetStringInfo(&(agent->in_buf));
 	resetStringInfo(&(agent->out_buf));
@@ -276,6 +286,7 @@ static void RxactLoop(void)
 	pgsocket			agent_fd;
 	int					poll_count;
 	int					max_pool;
+	int					timeout;
 
 	Assert(rxact_server_fd != PGINVALID_SOCKET);
 	if(pg_set_noblock(rxact_server_fd) == false)
@@ -330,7 +341,9 @@ static void RxactLoop(void)
 			}
 
 			pollfds[i+1].fd = agent->sock;
-			if(agent->out_buf.len > agent->out_buf.cursor)
+			if(agent->waiting_flush)
+				pollfds[i+1].events = 0;
+			else if(agent->out_buf.len > agent->out_buf.cursor)
 				pollfds[i+1].events = POLLOUT;
 			else if(agent->waiting_gid == false)
 				pollfds[i+1].events = POLLIN;
@@ -406,8 +419,18 @@ re_poll_:
 				continue;
 			}
 		}
-		/* for we wait 1 second */
-		pollres = poll(pollfds, poll_count, 1000);
+		/* for we wait 1 second, or until pending rxact records must be flushed */
+		if(XLogRecPtrIsInvalid(rxact_flush_lsn))
+		{
+			timeout = 1000;
+		}else
+		{
+			long	secs;
+			int		usecs;
+			TimestampDifference(GetCurrentTimestamp(), rxact_flush_time, &secs, &usecs);
+			timeout = (int)(secs * 1000 + (usecs + 999) / 1000);
+		}
+		pollres = poll(pollfds, poll_count, timeout);
 		CHECK_FOR_INTERRUPTS();
 
 		if (pollres < 0)
@@ -499,6 +522,9 @@ re_poll_:
 			}
 		}
 
+		/* acknowledge agents only once their records are durable */
+		rxact_xlog_flush_pending(false);
+
 		rxact_2pc_do();
 
 		cur_time = time(NULL);
@@ -928,7 +954,7 @@ static void rxact_agent_end_msg(RxactAgent *agent, StringInfo msg)
 		rxact_put_finsh(msg, false);
 		appendBinaryStringInfo(&(agent->out_buf), msg->data, msg->len);
 		if(need_try)
-			rxact_agent_output(agent);
+			rxact_agent_try_output(agent);
 	}
 	pfree(msg->data);
 }
@@ -958,7 +984,7 @@ static void rxact_agent_simple_msg(RxactAgent *agent, char msg_type)
 	msg.str[4] = msg_type;
 	appendBinaryStringInfo(&(agent->out_buf), msg.str, 5);
 	if(need_try)
-		rxact_agent_output(agent);
+		rxact_agent_try_output(agent);
 }
 
 /* true for recv some data, false for closed by remote */
@@ -1165,6 +1191,19 @@ static void agent_error_hook(void *arg)
 	}
 }
 
+/*
+ * send out_buf of agent now, unless rxact records are waiting for flush;
+ * then it is sent by rxact_xlog_flush_pending after they are durable
+ */
+static void rxact_agent_try_output(RxactAgent *agent)
+{
+	AssertArg(agent);
+	if(!XLogRecPtrIsInvalid(rxact_flush_lsn))
+		agent->waiting_flush = true;
+	else if(agent->waiting_flush == false)
+		rxact_agent_output(agent);
+}
+
 static void rxact_agent_output(RxactAgent *agent)
 {
 	ssize_t send_res;
@@ -1283,6 +1322,7 @@ static void rxact_agent_mark(RxactAgent *agent, StringInfo msg, bool success)
 static void rxact_agent_checkpoint(RxactAgent *agent, StringInfo msg)
 {
 	int flags = rxact_get_int(msg);
+	rxact_xlog_flush_pending(true);
 	RxactSaveLog(flags & CHECKPOINT_IMMEDIATE ? false:true);
 	rxact_agent_simple_msg(agent, RXACT_MSG_OK);
 }
@@ -2022,6 +2062,11 @@ static File rxact_log_open_file(const char *log_name, int fileFlags, int fileMod
 	return rfile;
 }
 
+/*
+ * A record need flush is not flushed at once, all records inserted
+ * in the same loop of RxactLoop (and within rxact_group_commit_delay)
+ * are flushed together by rxact_xlog_flush_pending.
+ */
 static void rxact_xlog_insert(char *data, int len, uint8 info, bool flush)
 {
 	XLogRecPtr xptr;
@@ -2029,7 +2074,43 @@ static void rxact_xlog_insert(char *data, int len, uint8 info, bool flush)
 	XLogRegisterData(data, len);
 	xptr = XLogInsert(RM_RXACT_MGR_ID, info);
 	if(flush)
-		XLogFlush(xptr);
+	{
+		if(XLogRecPtrIsInvalid(rxact_flush_lsn))
+			rxact_flush_time = TimestampTzPlusMilliseconds(GetCurrentTimestamp(),
+														   RxactGroupCommitDelay);
+		rxact_flush_lsn = xptr;
+	}
+}
+
+/*
+ * flush pending rxact records if it is time or "force",
+ * then send the replies of agents waiting for them
+ */
+static void rxact_xlog_flush_pending(bool force)
+{
+	RxactAgent *agent;
+	Index index;
+	unsigned int i;
+
+	if(XLogRecPtrIsInvalid(rxact_flush_lsn))
+		return;
+
+	if(!force && GetCurrentTimestamp() < rxact_flush_time)
+		return;
+
+	XLogFlush(rxact_flush_lsn);
+	rxact_flush_lsn = InvalidXLogRecPtr;
+
+	for(i = agentCount; i--;)
+	{
+		index = indexRxactAgent[i];
+		agent = &allRxactAgent[index];
+		if(agent->waiting_flush == false)
+			continue;
+		agent->waiting_flush = false;
+		if(agent->out_buf.len > agent->out_buf.cursor)
+			rxact_agent_output(agent);
+	}
 }
 
 static const char* RemoteXactType2String(RemoteXactType type)
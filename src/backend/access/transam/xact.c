@@ -2306,6 +2306,12 @@ StartTransaction(void)
 	 * initialize node executor for new transaction if necessary
 	 */
 	AtStart_NodeExecutor();
+
+	/*
+	 * see our own writes committed asynchronously
+	 */
+	if (IsCoordMaster())
+		WaitAsyncCommitPrepared();
 #endif
 
 	ShowTransactionState("StartTransaction");
@@ -2332,16 +2338,37 @@ StartCommitRemoteXact(TransactionState state)
 		return ;
 
 	is = state->interXactState;
+	if (is && is->need_xact_block &&
+		XactLastRecEnd == InvalidXLogRecPtr &&
+		!MyXactAccessedTempRel &&
+		InterXactCanOnePhaseCommit(is))
+	{
+		/*
+		 * Nothing is written here and at most one remote node written,
+		 * so there is nothing to agree on: commit the remote nodes
+		 * directly, only AGTM is left to EndCommitRemoteXact.
+		 */
+		InterXactOnePhaseCommit(is);
+	} else
 	if (is && is->need_xact_block)
 	{
 		Oid	   *nodes;
 		int		count;
-		TransactionId xid = GetTopTransactionId();
+		TransactionId xid;
+
+		/*
+		 * Remote nodes which only read are committed now, only the
+		 * written ones are prepared and logged in the remote xact manager.
+		 */
+		InterXactCommitReadOnly(is);
+		nodes = InterXactBeginNodes(is, false, &count);
+		if (count == 0)
+			return ;
 
+		xid = GetTopTransactionId();
 		is->implicit = true;
 		InterXactSetXID(is, xid);
 
-		nodes = InterXactBeginNodes(is, false, &count);
 		StartRemoteXactPrepare(is->gid, nodes, count);
 		EndRemoteXactPrepareExt(xid, is->gid, nodes, count, true);
 		SetXactPhaseTwo(state);
@@ -2373,7 +2400,8 @@ EndCommitRemoteXact(TransactionState state)
 	{
 		Assert(is);
 		PreventTransactionChain(true, "COMMIT IMPLICIT PREPARED");
-		EndFinishPreparedRxact(is->gid, nodecnt, nodeIds, false, true);
+		if (!AsyncCommitPrepared || !EndFinishPreparedRxactAsync(is->gid))
+			EndFinishPreparedRxact(is->gid, nodecnt, nodeIds, false, true);
 		SetXactPhaseOne(state);
 	} else
 	{
@@ -2410,10 +2438,6 @@ CommitTransaction(void)
 			 TransStateAsString(s->state));
 	Assert(s->parent == NULL);
 
-#if defined(ADB)
-	StartCommitRemoteXact(s);
-#endif
-
 	/*
 	 * Do pre-commit processing that involves calling user-defined code, such
 	 * as triggers.  Since closing cursors could queue trigger actions,
@@ -2476,6 +2500,15 @@ CommitTransaction(void)
 	 */
 	PreCommit_Notify();
 
+#if defined(ADB)
+	/*
+	 * Prepare or commit remote nodes after all pre-commit processing above,
+	 * which may still write or fail. A remote node committed by one-phase
+	 * commit can not roll back any more.
+	 */
+	StartCommitRemoteXact(s);
+#endif
+
 	/* Prevent cancel/die interrupt while cleaning up */
 	HOLD_INTERRUPTS();
 
@@ -84,12 +84,14 @@
 #include "commands/dbcommands.h"
 #include "intercomm/inter-node.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/clauses.h"
 #include "optimizer/reduceinfo.h"
 #include "parser/parse_func.h"
 #include "pgxc/locator.h"
 #include "pgxc/nodemgr.h"
 #include "pgxc/pgxc.h"
 #include "pgxc/pgxcnode.h"
+#include "utils/typcache.h"
 
 extern bool distribute_by_replication_default;
 #endif
@@ -1329,6 +1331,102 @@ GetUserDefinedDistribution(Oid relid,
 	pfree(funcargs);
 }
 
+/*
+ * GetRangeDistributionBounds
+ * Evaluate the bounds given to DISTRIBUTE BY RANGE(column, bound, ...) as
+ * constants of the column type, they have to be strictly increasing.
+ */
+static ArrayType *
+GetRangeDistributionBounds(DistributeBy *distributeby, Form_pg_attribute attr)
+{
+	ParseState *pstate;
+	TypeCacheEntry *typentry;
+	ListCell   *lc;
+	Datum	   *values;
+	Oid			typid;
+	int32		typmod;
+	int			nbounds;
+	int			i;
+
+	Assert(distributeby->disttype == DISTTYPE_RANGE);
+
+	/* Bounds are kept in the base type of a domain */
+	typmod = attr->atttypmod;
+	typid = getBaseTypeAndTypmod(attr->atttypid, &typmod);
+	typentry = lookup_type_cache(typid, TYPECACHE_CMP_PROC_FINFO);
+	if (!OidIsValid(typentry->cmp_proc_finfo.fn_oid) ||
+		!OidIsValid(get_array_type(typid)))
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("Column %s is not a range distributable data type",
+						distributeby->colname)));
+
+	/* The first argument is the column */
+	nbounds = list_length(distributeby->funcargs) - 1;
+	values = (Datum *) palloc(sizeof(Datum) * (nbounds + 1));
+
+	pstate = make_parsestate(NULL);
+	i = 0;
+	for_each_cell(lc, lnext(list_head(distributeby->funcargs)))
+	{
+		Node	   *expr;
+
+		expr = transformExpr(pstate, lfirst(lc), EXPR_KIND_OTHER);
+		expr = coerce_to_target_type(pstate, expr, exprType(expr),
+									 typid, typmod,
+									 COERCION_ASSIGNMENT,
+									 COERCE_IMPLICIT_CAST,
+									 -1);
+		if (expr == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATATYPE_MISMATCH),
+					 errmsg("range bound %d cannot be coerced to type %s",
+							i + 1, format_type_be(typid))));
+		assign_expr_collations(pstate, expr);
+		expr = eval_const_expressions(NULL, expr);
+
+		if (!IsA(expr, Const))
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+					 errmsg("range bound %d is not a constant", i + 1)));
+		if (((Const *) expr)->constisnull)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+					 errmsg("range bound %d cannot be NULL", i + 1)));
+		values[i] = ((Const *) expr)->constvalue;
+
+		if (i > 0 &&
+			DatumGetInt32(FunctionCall2Coll(&typentry->cmp_proc_finfo,
+											attr->attcollation,
+											values[i - 1],
+											values[i])) >= 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+					 errmsg("range bounds must be strictly increasing")));
+		i++;
+	}
+	free_parsestate(pstate);
+
+	return construct_array(values, nbounds, typid,
+						   typentry->typlen, typentry->typbyval,
+						   typentry->typalign);
+}
+
+/*
+ * CheckRangeDistributionBounds
+ * A range distributed table gives one range to each of its nodes, all
+ * bounded above by a bound but the last one.
+ */
+void
+CheckRangeDistributionBounds(int numbounds, int numnodes)
+{
+	if (numbounds != numnodes - 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+				 errmsg("range distribution on %d nodes needs %d bounds, but %d given",
+						numnodes, numnodes - 1, numbounds)));
+}
+
 /* --------------------------------
 *	   AddRelationDistribution
 *
@@ -1353,6 +1451,7 @@ AddRelationDistribution(Oid relid,
 	Oid				funcid = InvalidOid;
 	int				numatts = 0;
 	int16		   *attnums = NULL;
+	ArrayType	   *rangebounds = NULL;
 
 	/* Obtain details of nodes and classify them */
 	if (IsDnNode())
@@ -1374,7 +1473,14 @@ AddRelationDistribution(Oid relid,
 								 &attnum,
 								 &funcid,
 								 &numatts,
-								 &attnums);
+								 &attnums,
+								 &rangebounds);
+
+	/* Datanodes have no node list to check the bounds with */
+	if (locatortype == LOCATOR_TYPE_RANGE && numnodes > 0)
+		CheckRangeDistributionBounds(ArrayGetNItems(ARR_NDIM(rangebounds),
+													ARR_DIMS(rangebounds)),
+									 numnodes);
 
 	/*
 	 * 1st column of auxiliary table is default auxiliary column,
@@ -1385,7 +1491,9 @@ AddRelationDistribution(Oid relid,
 		switch (locatortype)
 		{
 			case LOCATOR_TYPE_HASH:
+			case LOCATOR_TYPE_HASHMAP:
 			case LOCATOR_TYPE_MODULO:
+			case LOCATOR_TYPE_RANGE:
 				if (attnum != 1)
 					ereport(ERROR,
 							(errmsg("distribute column of auxiliary table should be auxiliary column")));
@@ -1402,7 +1510,6 @@ AddRelationDistribution(Oid relid,
 			case LOCATOR_TYPE_REPLICATED:
 				/* It is OK */
 				break;
-			case LOCATOR_TYPE_RANGE:
 			case LOCATOR_TYPE_CUSTOM:
 				/* Not support yet */
 				break;
@@ -1416,7 +1523,8 @@ AddRelationDistribution(Oid relid,
 
 	/* Now OK to insert data in catalog */
 	PgxcClassCreate(relid, locatortype, attnum, hashalgorithm,
-					hashbuckets, numnodes, nodeoids, funcid, numatts, attnums);
+					hashbuckets, numnodes, nodeoids, funcid, numatts, attnums,
+					rangebounds);
 
 	/* Make dependency entries */
 	myself.classId = PgxcClassRelationId;
@@ -1452,7 +1560,8 @@ GetRelationDistributionItems(Oid relid,
 							AttrNumber *attnum,
 							Oid *funcid,
 							int *numatts,
-							int16 **attnums)
+							int16 **attnums,
+							ArrayType **rangebounds)
 {
 	int local_hashalgorithm = 0;
 	int local_hashbuckets = 0;
@@ -1518,6 +1627,26 @@ GetRelationDistributionItems(Oid relid,
 				local_locatortype = LOCATOR_TYPE_HASH;
 				break;
 
+			case DISTTYPE_HASHMAP:
+				/* Same checks as hash, the column value is hashed the same way */
+				local_attnum = get_attnum(relid, distributeby->colname);
+				if (local_attnum <= 0 && local_attnum >= -(int) lengthof(SysAtt))
+				{
+					ereport(ERROR,
+							(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+							 errmsg("Invalid distribution column specified")));
+				}
+
+				if (!IsTypeDistributable(descriptor->attrs[local_attnum - 1]->atttypid))
+				{
+					ereport(ERROR,
+							(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+							 errmsg("Column %s is not a hash distributable data type",
+							 distributeby->colname)));
+				}
+				local_locatortype = LOCATOR_TYPE_HASHMAP;
+				break;
+
 			case DISTTYPE_MODULO:
 				{
 					Oid disttypid;
@@ -1544,6 +1673,25 @@ GetRelationDistributionItems(Oid relid,
 				}
 				break;
 
+			case DISTTYPE_RANGE:
+				/*
+				 * Validate user specified range column.
+				 * System columns cannot be used.
+				 */
+				local_attnum = get_attnum(relid, distributeby->colname);
+				if (local_attnum <= 0 && local_attnum >= -(int) lengthof(SysAtt))
+				{
+					ereport(ERROR,
+							(errcode(ERRCODE_INVALID_TABLE_DEFINITION),
+							 errmsg("Invalid distribution column specified")));
+				}
+
+				if (rangebounds)
+					*rangebounds = GetRangeDistributionBounds(distributeby,
+										descriptor->attrs[local_attnum - 1]);
+				local_locatortype = LOCATOR_TYPE_RANGE;
+				break;
+
 			case DISTTYPE_REPLICATION:
 				local_locatortype = LOCATOR_TYPE_REPLICATED;
 				break;
@@ -1578,6 +1726,11 @@ GetRelationDistributionItems(Oid relid,
 		local_hashalgorithm = 1;
 		local_hashbuckets = HASH_SIZE;
 	}
+	else if (local_locatortype == LOCATOR_TYPE_HASHMAP)
+	{
+		local_hashalgorithm = 1;
+		local_hashbuckets = HASHMAP_BUCKETS;
+	}
 
 	/* Save results */
 	if (attnum)
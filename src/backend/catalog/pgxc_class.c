@@ -27,6 +27,11 @@
 #include "pgxc/locator.h"
 #include "utils/array.h"
 
+static int2vector *BuildHashmapBucketMap(int numbuckets,
+										 oidvector *oldnodes,
+										 int2vector *oldmap,
+										 Oid *nodes,
+										 int numnodes);
 
 /*
  * PgxcClassCreate
@@ -42,7 +47,8 @@ PgxcClassCreate(Oid pcrelid,
 				Oid *nodes,
 				Oid pcfuncid,
 				int numatts,
-				int16 *pcfuncattnums)
+				int16 *pcfuncattnums,
+				ArrayType *pcrangebounds)
 {
 	Relation	pgxcclassrel;
 	HeapTuple	htup;
@@ -50,6 +56,7 @@ PgxcClassCreate(Oid pcrelid,
 	Datum		values[Natts_pgxc_class];
 	oidvector  *nodes_array;
 	int2vector *attrs_array;
+	int2vector *bucketmap = NULL;
 
 	if (!OidIsValid(pcrelid))
 	{
@@ -66,13 +73,34 @@ PgxcClassCreate(Oid pcrelid,
 	values[Anum_pgxc_class_pcrelid - 1]   = ObjectIdGetDatum(pcrelid);
 	values[Anum_pgxc_class_pclocatortype - 1] = CharGetDatum(pclocatortype);
 
-	if (pclocatortype == LOCATOR_TYPE_HASH || pclocatortype == LOCATOR_TYPE_MODULO)
+	if (pclocatortype == LOCATOR_TYPE_HASH ||
+		pclocatortype == LOCATOR_TYPE_HASHMAP ||
+		pclocatortype == LOCATOR_TYPE_MODULO ||
+		pclocatortype == LOCATOR_TYPE_RANGE)
 	{
 		values[Anum_pgxc_class_pcattnum - 1] = UInt16GetDatum(pcattnum);
 		values[Anum_pgxc_class_pchashalgorithm - 1] = UInt16GetDatum(pchashalgorithm);
 		values[Anum_pgxc_class_pchashbuckets - 1] = UInt16GetDatum(pchashbuckets);
 	}
 
+	/* Buckets of a new hashmap table are spread evenly over its nodes */
+	if (pclocatortype == LOCATOR_TYPE_HASHMAP)
+		bucketmap = BuildHashmapBucketMap(pchashbuckets, NULL, NULL,
+										  nodes, numnodes);
+	if (bucketmap)
+		values[Anum_pgxc_class_pcbucketmap - 1] = PointerGetDatum(bucketmap);
+	else
+		nulls[Anum_pgxc_class_pcbucketmap - 1] = true;
+
+	if (pclocatortype == LOCATOR_TYPE_RANGE)
+	{
+		Assert(pcrangebounds);
+		values[Anum_pgxc_class_pcrangebounds - 1] = PointerGetDatum(pcrangebounds);
+	} else
+	{
+		nulls[Anum_pgxc_class_pcrangebounds - 1] = true;
+	}
+
 	/* Node information */
 	values[Anum_pgxc_class_nodes - 1] = PointerGetDatum(nodes_array);
 
@@ -121,12 +149,15 @@ PgxcClassAlter(Oid pcrelid,
 			   PgxcClassAlterType type,
 			   Oid pcfuncid,
 			   int numatts,
-			   int16 *pcfuncattnums)
+			   int16 *pcfuncattnums,
+			   ArrayType *pcrangebounds)
 {
 	Relation	rel;
 	HeapTuple	oldtup, newtup;
+	Form_pgxc_class oldform;
 	oidvector  *nodes_array;
 	int2vector	*attrs_array = NULL;
+	char		new_locatortype;
 
 	Datum		new_record[Natts_pgxc_class];
 	bool		new_record_nulls[Natts_pgxc_class];
@@ -140,6 +171,7 @@ PgxcClassAlter(Oid pcrelid,
 
 	if (!HeapTupleIsValid(oldtup)) /* should not happen */
 		elog(ERROR, "cache lookup failed for pgxc_class %u", pcrelid);
+	oldform = (Form_pgxc_class) GETSTRUCT(oldtup);
 
 	/* Build array of Oids to be inserted */
 	nodes_array = buildoidvector(nodes, numnodes);
@@ -159,6 +191,8 @@ PgxcClassAlter(Oid pcrelid,
 			new_record_repl[Anum_pgxc_class_pchashbuckets - 1] = true;
 			new_record_repl[Anum_pgxc_class_pcfuncid - 1] = true;
 			new_record_repl[Anum_pgxc_class_pcfuncattnums - 1] = true;
+			new_record_repl[Anum_pgxc_class_pcbucketmap - 1] = true;
+			new_record_repl[Anum_pgxc_class_pcrangebounds - 1] = true;
 			break;
 		case PGXC_CLASS_ALTER_NODES:
 			new_record_repl[Anum_pgxc_class_nodes - 1] = true;
@@ -173,8 +207,16 @@ PgxcClassAlter(Oid pcrelid,
 			new_record_repl[Anum_pgxc_class_nodes - 1] = true;
 			new_record_repl[Anum_pgxc_class_pcfuncid - 1] = true;
 			new_record_repl[Anum_pgxc_class_pcfuncattnums - 1] = true;
+			new_record_repl[Anum_pgxc_class_pcbucketmap - 1] = true;
+			new_record_repl[Anum_pgxc_class_pcrangebounds - 1] = true;
 	}
 
+	/* Bucket map of a hashmap table follows the changes of its nodes */
+	new_locatortype = new_record_repl[Anum_pgxc_class_pclocatortype - 1] ?
+					  pclocatortype : oldform->pclocatortype;
+	if (new_locatortype == LOCATOR_TYPE_HASHMAP)
+		new_record_repl[Anum_pgxc_class_pcbucketmap - 1] = true;
+
 	/* Set up new fields */
 	/* Relation Oid */
 	if (new_record_repl[Anum_pgxc_class_pcrelid - 1])
@@ -242,6 +284,61 @@ PgxcClassAlter(Oid pcrelid,
 		}
 	}
 
+	if (new_record_repl[Anum_pgxc_class_pcbucketmap - 1])
+	{
+		int2vector *bucketmap = NULL;
+
+		if (new_locatortype == LOCATOR_TYPE_HASHMAP)
+		{
+			oidvector  *oldnodes = &oldform->nodeoids;
+			int2vector *oldmap = NULL;
+			int			numbuckets;
+			Datum		datum;
+			bool		isnull;
+
+			numbuckets = new_record_repl[Anum_pgxc_class_pchashbuckets - 1] ?
+						 pchashbuckets : oldform->pchashbuckets;
+
+			/*
+			 * Keep the buckets of a table already distributed by hashmap
+			 * where they are, only the buckets of removed nodes and the
+			 * share of added nodes get a new owner.
+			 */
+			datum = heap_getattr(oldtup, Anum_pgxc_class_pcbucketmap,
+								 RelationGetDescr(rel), &isnull);
+			if (!isnull &&
+				oldform->pclocatortype == LOCATOR_TYPE_HASHMAP &&
+				oldform->pchashbuckets == numbuckets)
+				oldmap = (int2vector *) DatumGetPointer(datum);
+
+			if (!new_record_repl[Anum_pgxc_class_nodes - 1])
+				nodes_array = oldnodes;
+
+			bucketmap = BuildHashmapBucketMap(numbuckets,
+											  oldmap ? oldnodes : NULL,
+											  oldmap,
+											  nodes_array->values,
+											  nodes_array->dim1);
+		}
+
+		if (bucketmap)
+			new_record[Anum_pgxc_class_pcbucketmap - 1] = PointerGetDatum(bucketmap);
+		else
+			new_record_nulls[Anum_pgxc_class_pcbucketmap - 1] = true;
+	}
+
+	if (new_record_repl[Anum_pgxc_class_pcrangebounds - 1])
+	{
+		if (pclocatortype == LOCATOR_TYPE_RANGE)
+		{
+			Assert(pcrangebounds);
+			new_record[Anum_pgxc_class_pcrangebounds - 1] = PointerGetDatum(pcrangebounds);
+		} else
+		{
+			new_record_nulls[Anum_pgxc_class_pcrangebounds - 1] = true;
+		}
+	}
+
 	/* Update relation */
 	newtup = heap_modify_tuple(oldtup, RelationGetDescr(rel),
 							   new_record,
@@ -252,6 +349,118 @@ PgxcClassAlter(Oid pcrelid,
 	heap_close(rel, RowExclusiveLock);
 }
 
+/*
+ * BuildHashmapBucketMap
+ *		Assign each bucket of a hashmap table to one of the given nodes
+ *
+ * Every node gets numbuckets / numnodes buckets, rounded up for some of them.
+ * When the table already had a bucket map on oldnodes, a bucket stays on
+ * its node as long as that node is kept and is not above its share, so that
+ * changing the nodes of a table moves as few buckets as possible.
+ * Returns NULL when there is no node.
+ *
+ * The new map takes effect at once. ALTER TABLE moves the rows of all the
+ * reassigned buckets in one step while it holds the table, see
+ * pgxc_redist_build_reduce(); buckets are not moved one by one while the
+ * table stays in use.
+ */
+static int2vector *
+BuildHashmapBucketMap(int numbuckets,
+					  oidvector *oldnodes,
+					  int2vector *oldmap,
+					  Oid *nodes,
+					  int numnodes)
+{
+	int16	   *map;
+	int		   *count;
+	int		   *share;
+	int			extra;
+	int			i, j, b;
+	int2vector *result;
+
+	/* Datanodes keep no node list for a table, nor a bucket map */
+	if (numnodes == 0)
+		return NULL;
+
+	Assert(numbuckets > 0);
+	Assert(oldmap == NULL || oldmap->dim1 == numbuckets);
+
+	map = (int16 *) palloc(sizeof(int16) * numbuckets);
+	count = (int *) palloc0(sizeof(int) * numnodes);
+	share = (int *) palloc(sizeof(int) * numnodes);
+
+	/* Find the current node of each bucket in the new node list */
+	for (b = 0; b < numbuckets; b++)
+	{
+		map[b] = -1;
+		if (oldmap == NULL)
+			continue;
+		Assert(oldmap->values[b] >= 0 && oldmap->values[b] < oldnodes->dim1);
+		for (i = 0; i < numnodes; i++)
+		{
+			if (nodes[i] == oldnodes->values[oldmap->values[b]])
+			{
+				map[b] = (int16) i;
+				count[i]++;
+				break;
+			}
+		}
+	}
+
+	/*
+	 * Compute the share of each node, the rounded-up shares going first to
+	 * the nodes already holding more buckets than that.
+	 */
+	extra = numbuckets % numnodes;
+	for (i = 0; i < numnodes; i++)
+	{
+		share[i] = numbuckets / numnodes;
+		if (extra > 0 && count[i] > share[i])
+		{
+			share[i]++;
+			extra--;
+		}
+	}
+	for (i = 0; i < numnodes && extra > 0; i++)
+	{
+		if (share[i] == numbuckets / numnodes)
+		{
+			share[i]++;
+			extra--;
+		}
+	}
+
+	/* Release the buckets above the share of their node */
+	for (b = numbuckets - 1; b >= 0; b--)
+	{
+		if (map[b] >= 0 && count[map[b]] > share[map[b]])
+		{
+			count[map[b]]--;
+			map[b] = -1;
+		}
+	}
+
+	/* And give the free buckets to the nodes below their share */
+	for (b = 0, j = 0; b < numbuckets; b++)
+	{
+		if (map[b] >= 0)
+			continue;
+		while (count[j] >= share[j])
+			j++;
+		Assert(j < numnodes);
+		map[b] = (int16) j;
+		count[j]++;
+	}
+
+	result = buildint2vector(map, numbuckets);
+
+	pfree(map);
+	pfree(count);
+	pfree(share);
+
+	return result;
+}
+
 /*
  * RemovePGXCClass():
  *		Remove extended PGXC information
@@ -664,6 +664,9 @@ CREATE VIEW pg_stat_activity AS
     WHERE S.datid = D.oid AND
             S.usesysid = U.oid;
 
+CREATE VIEW pg_stat_pool AS
+    SELECT * FROM pg_stat_get_pool();
+
 CREATE VIEW pg_stat_replication AS
     SELECT
             S.pid,
@@ -394,11 +394,12 @@ QueryRewriteAuxStmt(Query *auxquery)
 						 		"not supported yet")));
 			break;
 		case LOCATOR_TYPE_HASH:
+		case LOCATOR_TYPE_HASHMAP:
+		case LOCATOR_TYPE_RANGE:
 		case LOCATOR_TYPE_MODULO:
 			/* it is OK */
 			break;
 		case LOCATOR_TYPE_CUSTOM:
-		case LOCATOR_TYPE_RANGE:
 			/* not support yet */
 			break;
 		case LOCATOR_TYPE_NONE:
@@ -49,6 +49,7 @@
 #include "utils/snapmgr.h"
 
 #ifdef ADB
+#include "access/tuptoaster.h"
 #include "access/tuptypeconvert.h"
 #include "catalog/heap.h"
 #include "executor/clusterReceiver.h"
@@ -57,11 +58,13 @@
 #include "libpq/libpq-fe.h"
 #include "optimizer/reduceinfo.h"
 #include "parser/analyze.h"
+#include "pgxc/locator.h"
 #include "pgxc/pgxc.h"
 #include "reduce/adb_reduce.h"
 #include "storage/buffile.h"
 #include "storage/bufmgr.h"
 #include "storage/mem_toc.h"
+#include "utils/datum.h"
 #endif
 
 #define ISOCTAL(c) (((c) >= '0') && ((c) <= '7'))
@@ -129,6 +132,42 @@ typedef struct AuxiliaryRelCopy
 #define AUX_REL_COPY_INFO	0x1
 #define AUX_REL_MAIN_NODES	0x2
 
+/*
+ * Rows sent to a Datanode by COPY FROM on Coordinator are gathered into
+ * one CopyData message until it reaches this size. Each row message starts
+ * with its MinimalTuple length, so Datanode can split them again.
+ */
+#define COPY_FROM_BATCH_SIZE	(64 * 1024)
+
+typedef struct CopyFromBatch
+{
+	PGconn		   *conn;
+	StringInfoData	buf;
+}CopyFromBatch;
+
+/*
+ * Rows of a table distributed by the value of one column are routed in
+ * groups of COPY_FROM_ROUTE_ROWS rows by GetRelationNodeIndexes, instead of
+ * evaluating the reduce expression once for each row.
+ */
+#define COPY_FROM_ROUTE_ROWS	1024
+
+typedef struct CopyFromRoute
+{
+	MemoryContext	context;		/* distribution values of the group */
+	PGconn		  **conns;			/* connection of each index in nodeids */
+	Oid				typid;			/* type of the distribution column */
+	int16			typlen;
+	bool			typbyval;
+	AttrNumber		attnum;
+	int				nrows;
+	Datum			values[COPY_FROM_ROUTE_ROWS];
+	bool			nulls[COPY_FROM_ROUTE_ROWS];
+	int				node_indexes[COPY_FROM_ROUTE_ROWS];
+	int				offsets[COPY_FROM_ROUTE_ROWS + 1];	/* of rows in buf */
+	StringInfoData	buf;			/* serialized rows of the group */
+}CopyFromRoute;
+
 #endif /* ADB */
 
 /*
@@ -270,6 +309,9 @@ typedef struct CopyStateData
 	List			*list_connect;	/* list of pg_conn */
 	uint64			count_tuple;	/* count tuple(s) read */
 	int				exec_cluster_flag;
+	bool			next_row_owned;	/* NextRowFrom returns a tuple palloc'd in
+									 * current context, no copy needed */
+	bool			parallel;		/* each Datanode COPY TO its own file */
 #endif
 } CopyStateData;
 
@@ -402,7 +444,14 @@ static void CopySendInt16(CopyState cstate, int16 val);
 static bool CopyGetInt16(CopyState cstate, int16 *val);
 
 #ifdef ADB
+static void InitCoordinatorCopyFrom(CopyState cstate);
 static uint64 CoordinatorCopyFrom(CopyState cstate);
+static void SerializeCopyFromRow(StringInfo buf, TupleTableSlot *slot, TupleDesc desc);
+static CopyFromBatch* GetCopyFromBatch(CopyFromBatch *batches, int *nbatch, int max_batch, PGconn *conn);
+static void SendCopyFromBatch(CopyFromBatch *batch);
+static CopyFromRoute* MakeCopyFromRoute(Relation rel);
+static void SendCopyFromRoute(CopyFromRoute *route, RelationLocInfo *loc_info,
+							  CopyFromBatch *batches, int *nbatch, int max_batch);
 static TupleTableSlot* NextLineCallTrigger(CopyState cstate, ExprContext *econtext, void *data);
 static TupleTableSlot* NextRowFromTuplestore(CopyState cstate, ExprContext *econtext, void *data);
 static TupleTableSlot* AddNumberNextCopyFrom(CopyState cstate, ExprContext *econtext, void *data);
@@ -410,6 +459,11 @@ static TupleTableSlot* NextRowFromCoordinator(CopyState cstate, ExprContext *eco
 static TupleTableSlot* makeClusterCopySlot(Relation rel);
 static CopyStmt* makeClusterCopyFromStmt(Relation rel);
 static bool CopyHasOidsOptions(List *list);
+static bool CanCoordinatorCopyTo(const CopyStmt *stmt);
+static RemoteCopyOptions* MakeRemoteCopyToOptions(CopyState cstate);
+static List* MakeCopyAttnameList(CopyState cstate);
+static uint64 CoordinatorCopyTo(CopyState cstate);
+static uint64 CoordinatorCopyToFiles(CopyState cstate);
 
 static void SerializeAuxRelCopyInfo(StringInfo buf, List *list);
 static List* LoadAuxRelCopyInfo(StringInfo mem_toc);
@@ -962,9 +1016,11 @@ DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed ADB_ONLY
 			 * when is copy from and rel is remote, we convert to
 			 *   copy (select ...) to ...
 			 * and Permission check at datanode
-			 * now we create a query
+			 * now we create a query, unless Datanodes can run the
+			 * COPY TO themselves, see CoordinatorCopyTo
 			 */
-			|| (is_from == false && rel->rd_locator_info)
+			|| (is_from == false && rel->rd_locator_info &&
+				!CanCoordinatorCopyTo(stmt))
 #endif /* ADB */
 			)
 		{
@@ -1117,6 +1173,11 @@ DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed ADB_ONLY
 		cstate = BeginCopyTo(rel, query, queryString, relid,
 							 stmt->filename, stmt->is_program,
 							 stmt->attlist, stmt->options ADB_ONLY_COMMA_ARG(cluster_safe));
+#ifdef ADB
+		if (cstate->parallel)
+			*processed = CoordinatorCopyToFiles(cstate);
+		else
+#endif /* ADB */
 		*processed = DoCopyTo(cstate);	/* copy from database to file */
 		EndCopyTo(cstate);
 	}
@@ -1321,6 +1382,16 @@ ProcessCopyOptions(CopyState cstate,
 						 errmsg("argument to option \"%s\" must be a valid encoding name",
 								defel->defname)));
 		}
+#ifdef ADB
+		else if (strcmp(defel->defname, "parallel") == 0)
+		{
+			if (cstate->parallel)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options")));
+			cstate->parallel = defGetBoolean(defel);
+		}
+#endif /* ADB */
 		else
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
@@ -1458,6 +1529,14 @@ ProcessCopyOptions(CopyState cstate,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("COPY force null only available using COPY FROM")));
 
+#ifdef ADB
+	/* Check parallel */
+	if (cstate->parallel && is_from)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY parallel only available using COPY TO")));
+#endif /* ADB */
+
 	/* Don't allow the delimiter to appear in the null string. */
 	if (strchr(cstate->null_print, cstate->delim[0]) != NULL)
 		ereport(ERROR,
@@ -1882,7 +1961,11 @@ EndCopy(CopyState cstate)
 	}
 	else
 	{
-		if (cstate->filename != NULL && FreeFile(cstate->copy_file))
+		if (cstate->filename != NULL &&
+#ifdef ADB
+			!cstate->parallel &&	/* files are opened by Datanodes */
+#endif
+			FreeFile(cstate->copy_file))
 			ereport(ERROR,
 					(errcode_for_file_access(),
 					 errmsg("could not close file \"%s\": %m",
@@ -1946,6 +2029,26 @@ BeginCopyTo(Relation rel,
 					   options ADB_ONLY_COMMA_ARG(cluster_safe));
 	oldcontext = MemoryContextSwitchTo(cstate->copycontext);
 
+#ifdef ADB
+	if (cstate->parallel)
+	{
+		if (pipe || is_program)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY parallel is only available for COPY TO a file")));
+		if (rel == NULL || rel->rd_locator_info == NULL || cstate->queryDesc)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("COPY parallel is only available for a distributed table")));
+		if (!is_absolute_path(filename))
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_NAME),
+					 errmsg("relative path not allowed for COPY to file")));
+
+		/* Datanodes open their own files, see CoordinatorCopyToFiles */
+		cstate->filename = pstrdup(filename);
+	}else
+#endif /* ADB */
 	if (pipe)
 	{
 		Assert(!is_program);	/* the grammar does not allow this */
@@ -2213,6 +2316,13 @@ CopyTo(CopyState cstate)
 		pfree(values);
 		pfree(nulls);
 	}
+#ifdef ADB
+	else if (cstate->queryDesc == NULL)
+	{
+		Assert(cstate->rel && cstate->rel->rd_locator_info);
+		processed = CoordinatorCopyTo(cstate);
+	}
+#endif /* ADB */
 	else
 	{
 		/* run the plan --- the dest receiver will send tuples */
@@ -2683,7 +2793,10 @@ CopyFrom(CopyState cstate)
 			if (TupIsNull(slot))
 				break;
 
-			tuple = ExecCopySlotTuple(slot);
+			if (cstate->next_row_owned)
+				tuple = ExecFetchSlotTuple(slot);
+			else
+				tuple = ExecCopySlotTuple(slot);
 		}else
 		{
 #endif /* ADB */
@@ -3166,35 +3279,7 @@ BeginCopyFrom(Relation rel,
 #ifdef ADB
 	if (rel->rd_locator_info)
 	{
-		Expr	   *reduce;
-		ReduceInfo *rinfo;
-
-		/* make reduce expr */
-		rinfo = MakeReduceInfoFromLocInfo(rel->rd_locator_info,
-										  NIL,
-										  RelationGetRelid(rel),
-										  1 /* only have one relation */);
-		reduce = CreateExprUsingReduceInfo(rinfo);
-		cstate->cs_reduce = ExecInitExpr(reduce, NULL);
-		cstate->aux_info = MakeAuxRelCopyInfo(rel);
-		if (cstate->aux_info)
-		{
-			List *rnodes;
-			cstate->exec_cluster_flag = EXEC_CLUSTER_FLAG_USE_SELF_AND_MEM_REDUCE;
-			cstate->fd_copied_ctid = BufFileCreateTemp(false);
-			cstate->mem_copy_toc = makeStringInfo();
-
-			begin_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_COPY_INFO);
-			SerializeAuxRelCopyInfo(cstate->mem_copy_toc, cstate->aux_info);
-			end_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_COPY_INFO);
-
-			begin_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_MAIN_NODES);
-			rnodes = list_copy(rel->rd_locator_info->nodeids);
-			rnodes = lappend_oid(rnodes, PGXCNodeOid);
-			saveNode(cstate->mem_copy_toc, (Node*)rnodes);
-			end_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_MAIN_NODES);
-			list_free(rnodes);
-		}
+		InitCoordinatorCopyFrom(cstate);
 
 		/*
 		 * when has insert before or after trigger, we call trigger and save tuple to tuplestore,
@@ -3215,10 +3300,6 @@ BeginCopyFrom(Relation rel,
 														cstate->mem_copy_toc,
 														cstate->exec_cluster_flag);
 		}
-		cstate->cs_tupleslot = makeClusterCopySlot(cstate->rel);
-		cstate->cs_convert = create_type_convert(cstate->cs_tupleslot->tts_tupleDescriptor, true, false);
-		if (cstate->cs_convert)
-			cstate->cs_tsConvert = MakeSingleTupleTableSlot(cstate->cs_convert->out_desc);
 	}
 #endif /* ADB */
 
@@ -3559,6 +3640,7 @@ EndCopyFrom(CopyState cstate)
 
 		foreach(lc, cstate->list_connect)
 		{
+			conn = lfirst(lc);
 			for(;;)
 			{
 				res = PQgetResult(conn);
@@ -4992,6 +5074,7 @@ void DoClusterCopy(CopyStmt *stmt, StringInfo mem_toc)
 
 	/* func_data auto set to target relation TupleTableSlot in CopyFrom if it is null */
 	cstate->NextRowFrom = NextRowFromCoordinator;
+	cstate->next_row_owned = true;
 	CopyFrom(cstate);
 
 	MemoryContextSwitchTo(oldcontext);
@@ -5002,11 +5085,57 @@ void DoClusterCopy(CopyStmt *stmt, StringInfo mem_toc)
 	EndCopyFrom(cstate);
 }
 
+/*
+ * Set up reduce and auxiliary table info of COPY FROM on Coordinator,
+ * rows are sent to Datanodes by CoordinatorCopyFrom.
+ */
+static void InitCoordinatorCopyFrom(CopyState cstate)
+{
+	Relation	rel = cstate->rel;
+	Expr	   *reduce;
+	ReduceInfo *rinfo;
+
+	Assert(rel->rd_locator_info);
+
+	/* make reduce expr */
+	rinfo = MakeReduceInfoFromLocInfo(rel->rd_locator_info,
+									  NIL,
+									  RelationGetRelid(rel),
+									  1 /* only have one relation */);
+	reduce = CreateExprUsingReduceInfo(rinfo);
+	cstate->cs_reduce = ExecInitExpr(reduce, NULL);
+	cstate->aux_info = MakeAuxRelCopyInfo(rel);
+	if (cstate->aux_info)
+	{
+		List *rnodes;
+		cstate->exec_cluster_flag = EXEC_CLUSTER_FLAG_USE_SELF_AND_MEM_REDUCE;
+		cstate->fd_copied_ctid = BufFileCreateTemp(false);
+		cstate->mem_copy_toc = makeStringInfo();
+
+		begin_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_COPY_INFO);
+		SerializeAuxRelCopyInfo(cstate->mem_copy_toc, cstate->aux_info);
+		end_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_COPY_INFO);
+
+		begin_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_MAIN_NODES);
+		rnodes = list_copy(rel->rd_locator_info->nodeids);
+		rnodes = lappend_oid(rnodes, PGXCNodeOid);
+		saveNode(cstate->mem_copy_toc, (Node*)rnodes);
+		end_mem_toc_insert(cstate->mem_copy_toc, AUX_REL_MAIN_NODES);
+		list_free(rnodes);
+	}
+
+	cstate->cs_tupleslot = makeClusterCopySlot(rel);
+	cstate->cs_convert = create_type_convert(cstate->cs_tupleslot->tts_tupleDescriptor, true, false);
+	if (cstate->cs_convert)
+		cstate->cs_tsConvert = MakeSingleTupleTableSlot(cstate->cs_convert->out_desc);
+}
+
 static uint64 CoordinatorCopyFrom(CopyState cstate)
 {
 	TupleTypeConvert   *type_convert;
 	ExprState		   *expr_state;
 	TupleTableSlot	   *ts_convert;
+	CopyFromRoute	   *route;
 	ListCell		   *lc;
 	PGconn			   *conn;
 	EState			   *estate = CreateExecutorState();
@@ -5015,6 +5144,11 @@ static uint64 CoordinatorCopyFrom(CopyState cstate)
 
 	ErrorContextCallback errcallback;
 	StringInfoData	buf;
+	CopyFromBatch  *batches;
+	CopyFromBatch  *batch;
+	int				nbatch;
+	int				max_batch;
+	int				i;
 	/* CommandId	mycid = GetCurrentCommandId(true); */
 	ExprDoneCond done;
 	bool isnull;
@@ -5054,6 +5188,10 @@ static uint64 CoordinatorCopyFrom(CopyState cstate)
 	ts_convert = cstate->cs_tsConvert;
 	expr_state = cstate->cs_reduce;
 	initStringInfo(&buf);
+	max_batch = list_length(cstate->rel->rd_locator_info->nodeids);
+	batches = palloc0(sizeof(CopyFromBatch) * max_batch);
+	nbatch = 0;
+	route = type_convert ? NULL : MakeCopyFromRoute(cstate->rel);
 
 	/* Set up callback to identify error line number */
 	errcallback.callback = CopyFromErrorCallback;
@@ -5078,6 +5216,22 @@ static uint64 CoordinatorCopyFrom(CopyState cstate)
 		if (TupIsNull(slot))
 			break;
 
+		if (route)
+		{
+			int n = route->nrows;
+
+			/* distribution value must survive per-tuple memory context */
+			MemoryContextSwitchTo(route->context);
+			route->values[n] = slot_getattr(slot, route->attnum, &route->nulls[n]);
+			if (!route->nulls[n])
+				route->values[n] = datumCopy(route->values[n], route->typbyval, route->typlen);
+			SerializeCopyFromRow(&route->buf, slot, RelationGetDescr(cstate->rel));
+			route->offsets[++route->nrows] = route->buf.len;
+			if (route->nrows == COPY_FROM_ROUTE_ROWS)
+				SendCopyFromRoute(route, cstate->rel->rd_locator_info, batches, &nbatch, max_batch);
+			continue;
+		}
+
 		if (type_convert)
 			slot = do_type_convert_slot_out(type_convert, slot, ts_convert, false);
 
@@ -5094,20 +5248,16 @@ static uint64 CoordinatorCopyFrom(CopyState cstate)
 				Assert(conn != NULL);
 
 				if (buf.len == 0)
-					serialize_slot_message(&buf,
-										   slot,
-										   type_convert ? CLUSTER_MSG_CONVERT_TUPLE:CLUSTER_MSG_TUPLE_DATA);
-				if (PQputCopyData(conn, buf.data, buf.len) != 1 ||
-					PQflush(conn) < 0)
 				{
-					char *err = PQerrorMessage(conn);
-					int len = strlen(err);
-					while(len > 0 && err[--len] == '\n')
-						err[len] = '\0';
-					ereport(ERROR,
-							(errmsg("%s", err),
-							 errnode(PQNConnectName(conn))));
+					if (type_convert)
+						serialize_slot_message(&buf, slot, CLUSTER_MSG_CONVERT_TUPLE);
+					else
+						SerializeCopyFromRow(&buf, slot, RelationGetDescr(cstate->rel));
 				}
+				batch = GetCopyFromBatch(batches, &nbatch, max_batch, conn);
+				appendBinaryStringInfo(&batch->buf, buf.data, buf.len);
+				if (batch->buf.len >= COPY_FROM_BATCH_SIZE)
+					SendCopyFromBatch(batch);
 			}
 			if (done != ExprMultipleResult)
 				break;
@@ -5115,7 +5265,21 @@ static uint64 CoordinatorCopyFrom(CopyState cstate)
 	}
 
 	/* Done, clean up */
+	if (route)
+	{
+		SendCopyFromRoute(route, cstate->rel->rd_locator_info, batches, &nbatch, max_batch);
+		MemoryContextDelete(route->context);
+		pfree(route->buf.data);
+		pfree(route->conns);
+		pfree(route);
+	}
 	error_context_stack = errcallback.previous;
+	for (i = 0; i < nbatch; i++)
+	{
+		SendCopyFromBatch(&batches[i]);
+		pfree(batches[i].buf.data);
+	}
+	pfree(batches);
 	foreach(lc, cstate->list_connect)
 	{
 		if (PQputCopyEnd(lfirst(lc), NULL) < 0)
@@ -5157,6 +5321,182 @@ static uint64 CoordinatorCopyFrom(CopyState cstate)
 	return cstate->count_tuple;
 }
 
+/*
+ * Serialize a row of COPY FROM as CLUSTER_MSG_COPY_TUPLE. The line number
+ * is the last attribute of slot, it is sent before the tuple and the tuple
+ * is formed by desc of target relation, so Datanode can insert it as is.
+ */
+static void SerializeCopyFromRow(StringInfo buf, TupleTableSlot *slot, TupleDesc desc)
+{
+	MinimalTuple	tup;
+	Datum		   *values;
+	int32			lineno;
+	int				i;
+
+	slot_getallattrs(slot);
+	Assert(slot->tts_tupleDescriptor->natts == desc->natts + 1);
+	Assert(TupleDescAttr(slot->tts_tupleDescriptor, desc->natts)->atttypid == INT4OID);
+	lineno = DatumGetInt32(slot->tts_values[desc->natts]);
+
+	/* Datanode can not fetch toasted value saved in Coordinator */
+	values = slot->tts_values;
+	for (i = 0; i < desc->natts; i++)
+	{
+		if (slot->tts_isnull[i] ||
+			TupleDescAttr(desc, i)->attlen != -1 ||
+			!VARATT_IS_EXTERNAL(DatumGetPointer(slot->tts_values[i])))
+			continue;
+
+		if (values == slot->tts_values)
+		{
+			values = palloc(sizeof(Datum) * desc->natts);
+			memcpy(values, slot->tts_values, sizeof(Datum) * desc->natts);
+		}
+		values[i] = PointerGetDatum(heap_tuple_fetch_attr((struct varlena *)DatumGetPointer(values[i])));
+	}
+
+	tup = heap_form_minimal_tuple(desc, values, slot->tts_isnull);
+	if (desc->tdhasoid)
+	{
+		Oid oid = ExecFetchSlotTupleOid(slot);
+		if (OidIsValid(oid))
+			HeapTupleHeaderSetOid((HeapTupleHeader)((char*)tup - MINIMAL_TUPLE_OFFSET), oid);
+	}
+
+	appendStringInfoChar(buf, CLUSTER_MSG_COPY_TUPLE);
+	appendBinaryStringInfo(buf, (char*)&lineno, sizeof(lineno));
+	appendBinaryStringInfo(buf, (char*)tup, tup->t_len);
+	pfree(tup);
+}
+
+/*
+ * Make the state to route rows of rel in groups, NULL if rows of rel do not
+ * go to one node chosen by the value of one column.
+ */
+static CopyFromRoute* MakeCopyFromRoute(Relation rel)
+{
+	RelationLocInfo	   *loc_info = rel->rd_locator_info;
+	CopyFromRoute	   *route;
+	Form_pg_attribute	attr;
+
+	if (loc_info == NULL ||
+		!IsLocatorDistributedByValue(loc_info->locatorType) ||
+		loc_info->partAttrNum <= InvalidAttrNumber ||
+		list_length(loc_info->nodeids) == 0)
+		return NULL;
+
+	attr = TupleDescAttr(RelationGetDescr(rel), loc_info->partAttrNum - 1);
+	route = palloc0(sizeof(*route));
+	route->context = AllocSetContextCreate(CurrentMemoryContext,
+										   "COPY FROM route",
+										   ALLOCSET_DEFAULT_SIZES);
+	route->conns = palloc0(sizeof(PGconn*) * list_length(loc_info->nodeids));
+	route->typid = attr->atttypid;
+	route->typlen = attr->attlen;
+	route->typbyval = attr->attbyval;
+	route->attnum = loc_info->partAttrNum;
+	initStringInfo(&route->buf);
+
+	return route;
+}
+
+/*
+ * Find nodes of rows gathered in route at once and append the rows to
+ * batches of the nodes, then start a new group.
+ */
+static void SendCopyFromRoute(CopyFromRoute *route, RelationLocInfo *loc_info,
+							  CopyFromBatch *batches, int *nbatch, int max_batch)
+{
+	CopyFromBatch  *batch;
+	int				index;
+	int				i;
+
+	if (route->nrows == 0)
+		return;
+
+	if (!GetRelationNodeIndexes(loc_info, route->typid, route->nrows,
+								route->values, route->nulls, route->node_indexes))
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("can not find datanode of COPY FROM row")));
+
+	for (i = 0; i < route->nrows; i++)
+	{
+		index = route->node_indexes[i];
+		Assert(index >= 0 && index < list_length(loc_info->nodeids));
+		if (route->conns[index] == NULL)
+		{
+			/* connections of COPY may be started after the first row is read */
+			route->conns[index] = PQNFindConnUseOid(list_nth_oid(loc_info->nodeids, index));
+			Assert(route->conns[index] != NULL);
+		}
+
+		batch = GetCopyFromBatch(batches, nbatch, max_batch, route->conns[index]);
+		appendBinaryStringInfo(&batch->buf,
+							   route->buf.data + route->offsets[i],
+							   route->offsets[i+1] - route->offsets[i]);
+		if (batch->buf.len >= COPY_FROM_BATCH_SIZE)
+			SendCopyFromBatch(batch);
+	}
+
+	route->nrows = 0;
+	resetStringInfo(&route->buf);
+	MemoryContextReset(route->context);
+}
+
+/*
+ * Get the batch of conn, batches are allocated in the order connections
+ * first get a row.
+ */
+static CopyFromBatch* GetCopyFromBatch(CopyFromBatch *batches, int *nbatch, int max_batch, PGconn *conn)
+{
+	MemoryContext	oldcontext;
+	int				i;
+
+	for (i = 0; i < *nbatch; i++)
+	{
+		if (batches[i].conn == conn)
+			return &batches[i];
+	}
+
+	if (*nbatch >= max_batch)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("too many remote connections for COPY FROM"),
+				 errnode(PQNConnectName(conn))));
+
+	/* buffer must survive per-tuple memory context */
+	oldcontext = MemoryContextSwitchTo(GetMemoryChunkContext(batches));
+	batches[i].conn = conn;
+	initStringInfo(&batches[i].buf);
+	enlargeStringInfo(&batches[i].buf, COPY_FROM_BATCH_SIZE);
+	MemoryContextSwitchTo(oldcontext);
+	++(*nbatch);
+
+	return &batches[i];
+}
+
+static void SendCopyFromBatch(CopyFromBatch *batch)
+{
+	PGconn *conn = batch->conn;
+
+	if (batch->buf.len == 0)
+		return;
+
+	if (PQputCopyData(conn, batch->buf.data, batch->buf.len) != 1 ||
+		PQflush(conn) < 0)
+	{
+		char *err = PQerrorMessage(conn);
+		int len = strlen(err);
+		while(len > 0 && err[--len] == '\n')
+			err[len] = '\0';
+		ereport(ERROR,
+				(errmsg("%s", err),
+				 errnode(PQNConnectName(conn))));
+	}
+	resetStringInfo(&batch->buf);
+}
+
 static TupleTableSlot* NextLineCallTrigger(CopyState cstate, ExprContext *econtext, void *data)
 {
 	EState *estate = econtext->ecxt_estate;
@@ -5301,6 +5641,84 @@ static TupleTableSlot* NextRowFromTuplestore(CopyState cstate, ExprContext *econ
 	return slot;
 }
 
+/*
+ * Rows of an INSERT on Coordinator can be sent to Datanodes like COPY FROM,
+ * see ExecInitModifyTable. ClusterInsertPutSlot saves them until the source
+ * plan is done, then EndClusterInsert starts one cluster COPY and sends
+ * every Datanode its rows in batches.
+ */
+CopyState BeginClusterInsert(Relation rel)
+{
+	CopyState		cstate;
+	MemoryContext	oldcontext;
+
+	Assert(rel->rd_locator_info);
+	cstate = BeginCopy(true, rel, NULL, NULL, InvalidOid, NIL, NIL, false);
+	oldcontext = MemoryContextSwitchTo(cstate->copycontext);
+
+	/* Initialize state variables, rows are not parsed from any input */
+	cstate->cur_relname = RelationGetRelationName(rel);
+	cstate->cur_lineno = 0;
+	cstate->cur_attname = NULL;
+	cstate->cur_attval = NULL;
+	cstate->binary = true;
+
+	InitCoordinatorCopyFrom(cstate);
+	cstate->cs_tuplestore = tuplestore_begin_heap(false, false, work_mem);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return cstate;
+}
+
+void ClusterInsertPutSlot(CopyState cstate, TupleTableSlot *slot)
+{
+	TupleTableSlot *myslot = cstate->cs_tupleslot;
+	int				natts = RelationGetDescr(cstate->rel)->natts;
+
+	/* like NextLineCallTrigger, the line number is the row number */
+	slot_getallattrs(slot);
+	Assert(slot->tts_tupleDescriptor->natts == natts);
+	ExecClearTuple(myslot);
+	memcpy(myslot->tts_values, slot->tts_values, sizeof(Datum) * natts);
+	memcpy(myslot->tts_isnull, slot->tts_isnull, sizeof(bool) * natts);
+	Assert(TupleDescAttr(myslot->tts_tupleDescriptor, natts)->atttypid == INT4OID);
+	myslot->tts_values[natts] = Int32GetDatum(++(cstate->cur_lineno));
+	myslot->tts_isnull[natts] = false;
+	ExecStoreVirtualTuple(myslot);
+
+	tuplestore_puttupleslot(cstate->cs_tuplestore, myslot);
+	ExecClearTuple(myslot);
+	++(cstate->count_tuple);
+}
+
+/*
+ * Send rows saved by ClusterInsertPutSlot and wait for Datanodes,
+ * returns the number of rows inserted.
+ */
+uint64 EndClusterInsert(CopyState cstate)
+{
+	MemoryContext	oldcontext;
+	uint64			processed = 0;
+
+	if (cstate->count_tuple > 0)
+	{
+		oldcontext = MemoryContextSwitchTo(cstate->copycontext);
+		cstate->cur_lineno = 0;
+		cstate->list_connect = ExecStartClusterCopy(cstate->rel->rd_locator_info->nodeids,
+													makeClusterCopyFromStmt(cstate->rel),
+													cstate->mem_copy_toc,
+													cstate->exec_cluster_flag);
+		cstate->NextRowFrom = NextRowFromTuplestore;
+		MemoryContextSwitchTo(oldcontext);
+
+		processed = CoordinatorCopyFrom(cstate);
+	}
+	EndCopyFrom(cstate);
+
+	return processed;
+}
+
 static TupleTableSlot* NextRowFromCoordinator(CopyState cstate, ExprContext *context, void *data)
 {
 	TupleTableSlot *slot;
@@ -5308,18 +5726,58 @@ static TupleTableSlot* NextRowFromCoordinator(CopyState cstate, ExprContext *con
 	HeapTuple tuple;
 	StringInfo buf;
 	int natts;
+	uint32 t_len;
 	char msg_type;
 
 	if (CopyGetData(cstate, &msg_type, sizeof(msg_type), sizeof(msg_type)) != sizeof(msg_type))
 		return NULL;	/* copy done */
 	buf = cstate->fe_msgbuf;
+	AssertArg(IsA(data, TupleTableSlot));
+	dest = (TupleTableSlot*)data;
+
+	if (msg_type == CLUSTER_MSG_COPY_TUPLE)
+	{
+		int32 lineno;
+
+		/* tuple is formed by target relation, make a HeapTuple of it directly */
+		if (buf->len - buf->cursor < sizeof(lineno) + sizeof(t_len))
+			ereport(ERROR,
+					(errcode(ERRCODE_PROTOCOL_VIOLATION),
+					 errmsg("invalid tuple message length")));
+		memcpy(&lineno, buf->data + buf->cursor, sizeof(lineno));
+		buf->cursor += sizeof(lineno);
+		memcpy(&t_len, buf->data + buf->cursor, sizeof(t_len));
+		if (t_len > buf->len - buf->cursor)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROTOCOL_VIOLATION),
+					 errmsg("invalid tuple message length")));
+
+		tuple = (HeapTuple) palloc(HEAPTUPLESIZE + MINIMAL_TUPLE_OFFSET + t_len);
+		tuple->t_len = MINIMAL_TUPLE_OFFSET + t_len;
+		ItemPointerSetInvalid(&(tuple->t_self));
+		tuple->t_tableOid = InvalidOid;
+		tuple->t_data = (HeapTupleHeader) ((char *) tuple + HEAPTUPLESIZE);
+		memcpy((char *) tuple->t_data + MINIMAL_TUPLE_OFFSET, buf->data + buf->cursor, t_len);
+		MemSet(tuple->t_data, 0, offsetof(HeapTupleHeaderData, t_infomask2));
+		buf->cursor += t_len;
+
+		cstate->cur_lineno = lineno;
+		return ExecStoreTuple(tuple, dest, InvalidBuffer, false);
+	}
+
+	/* a CopyData message may carry many rows, see COPY_FROM_BATCH_SIZE */
+	if (buf->len - buf->cursor < sizeof(t_len))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("invalid tuple message length")));
+	memcpy(&t_len, buf->data + buf->cursor, sizeof(t_len));
 
 	if (msg_type == CLUSTER_MSG_TUPLE_DATA)
 	{
 		slot = restore_slot_message(buf->data + buf->cursor,
 									buf->len - buf->cursor,
 									cstate->cs_tupleslot);
-		buf->cursor = buf->len;
+		buf->cursor += t_len;
 	}else if (msg_type == CLUSTER_MSG_CONVERT_TUPLE)
 	{
 		if (cstate->cs_convert == NULL ||
@@ -5333,7 +5791,7 @@ static TupleTableSlot* NextRowFromCoordinator(CopyState cstate, ExprContext *con
 		slot = restore_slot_message(buf->data + buf->cursor,
 									buf->len - buf->cursor,
 									cstate->cs_tsConvert);
-		buf->cursor = buf->len;
+		buf->cursor += t_len;
 		slot = do_type_convert_slot_in(cstate->cs_convert,
 									   slot,
 									   cstate->cs_tupleslot,
@@ -5345,8 +5803,6 @@ static TupleTableSlot* NextRowFromCoordinator(CopyState cstate, ExprContext *con
 				 errmsg("unknown copy message type '%d' from coordinator", msg_type)));
 	}
 
-	AssertArg(IsA(data, TupleTableSlot));
-	dest = (TupleTableSlot*)data;
 	slot_getallattrs(slot);
 	natts = RelationGetDescr(cstate->rel)->natts;
 	tuple = heap_form_tuple(dest->tts_tupleDescriptor, slot->tts_values, slot->tts_isnull);
@@ -5357,7 +5813,8 @@ static TupleTableSlot* NextRowFromCoordinator(CopyState cstate, ExprContext *con
 	Assert(TupleDescAttr(slot->tts_tupleDescriptor, natts)->atttypid == INT4OID);
 
 	cstate->cur_lineno = DatumGetInt32(slot->tts_values[natts]);
-	return ExecStoreTuple(tuple, dest, InvalidBuffer, true);
+	/* CopyFrom inserts the tuple without copy, see next_row_owned */
+	return ExecStoreTuple(tuple, dest, InvalidBuffer, false);
 }
 
 static TupleTableSlot* AddNumberNextCopyFrom(CopyState cstate, ExprContext *econtext, void *data)
@@ -5442,6 +5899,165 @@ static bool CopyHasOidsOptions(List *list)
 	return false;
 }
 
+/*
+ * Can Datanodes format rows of COPY TO a distributed table themselves,
+ * instead of running it as COPY (SELECT ...) TO on Coordinator?
+ */
+static bool CanCoordinatorCopyTo(const CopyStmt *stmt)
+{
+	CopyStateData	opts;
+
+	if (stmt->is_from || stmt->query || !IsCnNode())
+		return false;
+
+	MemSet(&opts, 0, sizeof(opts));
+	ProcessCopyOptions(&opts, false, stmt->options);
+	if (opts.parallel)
+		return true;
+
+	/* every Datanode sends its own binary header and trailer */
+	if (opts.binary)
+		return false;
+
+	/* data of old protocol has no message boundary to forward rows by */
+	if (stmt->filename == NULL &&
+		whereToSendOutput == DestRemote &&
+		PG_PROTOCOL_MAJOR(FrontendProtocol) < 3)
+		return false;
+
+	return true;
+}
+
+/*
+ * Make options of COPY TO sent to Datanodes, all strings are copied
+ * for FreeRemoteCopyOptions.
+ */
+static RemoteCopyOptions* MakeRemoteCopyToOptions(CopyState cstate)
+{
+	RemoteCopyOptions *options = makeRemoteCopyOptions();
+
+	options->rco_binary = cstate->binary;
+	options->rco_oids = cstate->oids;
+	options->rco_csv_mode = cstate->csv_mode;
+	if (!cstate->binary)
+	{
+		options->rco_delim = pstrdup(cstate->delim);
+		options->rco_null_print = pstrdup(cstate->null_print);
+	}
+	if (cstate->csv_mode)
+	{
+		options->rco_quote = pstrdup(cstate->quote);
+		options->rco_escape = pstrdup(cstate->escape);
+	}
+	options->rco_force_quote_all = cstate->force_quote_all;
+	options->rco_force_quote = list_copy(cstate->force_quote);
+
+	/* Datanodes must write data in the encoding of this COPY */
+	options->rco_encoding = pstrdup(pg_encoding_to_char(cstate->file_encoding));
+
+	return options;
+}
+
+/* names of attnumlist of cstate, for RemoteCopyBuildStatement */
+static List* MakeCopyAttnameList(CopyState cstate)
+{
+	TupleDesc	desc = RelationGetDescr(cstate->rel);
+	List	   *list = NIL;
+	ListCell   *lc;
+
+	foreach(lc, cstate->attnumlist)
+	{
+		Form_pg_attribute attr = TupleDescAttr(desc, lfirst_int(lc) - 1);
+		list = lappend(list, makeString(pstrdup(NameStr(attr->attname))));
+	}
+
+	return list;
+}
+
+/*
+ * COPY TO of a distributed table, Datanodes run the COPY TO STDOUT and
+ * their CopyData messages are forwarded to the destination as they are,
+ * with no per-row work on Coordinator. Rows of different Datanodes come
+ * in no particular order. The CSV header line has been sent by CopyTo.
+ */
+static uint64 CoordinatorCopyTo(CopyState cstate)
+{
+	RemoteCopyOptions  *options;
+	RemoteCopyState	   *rcstate;
+	uint64				processed;
+
+	Assert(!cstate->binary);
+
+	rcstate = palloc0(sizeof(*rcstate));
+	rcstate->is_from = false;
+	options = MakeRemoteCopyToOptions(cstate);
+	RemoteCopyGetRelationLoc(rcstate, cstate->rel, cstate->attnumlist);
+	RemoteCopyBuildStatement(rcstate, cstate->rel, options,
+							 MakeCopyAttnameList(cstate), cstate->attnumlist);
+	FreeRemoteCopyOptions(options);
+
+	if (cstate->copy_dest == COPY_FILE)
+	{
+		rcstate->remoteCopyType = REMOTE_COPY_FILE;
+		rcstate->copy_file = cstate->copy_file;
+	}else
+	{
+		Assert(cstate->copy_dest == COPY_NEW_FE);
+		rcstate->remoteCopyType = REMOTE_COPY_STDOUT;
+	}
+
+	StartRemoteCopy(rcstate);
+	processed = DoRemoteCopyTo(rcstate);
+	FreeRemoteCopyState(rcstate);
+
+	return processed;
+}
+
+/*
+ * COPY TO a file with option parallel, every Datanode writes its rows to
+ * its own file named by the file name and the Datanode name, e.g.
+ * "/path/file.dn1", all at the same time. Only one Datanode writes a
+ * replicated table.
+ */
+static uint64 CoordinatorCopyToFiles(CopyState cstate)
+{
+	RemoteCopyOptions  *options;
+	RemoteCopyState	   *rcstate;
+	List			   *attnamelist;
+	List			   *query_list = NIL;
+	ListCell		   *lc;
+	uint64				processed;
+
+	Assert(cstate->parallel && cstate->filename);
+
+	rcstate = palloc0(sizeof(*rcstate));
+	rcstate->is_from = false;
+	options = MakeRemoteCopyToOptions(cstate);
+	options->rco_header = cstate->header_line;
+	attnamelist = MakeCopyAttnameList(cstate);
+	RemoteCopyGetRelationLoc(rcstate, cstate->rel, cstate->attnumlist);
+
+	foreach(lc, rcstate->exec_nodes->nodeids)
+	{
+		options->rco_filename = psprintf("%s.%s",
+										 cstate->filename,
+										 get_pgxc_nodename(lfirst_oid(lc)));
+		RemoteCopyBuildStatement(rcstate, cstate->rel, options,
+								 attnamelist, cstate->attnumlist);
+		query_list = lappend(query_list, rcstate->query_buf.data);
+		pfree(options->rco_filename);
+		options->rco_filename = NULL;
+	}
+	FreeRemoteCopyOptions(options);
+
+	processed = DoRemoteCopyToFiles(rcstate->exec_nodes->nodeids, query_list);
+	list_free_deep(query_list);
+	rcstate->query_buf.data = NULL;
+	FreeRemoteCopyState(rcstate);
+
+	return processed;
+}
+
 static void SerializeAuxRelCopyInfo(StringInfo buf, List *list)
 {
 	AuxiliaryRelCopy *aux;
@@ -65,6 +65,7 @@
 
 #ifdef ADB
 #include "agtm/agtm.h"
+#include "commands/sequence.h"
 #include "pgxc/execRemote.h"
 #include "pgxc/pgxc.h"
 #endif
@@ -941,6 +942,13 @@ dropdb(const char *dbname, bool missing_ok)
 	 */
 	pgstat_drop_database(db_id);
 
+#ifdef ADB
+	/*
+	 * Release the node-wide sequence ranges of the database.
+	 */
+	SequenceCacheForgetDatabase(db_id);
+#endif
+
 	/*
 	 * Tell checkpointer to forget any pending fsync and unlink requests for
 	 * files in the database; else the fsyncs will fail at next checkpoint, or
@@ -1028,4 +1028,32 @@ ActivateDatanodeStatementOnNode(const char *stmt_name, Oid noid)
 	entry->node_ids[entry->node_num++] = noid;
 	return false;
 }
+
+/*
+ * Forget all Datanode statements active on specified node, used when the
+ * remote session of the node is not the one they were prepared on
+ */
+void
+DeactivateDatanodeStatementsOnNode(Oid noid)
+{
+	HASH_SEQ_STATUS seq;
+	DatanodeStatement *entry;
+	int i;
+
+	if (!datanode_queries)
+		return;
+
+	hash_seq_init(&seq, datanode_queries);
+	while ((entry = hash_seq_search(&seq)) != NULL)
+	{
+		for (i = 0; i < entry->node_num; i++)
+		{
+			if (entry->node_ids[i] == noid)
+			{
+				entry->node_ids[i] = entry->node_ids[--entry->node_num];
+				break;
+			}
+		}
+	}
+}
 #endif
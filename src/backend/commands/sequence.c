@@ -43,6 +43,9 @@
 #ifdef ADB
 #include "pgxc/pgxc.h"
 #include "commands/dbcommands.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
 #endif
 
 /*
@@ -91,6 +94,65 @@ static HTAB *seqhashtab = NULL; /* hash table for SeqTable items */
  */
 static SeqTableData *last_used_seq = NULL;
 
+#ifdef AGTM
+/* number of values nextval_range_internal() wants, 0 for the CACHE setting */
+static int64 seq_range_fetch = 0;
+#endif
+
+#ifdef ADB
+/*
+ * Node-wide cache of sequence ranges leased from AGTM.
+ *
+ * In SEQ_CACHE_SHARED mode all backends of a coordinator consume values from
+ * one range per sequence, so AGTM is contacted once per lease rather than
+ * once per backend.  Handing out a value only takes the slot's spinlock; the
+ * lease_lock makes sure a single backend goes to AGTM when the range runs
+ * out while the others wait for it.  setval() and ALTER SEQUENCE do not wait
+ * for an AGTM request in progress, they bump the slot's generation instead,
+ * and a range leased under an older generation is not installed.
+ */
+typedef struct SeqCacheKey
+{
+	Oid			dbid;			/* database of the sequence */
+	Oid			relid;			/* pg_class OID of the sequence */
+} SeqCacheKey;
+
+typedef struct SeqCacheLookupEnt
+{
+	SeqCacheKey	key;			/* hash key, must be first */
+	int			slot;			/* index in SeqCacheCtl->slots */
+} SeqCacheLookupEnt;
+
+typedef struct SeqCacheSlot
+{
+	SeqCacheKey	key;			/* sequence using this slot */
+	bool		in_use;			/* protected by SequenceCacheLock */
+	slock_t		mutex;			/* protects the fields below */
+	Oid			filenode;		/* relfilenode the range was leased for */
+	int64		last;			/* value last returned on this node */
+	int64		cached;			/* last value of the leased range */
+	/* if last != cached, some leased values are not used up yet */
+	int64		increment;		/* copy of sequence's increment field */
+	uint32		generation;		/* bumped when the range is thrown away */
+	LWLock		lease_lock;		/* serializes lease requests to AGTM */
+} SeqCacheSlot;
+
+typedef struct SeqCacheCtlData
+{
+	int			num_slots;
+	SeqCacheSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} SeqCacheCtlData;
+
+static SeqCacheCtlData *SeqCacheCtl = NULL;
+static HTAB *SeqCacheHash = NULL;
+static LWLockTranche SeqCacheLWLockTranche;
+
+/* GUC variables */
+int			sequence_cache_mode = SEQ_CACHE_SHARED;
+int			shared_sequence_cache_size = 1024;
+int			sequence_lease_size = 64;
+#endif
+
 static void fill_seq_with_data(Relation rel, HeapTuple tuple);
 static int64 nextval_internal(Oid relid);
 static Relation open_share_lock(SeqTable seq);
@@ -107,6 +169,13 @@ static void init_params(List *options, bool isInit,
 #endif
 static void do_setval(Oid relid, int64 next, bool iscalled);
 static void process_owned_by(Relation seqrel, List *owned_by);
+#ifdef ADB
+static void check_agtm_seq_limit(Relation seqrel, Form_pg_sequence seq, int64 last);
+static int64 nextval_agtm_lease(SeqTable elm, Relation seqrel);
+static SeqCacheSlot *seq_cache_get_slot(Oid relid, bool create);
+static bool seq_cache_take(SeqCacheSlot *slot, Oid filenode, int64 *result);
+static void seq_cache_forget(SeqCacheKey *key);
+#endif
 
 
 /*
@@ -381,6 +450,16 @@ register_sequence_cb(Relation rel, AGTM_SequenceKeyType key, AGTM_SequenceDropTy
 				schemaName = get_namespace_name(RelationGetNamespace(rel));
 
 				agtm_DropSequence(seqName, databaseName, schemaName);
+
+				if (SeqCacheCtl != NULL)
+				{
+					SeqCacheKey key;
+
+					MemSet(&key, 0, sizeof(key));
+					key.dbid = rel->rd_node.dbNode;
+					key.relid = RelationGetRelid(rel);
+					seq_cache_forget(&key);
+				}
 				break;
 			}
 		case AGTM_CREATE_SEQ:
@@ -655,6 +734,9 @@ AlterSequence(AlterSeqStmt *stmt)
 		agtm_AlterSequence(RelationGetRelationName(seqrel), databaseName,
 			schemaName, seqOptions);
 	}
+
+	/* after AGTM, see SequenceCacheInvalidate */
+	SequenceCacheInvalidate(relid);
 #endif
 	return address;
 }
@@ -752,12 +834,23 @@ nextval_internal(Oid relid)
 		return elm->last;
 	}
 
+#ifdef ADB
+	is_temp = seqrel->rd_backend == MyBackendId;
+	if (IsCoordMaster() && !is_temp &&
+		sequence_cache_mode != SEQ_CACHE_LOCAL)
+	{
+		result = nextval_agtm_lease(elm, seqrel);
+		relation_close(seqrel, NoLock);
+		last_used_seq = elm;
+		return result;
+	}
+#endif
+
 	/* lock page' buffer and read tuple */
 	seq = read_seq_tuple(elm, seqrel, &buf, &seqtuple);
 	page = BufferGetPage(buf);
 
 #ifdef ADB
-	is_temp = seqrel->rd_backend == MyBackendId;
 	if (IsCoordMaster() && !is_temp)
 	{
 		char * seqName = NULL;
@@ -768,29 +861,7 @@ nextval_internal(Oid relid)
 		maxv = seq->max_value;
 		minv = seq->min_value;
 		/* reach max value or min value */
-		if (!seq->is_cycled)
-		{
-			if (incby > 0 &&
-				((elm->last >= maxv) || (elm->last + incby > maxv)))
-			{
-				char		buf[100];
-				snprintf(buf, sizeof(buf), INT64_FORMAT, maxv);
-				ereport(ERROR,
-							  (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
-							   errmsg("nextval: reached maximum value of sequence \"%s\" (%s)",
-									  RelationGetRelationName(seqrel), buf)));
-			}
-			else if (incby < 0 &&
-				((elm->last <= minv) || (elm->last + incby < minv)))
-			{
-				char		buf[100];
-				snprintf(buf, sizeof(buf), INT64_FORMAT, minv);
-				ereport(ERROR,
-							  (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
-							   errmsg("nextval: reached minimum value of sequence \"%s\" (%s)",
-									  RelationGetRelationName(seqrel), buf)));
-			}
-		}
+		check_agtm_seq_limit(seqrel, seq, elm->last);
 
 		seqName = RelationGetRelationName(seqrel);
 		databaseName = get_database_name(seqrel->rd_node.dbNode);
@@ -837,6 +908,11 @@ nextval_internal(Oid relid)
 #endif
 
 	fetch = cache = seq->cache_value;
+#ifdef AGTM
+	/* a coordinator asked for a lease of a given size */
+	if (seq_range_fetch > 0)
+		fetch = cache = seq_range_fetch;
+#endif
 	log = seq->log_cnt;
 
 	if (!seq->is_called)
@@ -1045,6 +1121,408 @@ nextval_internal(Oid relid)
 	return result;
 }
 
+#ifdef AGTM
+/*
+ * Lease up to "count" consecutive values of a sequence for a coordinator's
+ * node-wide cache.  Returns the first value of the range, and the last one in
+ * *last.  The range stops early at the end of a cycling sequence.
+ */
+int64
+nextval_range_internal(Oid relid, int64 count, int64 *last)
+{
+	int64		result;
+
+	AssertArg(count > 0);
+
+	seq_range_fetch = count;
+	PG_TRY();
+	{
+		result = nextval_internal(relid);
+	}
+	PG_CATCH();
+	{
+		seq_range_fetch = 0;
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	seq_range_fetch = 0;
+
+	Assert(last_used_seq != NULL && last_used_seq->relid == relid);
+	*last = last_used_seq->cached;
+
+	return result;
+}
+#endif /* AGTM */
+
+#ifdef ADB
+/*
+ * Raise an error if AGTM can not return any value past "last" for
+ * a non-cycled sequence.
+ */
+static void
+check_agtm_seq_limit(Relation seqrel, Form_pg_sequence seq, int64 last)
+{
+	int64		incby = seq->increment_by;
+	int64		maxv = seq->max_value;
+	int64		minv = seq->min_value;
+
+	if (seq->is_cycled)
+		return;
+
+	if (incby > 0 &&
+		((last >= maxv) || (last + incby > maxv)))
+	{
+		char		buf[100];
+		snprintf(buf, sizeof(buf), INT64_FORMAT, maxv);
+		ereport(ERROR,
+					  (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					   errmsg("nextval: reached maximum value of sequence \"%s\" (%s)",
+							  RelationGetRelationName(seqrel), buf)));
+	}
+	else if (incby < 0 &&
+		((last <= minv) || (last + incby < minv)))
+	{
+		char		buf[100];
+		snprintf(buf, sizeof(buf), INT64_FORMAT, minv);
+		ereport(ERROR,
+					  (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+					   errmsg("nextval: reached minimum value of sequence \"%s\" (%s)",
+							  RelationGetRelationName(seqrel), buf)));
+	}
+}
+
+/*
+ * nextval() of a global sequence when sequence_cache_mode is "shared"
+ * or "ordered".
+ *
+ * In shared mode the value comes from the node-wide range of the sequence,
+ * and only the backend finding that range used up asks AGTM for a new lease.
+ * In ordered mode every call takes exactly one value from AGTM, so values
+ * are handed out in order across the whole cluster.
+ */
+static int64
+nextval_agtm_lease(SeqTable elm, Relation seqrel)
+{
+	SeqCacheSlot   *slot = NULL;
+	Buffer			buf;
+	HeapTupleData	seqtuple;
+	Form_pg_sequence seq;
+	char		   *databaseName;
+	char		   *schemaName;
+	int64			incby;
+	int64			count;
+	int64			result;
+	int64			last;
+	uint32			generation = 0;
+
+	if (sequence_cache_mode == SEQ_CACHE_SHARED)
+	{
+		slot = seq_cache_get_slot(elm->relid, true);
+		if (slot != NULL)
+		{
+			if (!seq_cache_take(slot, elm->filenode, &result))
+			{
+				LWLockAcquire(&slot->lease_lock, LW_EXCLUSIVE);
+
+				/* somebody else may have leased a new range meanwhile */
+				if (!seq_cache_take(slot, elm->filenode, &result))
+					goto lease_;
+				LWLockRelease(&slot->lease_lock);
+			}
+
+			elm->last = result;
+			elm->cached = result;
+			elm->last_valid = true;
+			return result;
+		}
+	}
+
+lease_:
+	/* lock page' buffer and read tuple */
+	seq = read_seq_tuple(elm, seqrel, &buf, &seqtuple);
+	incby = seq->increment_by;
+
+	/* reach max value or min value */
+	check_agtm_seq_limit(seqrel, seq, elm->last);
+
+	if (slot != NULL)
+		count = Max(seq->cache_value, (int64) sequence_lease_size);
+	else if (sequence_cache_mode == SEQ_CACHE_ORDERED)
+		count = 1;
+	else
+		count = seq->cache_value;	/* shared cache is full, lease for ourself */
+
+	databaseName = get_database_name(seqrel->rd_node.dbNode);
+	schemaName = get_namespace_name(RelationGetNamespace(seqrel));
+
+	/* the range may be older than a setval() done while AGTM answers */
+	if (slot != NULL)
+	{
+		SpinLockAcquire(&slot->mutex);
+		generation = slot->generation;
+		SpinLockRelease(&slot->mutex);
+	}
+
+	result = agtm_GetSeqNextRange(RelationGetRelationName(seqrel),
+								  databaseName, schemaName, count, &last);
+
+	pfree(databaseName);
+	pfree(schemaName);
+
+	/* Update the on-disk data */
+	seq->last_value = last;		/* last leased number */
+	seq->is_called = true;
+
+	UnlockReleaseBuffer(buf);
+
+	if (slot != NULL)
+	{
+		SpinLockAcquire(&slot->mutex);
+		if (slot->generation == generation)
+		{
+			slot->filenode = elm->filenode;
+			slot->increment = incby;
+			slot->last = result;
+			slot->cached = last;
+		}
+		SpinLockRelease(&slot->mutex);
+
+		LWLockRelease(&slot->lease_lock);
+
+		/* values of the lease belong to the whole node */
+		elm->cached = result;
+	}
+	else if (sequence_cache_mode == SEQ_CACHE_ORDERED)
+	{
+		elm->cached = result;
+	}
+	else
+	{
+		elm->cached = last;
+	}
+
+	elm->last = result;
+	elm->last_valid = true;
+
+	return result;
+}
+
+/*
+ * Find the shared cache slot of a sequence of the current database,
+ * assign a free one when "create" is true.
+ *
+ * Returns NULL when the shared cache is disabled or full.
+ */
+static SeqCacheSlot *
+seq_cache_get_slot(Oid relid, bool create)
+{
+	SeqCacheKey			key;
+	SeqCacheLookupEnt  *ent;
+	SeqCacheSlot	   *slot;
+	bool				found;
+	int					i;
+
+	if (SeqCacheCtl == NULL)
+		return NULL;
+
+	MemSet(&key, 0, sizeof(key));
+	key.dbid = MyDatabaseId;
+	key.relid = relid;
+
+	LWLockAcquire(SequenceCacheLock, LW_SHARED);
+	ent = (SeqCacheLookupEnt *) hash_search(SeqCacheHash, &key, HASH_FIND, NULL);
+	slot = (ent != NULL ? &SeqCacheCtl->slots[ent->slot] : NULL);
+	LWLockRelease(SequenceCacheLock);
+
+	if (slot != NULL || !create)
+		return slot;
+
+	LWLockAcquire(SequenceCacheLock, LW_EXCLUSIVE);
+	ent = (SeqCacheLookupEnt *) hash_search(SeqCacheHash, &key, HASH_ENTER_NULL, &found);
+	if (ent == NULL)
+	{
+		LWLockRelease(SequenceCacheLock);
+		return NULL;
+	}
+
+	if (!found)
+	{
+		for (i = 0; i < SeqCacheCtl->num_slots; i++)
+		{
+			if (!SeqCacheCtl->slots[i].in_use)
+				break;
+		}
+		if (i >= SeqCacheCtl->num_slots)
+		{
+			hash_search(SeqCacheHash, &key, HASH_REMOVE, NULL);
+			LWLockRelease(SequenceCacheLock);
+			ereport(DEBUG1,
+					(errmsg("shared sequence cache is full, sequence %u uses a private lease",
+							relid)));
+			return NULL;
+		}
+
+		slot = &SeqCacheCtl->slots[i];
+		slot->key = key;
+		slot->in_use = true;
+		SpinLockAcquire(&slot->mutex);
+		slot->filenode = InvalidOid;
+		slot->last = slot->cached = 0;
+		slot->increment = 0;
+		slot->generation++;		/* a lease of the previous owner is stale */
+		SpinLockRelease(&slot->mutex);
+		ent->slot = i;
+	}
+	slot = &SeqCacheCtl->slots[ent->slot];
+	LWLockRelease(SequenceCacheLock);
+
+	return slot;
+}
+
+/*
+ * Take the next value of the leased range, returns false when the range
+ * is used up or was leased for another relfilenode.
+ */
+static bool
+seq_cache_take(SeqCacheSlot *slot, Oid filenode, int64 *result)
+{
+	bool		found = false;
+
+	SpinLockAcquire(&slot->mutex);
+	if (slot->filenode == filenode && slot->last != slot->cached)
+	{
+		Assert(slot->increment != 0);
+		slot->last += slot->increment;
+		*result = slot->last;
+		found = true;
+	}
+	SpinLockRelease(&slot->mutex);
+
+	return found;
+}
+
+static void
+seq_cache_forget(SeqCacheKey *key)
+{
+	SeqCacheLookupEnt  *ent;
+
+	LWLockAcquire(SequenceCacheLock, LW_EXCLUSIVE);
+	ent = (SeqCacheLookupEnt *) hash_search(SeqCacheHash, key, HASH_REMOVE, NULL);
+	if (ent != NULL)
+		SeqCacheCtl->slots[ent->slot].in_use = false;
+	LWLockRelease(SequenceCacheLock);
+}
+
+/*
+ * Throw away the rest of the node-wide range of a sequence, used after
+ * setval() and ALTER SEQUENCE so that next nextval() asks AGTM again.
+ * Must be called after AGTM has the new state: a lease requested before
+ * is dropped by the generation check, one requested after sees it.
+ */
+void
+SequenceCacheInvalidate(Oid relid)
+{
+	SeqCacheSlot   *slot = seq_cache_get_slot(relid, false);
+
+	if (slot != NULL)
+	{
+		SpinLockAcquire(&slot->mutex);
+		slot->cached = slot->last;
+		slot->generation++;
+		SpinLockRelease(&slot->mutex);
+	}
+}
+
+/*
+ * Release the shared cache slots of all sequences of a dropped database.
+ */
+void
+SequenceCacheForgetDatabase(Oid dbid)
+{
+	HASH_SEQ_STATUS		status;
+	SeqCacheLookupEnt  *ent;
+
+	if (SeqCacheCtl == NULL)
+		return;
+
+	LWLockAcquire(SequenceCacheLock, LW_EXCLUSIVE);
+	hash_seq_init(&status, SeqCacheHash);
+	while ((ent = hash_seq_search(&status)) != NULL)
+	{
+		if (ent->key.dbid != dbid)
+			continue;
+		SeqCacheCtl->slots[ent->slot].in_use = false;
+		hash_search(SeqCacheHash, &ent->key, HASH_REMOVE, NULL);
+	}
+	LWLockRelease(SequenceCacheLock);
+}
+
+Size
+SequenceCacheShmemSize(void)
+{
+	Size		size;
+
+	if (shared_sequence_cache_size <= 0)
+		return 0;
+
+	size = offsetof(SeqCacheCtlData, slots);
+	size = add_size(size, mul_size(shared_sequence_cache_size,
+								   sizeof(SeqCacheSlot)));
+	size = add_size(size, hash_estimate_size(shared_sequence_cache_size,
+											 sizeof(SeqCacheLookupEnt)));
+
+	return size;
+}
+
+void
+SequenceCacheShmemInit(void)
+{
+	HASHCTL		info;
+	Size		size;
+	bool		found;
+	int			i;
+
+	if (shared_sequence_cache_size <= 0)
+		return;
+
+	size = offsetof(SeqCacheCtlData, slots);
+	size = add_size(size, mul_size(shared_sequence_cache_size,
+								   sizeof(SeqCacheSlot)));
+	SeqCacheCtl = (SeqCacheCtlData *)
+		ShmemInitStruct("Sequence Cache Ctl", size, &found);
+
+	SeqCacheLWLockTranche.name = "sequence_cache";
+	SeqCacheLWLockTranche.array_base =
+		((char *) SeqCacheCtl) + offsetof(SeqCacheCtlData, slots) +
+		offsetof(SeqCacheSlot, lease_lock);
+	SeqCacheLWLockTranche.array_stride = sizeof(SeqCacheSlot);
+	LWLockRegisterTranche(LWTRANCHE_SEQUENCE_CACHE, &SeqCacheLWLockTranche);
+
+	if (!found)
+	{
+		MemSet(SeqCacheCtl, 0, size);
+		SeqCacheCtl->num_slots = shared_sequence_cache_size;
+		for (i = 0; i < shared_sequence_cache_size; i++)
+		{
+			SeqCacheSlot *slot = &SeqCacheCtl->slots[i];
+
+			/* everything else is zeroed by the memset above */
+			SpinLockInit(&slot->mutex);
+			LWLockInitialize(&slot->lease_lock, LWTRANCHE_SEQUENCE_CACHE);
+		}
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(SeqCacheKey);
+	info.entrysize = sizeof(SeqCacheLookupEnt);
+	SeqCacheHash = ShmemInitHash("Sequence Cache Hash",
+								 shared_sequence_cache_size,
+								 shared_sequence_cache_size,
+								 &info,
+								 HASH_ELEM | HASH_BLOBS);
+}
+#endif /* ADB */
+
 Datum
 currval_oid(PG_FUNCTION_ARGS)
 {
@@ -1203,6 +1681,9 @@ do_setval(Oid relid, int64 next, bool iscalled)
 
 	/* In any case, forget any future cached numbers */
 	elm->cached = elm->last;
+#ifdef ADB
+	SequenceCacheInvalidate(relid);
+#endif
 
 	/* check the comment above nextval_internal()'s equivalent call. */
 	if (RelationNeedsWAL(seqrel))
@@ -11952,6 +11952,7 @@ AtExecDistributeBy(Relation rel, DistributeBy *options)
 	Oid funcid = InvalidOid;
 	int numatts = 0;
 	int16 *attnums = NULL;
+	ArrayType *rangebounds = NULL;
 
 	if (options == NULL)
 		return;
@@ -11968,7 +11969,8 @@ AtExecDistributeBy(Relation rel, DistributeBy *options)
 								 &attnum,
 								 &funcid,
 								 &numatts,
-								 &attnums
+								 &attnums,
+								 &rangebounds
 								 );
 
 	/*
@@ -11987,7 +11989,8 @@ AtExecDistributeBy(Relation rel, DistributeBy *options)
 				   PGXC_CLASS_ALTER_DISTRIBUTION,
 				   funcid,
 				   numatts,
-				   attnums
+				   attnums,
+				   rangebounds
 				   );
 
 	/* Make the additional catalog changes visible */
@@ -12027,6 +12030,7 @@ AtExecSubCluster(Relation rel, PGXCSubCluster *options)
 				   PGXC_CLASS_ALTER_NODES,
 				   0,
 				   0,
+				   NULL,
 				   NULL
 				   );
 
@@ -12077,6 +12081,7 @@ AtExecAddNode(Relation rel, List *options)
 				   PGXC_CLASS_ALTER_NODES,
 				   0,
 				   0,
+				   NULL,
 				   NULL
 				   );
 
@@ -12124,6 +12129,7 @@ AtExecDeleteNode(Relation rel, List *options)
 				   PGXC_CLASS_ALTER_NODES,
 				   0,
 				   0,
+				   NULL,
 				   NULL
 				   );
 
@@ -12182,6 +12188,7 @@ BuildRedistribCommands(Oid relid, List *subCmds)
 	int			numatts = 0;
 	int			idx = 0;
 	int16	   *attnums = NULL;
+	ArrayType  *rangebounds = NULL;
 
 	/* Get necessary information about relation */
 	rel = relation_open(redistribState->relid, NoLock);
@@ -12219,7 +12226,8 @@ BuildRedistribCommands(Oid relid, List *subCmds)
 											 (AttrNumber *)&(newLocInfo->partAttrNum),
 											 &funcid,
 											 &numatts,
-											 &attnums
+											 &attnums,
+											 &rangebounds
 											 );
 
 				newLocInfo->funcid = funcid;
@@ -12263,6 +12271,17 @@ BuildRedistribCommands(Oid relid, List *subCmds)
 	for (i = 0; i < new_num; i++)
 		newLocInfo->nodeids = lappend_oid(newLocInfo->nodeids, new_oid_array[i]);
 
+	/*
+	 * Bounds of a range distributed table have to match its nodes once all
+	 * the commands are done, the new ones or else the old ones.
+	 */
+	if (newLocInfo->locatorType == LOCATOR_TYPE_RANGE)
+		CheckRangeDistributionBounds(rangebounds ?
+									 ArrayGetNItems(ARR_NDIM(rangebounds),
+													ARR_DIMS(rangebounds)) :
+									 oldLocInfo->numRangeBounds,
+									 new_num);
+
 	/* Build the command tree for table redistribution */
 	PGXCRedistribCreateCommandList(redistribState, newLocInfo);
 
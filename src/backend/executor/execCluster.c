@@ -10,6 +10,7 @@
 #include "intercomm/inter-comm.h"
 #include "pgxc/pgxc.h"
 #include "pgxc/pgxcnode.h"
+#include "pgxc/redistrib.h"
 #include "lib/stringinfo.h"
 #include "libpq/libpq.h"
 #include "libpq/libpq-node.h"
@@ -237,6 +238,15 @@ static void ExecClusterCopyStmt(StringInfo buf)
 
 	stmt = (CopyStmt*)loadNode(&msg);
 	Assert(IsA(stmt, CopyStmt));
+
+	/* rows are moved among Datanodes by ALTER TABLE */
+	if (mem_toc_lookup(buf, REDISTRIB_KEY_REDUCE, NULL) != NULL)
+	{
+		set_ps_display("CLUSTER REDISTRIBUTE", false);
+		ClusterRedistribTable(stmt, buf);
+		return;
+	}
+
 	set_ps_display("CLUSTER COPY FROM", false);
 
 	DoClusterCopy(stmt, buf);
@@ -1020,7 +1030,10 @@ static List* StartRemotePlan(StringInfo msg, List *rnodes, ClusterPlanContext *c
 	/* try to start transaction */
 	state = GetCurrentInterXactState();
 	if (!context->transaction_read_only)
+	{
 		state->need_xact_block = true;
+		InterXactSaveWriteNodes(state, rnodes);
+	}
 	InterXactBegin(state, rnodes);
 	Assert(state->cur_handle);
 
@@ -50,7 +50,9 @@
 #include "nodes/nodeFuncs.h"
 #ifdef ADB
 #include "catalog/heap.h"
+#include "commands/copy.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/clauses.h"
 #include "parser/parsetree.h"
 #include "pgxc/execRemote.h"
 #include "pgxc/pgxc.h"
@@ -66,6 +68,7 @@
 static TupleTableSlot *fill_slot_with_oldvals(TupleTableSlot *slot,
 											  HeapTupleHeader oldtuphd,
 											  Bitmapset *modifiedCols);
+static bool CanClusterInsert(ModifyTableState *mtstate, int eflags);
 
 /* Copied from trigger.c */
 #define GetModifiedColumns(relinfo, estate) \
@@ -402,7 +405,13 @@ ExecInsert(ModifyTableState *mtstate,
 			ExecConstraints(resultRelInfo, slot, estate);
 
 #ifdef ADB
-		if (IsCnNode() && resultRemoteRel)
+		if (mtstate->mt_cluster_insert)
+		{
+			/* sent to Datanodes when all rows are got, see ExecModifyTable */
+			ClusterInsertPutSlot(mtstate->mt_cluster_insert, slot);
+			newId = InvalidOid;
+		}
+		else if (IsCnNode() && resultRemoteRel)
 		{
 			TupleTableSlot *saveSlot = NULL;
 
@@ -598,12 +607,18 @@ ExecInsert(ModifyTableState *mtstate,
 	if (canSetTag)
 	{
 #ifdef ADB
-		if (IsCnNode() && resultRemoteRel)
+		if (mtstate->mt_cluster_insert)
+			;					/* counted by EndClusterInsert */
+		else if (IsCnNode() && resultRemoteRel)
 			estate->es_processed += resultRemoteRel->rqs_processed;
 		else
 #endif
 		(estate->es_processed)++;
 		estate->es_lastoid = newId;
+#ifdef ADB
+		/* a row kept for the cluster COPY is not stored yet, it has no tid */
+		if (!mtstate->mt_cluster_insert)
+#endif
 		setLastTid(&(tuple->t_self));
 	}
 
@@ -1983,6 +1998,16 @@ ExecModifyTable(ModifyTableState *node)
 	estate->es_result_relation_info = saved_resultRelInfo;
 #ifdef ADB
 	estate->es_result_remoterel = saved_resultRemoteRel;
+
+	/* all rows are got, send them to Datanodes */
+	if (node->mt_cluster_insert)
+	{
+		uint64		processed = EndClusterInsert(node->mt_cluster_insert);
+
+		node->mt_cluster_insert = NULL;
+		if (node->canSetTag)
+			estate->es_processed += processed;
+	}
 #endif
 
 	/*
@@ -2525,6 +2550,16 @@ ExecInitModifyTable(ModifyTable *node, EState *estate, int eflags)
 	if (estate->es_trig_tuple_slot == NULL)
 		estate->es_trig_tuple_slot = ExecInitExtraTupleSlot(estate);
 
+#ifdef ADB
+	/*
+	 * Rows of INSERT are sent to Datanodes by one cluster COPY instead of a
+	 * remote INSERT per row, when nothing needs the rows one by one.
+	 */
+	if (CanClusterInsert(mtstate, eflags))
+		mtstate->mt_cluster_insert =
+			BeginClusterInsert(mtstate->resultRelInfo->ri_RelationDesc);
+#endif
+
 	/*
 	 * Lastly, if this is not the primary (canSetTag) ModifyTable node, add it
 	 * to estate->es_auxmodifytables so that it will be run to completion by
@@ -2660,4 +2695,59 @@ fill_slot_with_oldvals(TupleTableSlot *replace_slot, HeapTupleHeader oldtuphd, B
 	 */
 	return ExecStoreTuple(newtuple, replace_slot, InvalidBuffer, false);
 }
+
+/*
+ * CanClusterInsert:
+ * Can the rows of a remote INSERT be gathered and sent to Datanodes by
+ * BeginClusterInsert? Not when RETURNING, row triggers, check options or
+ * ON CONFLICT need each row to be inserted before the next one is got, and
+ * not for a single row, a remote INSERT is cheaper than starting a COPY.
+ */
+static bool
+CanClusterInsert(ModifyTableState *mtstate, int eflags)
+{
+	ResultRelInfo  *resultRelInfo = mtstate->resultRelInfo;
+	Relation		rel = resultRelInfo->ri_RelationDesc;
+	TriggerDesc	   *trigdesc = resultRelInfo->ri_TrigDesc;
+	Plan		   *subplan;
+
+	if (!IsCnNode() ||
+		mtstate->operation != CMD_INSERT ||
+		mtstate->mt_nplans != 1 ||
+		mtstate->mt_remoterels[0] == NULL ||
+		(eflags & EXEC_FLAG_EXPLAIN_ONLY))
+		return false;
+
+	if (rel == NULL ||
+		rel->rd_rel->relkind != RELKIND_RELATION ||
+		RelationGetLocInfo(rel) == NULL)
+		return false;
+
+	if (resultRelInfo->ri_projectReturning ||
+		resultRelInfo->ri_projectTuplestore ||
+		resultRelInfo->ri_WithCheckOptions != NIL ||
+		resultRelInfo->ri_FdwRoutine != NULL ||
+		mtstate->mt_onconflict != ONCONFLICT_NONE)
+		return false;
+
+	if (trigdesc &&
+		(trigdesc->trig_insert_before_row ||
+		 trigdesc->trig_insert_after_row ||
+		 trigdesc->trig_insert_instead_row))
+		return false;
+
+	/* INSERT ... VALUES of one row */
+	subplan = mtstate->mt_plans[0]->plan;
+	if (IsA(subplan, Result) && outerPlan(subplan) == NULL)
+		return false;
+
+	/*
+	 * Like COPY FROM, volatile default expressions might query the table
+	 * and expect rows inserted before are there.
+	 */
+	if (contain_volatile_functions_not_nextval((Node *) subplan->targetlist))
+		return false;
+
+	return true;
+}
 #endif
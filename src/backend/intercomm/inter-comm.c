@@ -348,6 +348,58 @@ HandleBegin(InterXactState state, NodeHandle *handle,
 	return 0;
 }
 
+/*
+ * HandleListBegin
+ *
+ * send BEGIN message to all of "handle_list" first, then receive their
+ * responses, so the remote nodes start transaction concurrently rather
+ * than one round trip after another.
+ *
+ * return NULL if OK
+ * return the NodeHandle in trouble otherwise
+ */
+NodeHandle *
+HandleListBegin(InterXactState state, List *handle_list,
+				GlobalTransactionId xid, TimestampTz timestamp,
+				bool need_xact_block)
+{
+	NodeHandle	   *handle;
+	ListCell	   *lc_handle;
+	List		   *begin_list = NIL;
+	bool			already_begin;
+
+	foreach (lc_handle, handle_list)
+	{
+		handle = (NodeHandle *) lfirst(lc_handle);
+
+		/* cache or GC */
+		HandleCacheOrGC(handle);
+
+		if (!HandleSendBegin(handle, xid, timestamp, need_xact_block, &already_begin))
+		{
+			list_free(begin_list);
+			return handle;
+		}
+
+		if (!already_begin && need_xact_block)
+			begin_list = lappend(begin_list, handle);
+	}
+
+	foreach (lc_handle, begin_list)
+	{
+		handle = (NodeHandle *) lfirst(lc_handle);
+		if (!HandleFinishCommand(handle, TRANS_START_TAG))
+		{
+			list_free(begin_list);
+			return handle;
+		}
+		InterXactSaveBeginNodes(state, handle->node_id);
+	}
+	list_free(begin_list);
+
+	return NULL;
+}
+
 /*
  * HandleSendBegin
  *
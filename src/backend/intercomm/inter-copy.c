@@ -43,6 +43,7 @@ static int HandleStartRemoteCopy(NodeHandle *handle, CommandId cmid, Snapshot sn
 static bool HandleRecvCopyResult(NodeHandle *handle);
 static void FetchRemoteCopyRow(RemoteCopyState *node, StringInfo row);
 static bool FetchCopyRowHook(void *context, struct pg_conn *conn, PQNHookFuncType type, ...);
+static bool CopyToFileResultHook(void *context, struct pg_conn *conn, PQNHookFuncType type, ...);
 
 /*
  * StartRemoteCopy
@@ -59,7 +60,6 @@ StartRemoteCopy(RemoteCopyState *node)
 	const char		   *copy_query;
 	const List		   *node_list;
 	bool				is_from;
-	bool				already_begin;
 	Snapshot			snap;
 	CommandId			cmid;
 	TimestampTz			timestamp;
@@ -83,6 +83,8 @@ StartRemoteCopy(RemoteCopyState *node)
 	state = MakeInterXactState2(GetCurrentInterXactState(), node_list);
 	/* It is no need to send BEGIN when COPY TO */
 	state->need_xact_block = is_from;
+	if (is_from)
+		InterXactSaveWriteNodes(state, node_list);
 	cur_handle = state->cur_handle;
 
 	agtm_BeginTransaction();
@@ -90,13 +92,19 @@ StartRemoteCopy(RemoteCopyState *node)
 
 	PG_TRY();
 	{
+		handle = HandleListBegin(state, cur_handle->handles,
+								 gxid, timestamp, is_from);
+		if (handle)
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("Fail to start remote COPY %s", is_from ? "FROM" : "TO"),
+					 errnode(NameStr(handle->node_name)),
+					 errdetail("%s", HandleGetError(handle))));
+
 		foreach (lc_handle, cur_handle->handles)
 		{
 			handle = (NodeHandle *) lfirst(lc_handle);
-			already_begin = false;
-
-			if (!HandleBegin(state, handle, gxid, timestamp, is_from, &already_begin) ||
-				!HandleStartRemoteCopy(handle, cmid, snap, copy_query))
+			if (!HandleStartRemoteCopy(handle, cmid, snap, copy_query))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_INTERNAL_ERROR),
@@ -267,6 +275,90 @@ DoRemoteCopyTo(RemoteCopyState *node)
 	return node->processed;
 }
 
+/*
+ * DoRemoteCopyToFiles
+ *
+ * Send each node of node_list its COPY TO file query in query_list, which
+ * has the same order, then wait until all of them finish. Nodes write their
+ * own files at the same time, no data passes through this node.
+ *
+ * return the count of rows written by all nodes
+ */
+uint64
+DoRemoteCopyToFiles(const List *node_list, const List *query_list)
+{
+	InterXactState		state;
+	NodeMixHandle	   *cur_handle;
+	NodeHandle		   *handle;
+	ListCell		   *lc_handle;
+	ListCell		   *lc_node;
+	ListCell		   *lc_query;
+	const char		   *copy_query;
+	Snapshot			snap;
+	CommandId			cmid;
+	TimestampTz			timestamp;
+	GlobalTransactionId gxid;
+	uint64				processed = 0;
+
+	Assert(list_length(node_list) == list_length(query_list));
+	if (node_list == NIL)
+		return 0;
+
+	cmid = GetCurrentCommandId(false);
+	snap = GetActiveSnapshot();
+	timestamp = GetCurrentTransactionStartTimestamp();
+	state = MakeInterXactState2(GetCurrentInterXactState(), node_list);
+	/* It is no need to send BEGIN when COPY TO */
+	state->need_xact_block = false;
+	cur_handle = state->cur_handle;
+
+	agtm_BeginTransaction();
+	gxid = GetCurrentTransactionId();
+
+	PG_TRY();
+	{
+		handle = HandleListBegin(state, cur_handle->handles,
+								 gxid, timestamp, false);
+		if (handle)
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("Fail to start remote COPY TO"),
+					 errnode(NameStr(handle->node_name)),
+					 errdetail("%s", HandleGetError(handle))));
+
+		foreach (lc_handle, cur_handle->handles)
+		{
+			handle = (NodeHandle *) lfirst(lc_handle);
+			copy_query = NULL;
+			forboth (lc_node, node_list, lc_query, query_list)
+			{
+				if (lfirst_oid(lc_node) == handle->node_id)
+				{
+					copy_query = (const char *) lfirst(lc_query);
+					break;
+				}
+			}
+			Assert(copy_query);
+
+			if (!HandleSendQueryTree(handle, cmid, snap, copy_query, NULL))
+				ereport(ERROR,
+						(errcode(ERRCODE_INTERNAL_ERROR),
+						 errmsg("Fail to start remote COPY TO"),
+						 errnode(NameStr(handle->node_name)),
+						 errdetail("%s", HandleGetError(handle))));
+		}
+
+		PQNListExecFinish(cur_handle->handles, HandleGetPGconn,
+						  CopyToFileResultHook, &processed, true);
+	} PG_CATCH();
+	{
+		InterXactGCCurrent(state);
+		PG_RE_THROW();
+	} PG_END_TRY();
+
+	return processed;
+}
+
 /*
  * HandleCopyOutRow
  *
@@ -281,7 +373,10 @@ HandleCopyOutRow(RemoteCopyState *node, char *buf, int len)
 		case REMOTE_COPY_FILE:
 			Assert(node->copy_file);
 			/* Write data directly to file */
-			fwrite(buf, 1, len, node->copy_file);
+			if (fwrite(buf, 1, len, node->copy_file) != len)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not write to COPY file: %m")));
 			break;
 		case REMOTE_COPY_STDOUT:
 			/* Send back data to client */
@@ -468,6 +563,48 @@ FetchCopyRowHook(void *context, struct pg_conn *conn, PQNHookFuncType type, ...)
 	return false;
 }
 
+/*
+ * CopyToFileResultHook
+ *
+ * Add count of rows in command tag of each COPY TO file to context.
+ */
+static bool
+CopyToFileResultHook(void *context, struct pg_conn *conn, PQNHookFuncType type, ...)
+{
+	va_list args;
+
+	switch(type)
+	{
+		case PQNHFT_ERROR:
+			return PQNEFHNormal(NULL, conn, type);
+		case PQNHFT_COPY_IN_ONLY:
+			PQputCopyEnd(conn, NULL);
+			break;
+		case PQNHFT_RESULT:
+			{
+				PGresult	   *res;
+				ExecStatusType	status;
+
+				va_start(args, type);
+				res = va_arg(args, PGresult*);
+				if(res)
+				{
+					status = PQresultStatus(res);
+					if(status == PGRES_FATAL_ERROR)
+						PQNReportResultError(res, conn, ERROR, true);
+					else if(status == PGRES_COMMAND_OK)
+						*((uint64 *) context) += strtoul(PQcmdTuples(res), NULL, 10);
+				}
+				va_end(args);
+			}
+			break;
+		default:
+			break;
+	}
+
+	return false;
+}
+
 /*
  * LookupNodeHandle
  *
@@ -33,8 +33,10 @@
 #include "nodes/nodeFuncs.h"
 #include "optimizer/pgxcplan.h"
 #include "parser/parse_coerce.h"
+#include "pgxc/execRemote.h"
 #include "pgxc/locator.h"
 #include "pgxc/pgxcnode.h"
+#include "utils/array.h"
 #include "utils/lsyscache.h"
 #include "utils/snapmgr.h"
 
@@ -49,6 +51,8 @@ typedef struct RemoteQueryContext
 } RemoteQueryContext;
 
 static List *RewriteExecNodes(RemoteQueryState *planstate, ExecNodes *exec_nodes);
+static List *RewriteExecNodesByArray(RemoteQueryState *planstate, ExecNodes *exec_nodes,
+									 RelationLocInfo *rel_loc);
 static TupleTableSlot *InterXactQuery(InterXactState state, RemoteQueryState *node, TupleTableSlot *destslot);
 static bool HandleStartRemoteQuery(NodeHandle *handle, RemoteQueryState *node);
 static TupleTableSlot *RestoreRemoteSlot(const char *buf, int len, TupleTableSlot *slot, Oid node_id);
@@ -133,6 +137,13 @@ RewriteExecNodes(RemoteQueryState *planstate, ExecNodes *exec_nodes)
 	Assert(!(exec_nodes->accesstype == RELATION_ACCESS_READ_FOR_UPDATE &&
 			IsRelationReplicated(rel_loc)));
 
+	if (exec_nodes->en_expr_is_array)
+	{
+		result = RewriteExecNodesByArray(planstate, exec_nodes, rel_loc);
+		FreeRelationLocInfo(rel_loc);
+		return result;
+	}
+
 	nelems = list_length(exec_nodes->en_expr);
 	en_expr_values = (Datum *) palloc0(sizeof(Datum) * nelems);
 	en_expr_nulls = (bool *) palloc0(sizeof(bool) * nelems);
@@ -192,6 +203,124 @@ RewriteExecNodes(RemoteQueryState *planstate, ExecNodes *exec_nodes)
 	return result;
 }
 
+/*
+ * The en_expr is an array of distribution values, run on the nodes of all
+ * its elements. When it is a parameter used only by the distribution column
+ * qual, each node is sent only the elements belonging to it.
+ */
+static List *
+RewriteExecNodesByArray(RemoteQueryState *planstate, ExecNodes *exec_nodes,
+						RelationLocInfo *rel_loc)
+{
+	ExprState	   *estate;
+	ArrayType	   *array;
+	Datum			arrayval;
+	bool			isnull;
+	Oid				elemtype;
+	Oid				disttype;
+	int16			elmlen;
+	bool			elmbyval;
+	char			elmalign;
+	Datum		   *values;
+	bool		   *nulls;
+	Oid			   *elem_nodes;
+	int				nelems;
+	int				i;
+	bool			can_split;
+	ListCell	   *lc;
+	List		   *result = NIL;
+
+	Assert(list_length(exec_nodes->en_expr) == 1);
+	FreeNodeDataRowForExtParams(planstate);
+
+	estate = ExecInitExpr((Expr *) linitial(exec_nodes->en_expr),
+						  (PlanState *) planstate);
+	arrayval = ExecEvalExpr(estate,
+							planstate->ss.ps.ps_ExprContext,
+							&isnull,
+							NULL);
+	if (isnull)
+	{
+		/* no element is known, same as a NULL value */
+		elemtype = InvalidOid;
+		return GetInvolvedNodes(rel_loc, 1, &arrayval, &isnull, &elemtype,
+								exec_nodes->accesstype);
+	}
+
+	/* elements are routed as the distribution type, a relabeled array keeps its own */
+	disttype = get_element_type(exprType((Node *) linitial(exec_nodes->en_expr)));
+	array = DatumGetArrayTypeP(arrayval);
+	elemtype = ARR_ELEMTYPE(array);
+	get_typlenbyvalalign(elemtype, &elmlen, &elmbyval, &elmalign);
+	deconstruct_array(array, elemtype, elmlen, elmbyval, elmalign,
+					  &values, &nulls, &nelems);
+
+	elem_nodes = (Oid *) palloc(sizeof(Oid) * nelems);
+	can_split = true;
+	for (i = 0; i < nelems; i++)
+	{
+		List *node_list;
+
+		/* NULL equals to nothing */
+		elem_nodes[i] = InvalidOid;
+		if (nulls[i])
+			continue;
+
+		node_list = GetInvolvedNodes(rel_loc, 1, &values[i], &nulls[i], &disttype,
+									 exec_nodes->accesstype);
+		if (list_length(node_list) == 1)
+			elem_nodes[i] = linitial_oid(node_list);
+		else
+			can_split = false;
+		result = list_concat_unique_oid(result, node_list);
+		list_free(node_list);
+	}
+
+	if (result == NIL)
+	{
+		/* no row can match, any node gives the same */
+		result = list_make1_oid(linitial_oid(rel_loc->nodeids));
+	}
+	/* split the original elements, only if they are routed as they are */
+	else if (can_split &&
+			 IsBinaryCoercible(elemtype, disttype) &&
+			 exec_nodes->en_array_paramid > 0 &&
+			 exec_nodes->en_array_paramid <= planstate->rqs_num_params &&
+			 planstate->paramval_data != NULL &&
+			 list_length(result) > 1)
+	{
+		Datum  *node_values = (Datum *) palloc(sizeof(Datum) * nelems);
+
+		foreach(lc, result)
+		{
+			Oid			node_id = lfirst_oid(lc);
+			ArrayType  *node_array;
+			int			n = 0;
+
+			for (i = 0; i < nelems; i++)
+			{
+				if (elem_nodes[i] == node_id)
+					node_values[n++] = values[i];
+			}
+			node_array = construct_array(node_values, n, elemtype,
+										 elmlen, elmbyval, elmalign);
+			SetNodeDataRowForExtParams(planstate->ss.ps.state->es_param_list_info,
+									   planstate,
+									   node_id,
+									   exec_nodes->en_array_paramid,
+									   PointerGetDatum(node_array));
+			pfree(node_array);
+		}
+		pfree(node_values);
+	}
+
+	pfree(elem_nodes);
+	pfree(values);
+	pfree(nulls);
+
+	return result;
+}
+
 List *
 GetRemoteNodeList(RemoteQueryState *planstate, ExecNodes *exec_nodes, RemoteQueryExecType exec_type)
 {
@@ -290,7 +419,10 @@ StartRemoteQuery(RemoteQueryState *node, TupleTableSlot *destslot)
 	else
 		need_xact_block = true;
 	if (need_xact_block)
+	{
 		state->need_xact_block = true;
+		InterXactSaveWriteNodes(state, node_list);
+	}
 
 	/* save handle list for current RemoteQueryState */
 	if (node->cur_handles)
@@ -309,7 +441,6 @@ InterXactQuery(InterXactState state, RemoteQueryState *node, TupleTableSlot *des
 	NodeHandle		   *pr_handle;
 	ListCell		   *lc_handle;
 	bool				need_xact_block;
-	bool				already_begin;
 	GlobalTransactionId	gxid;
 	TimestampTz			timestamp = GetCurrentTransactionStartTimestamp();
 
@@ -327,6 +458,15 @@ InterXactQuery(InterXactState state, RemoteQueryState *node, TupleTableSlot *des
 
 	PG_TRY();
 	{
+		handle = HandleListBegin(state, cur_handle->handles,
+								 gxid, timestamp, need_xact_block);
+		if (handle)
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("Fail to start query on remote node"),
+					 errnode(NameStr(handle->node_name)),
+					 errhint("%s", HandleGetError(handle))));
+
 		if (pr_handle)
 		{
 			Tuplestorestate	   *tuplestorestate = node->tuplestorestate;
@@ -334,8 +474,7 @@ InterXactQuery(InterXactState state, RemoteQueryState *node, TupleTableSlot *des
 
 			Assert(tuplestorestate);
 
-			if (!HandleBegin(state, pr_handle, gxid, timestamp, need_xact_block, &already_begin) ||
-				!HandleStartRemoteQuery(pr_handle, node))
+			if (!HandleStartRemoteQuery(pr_handle, node))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_INTERNAL_ERROR),
@@ -366,8 +505,7 @@ InterXactQuery(InterXactState state, RemoteQueryState *node, TupleTableSlot *des
 			if (handle == pr_handle)
 				continue;
 
-			if (!HandleBegin(state, handle, gxid, timestamp, need_xact_block, &already_begin) ||
-				!HandleStartRemoteQuery(handle, node))
+			if (!HandleStartRemoteQuery(handle, node))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_INTERNAL_ERROR),
@@ -444,6 +582,23 @@ HandleStartRemoteQuery(NodeHandle *handle, RemoteQueryState *node)
 		int		fetch = 0;
 		bool	prepared = false;
 		bool	send_desc = false;
+		const char *stmt_name;
+		const char *paramval_data = node->paramval_data;
+		int		paramval_len = node->paramval_len;
+		ListCell *lc;
+
+		/* some nodes may have their own parameter values */
+		foreach(lc, node->node_paramvals)
+		{
+			RemoteNodeParamData *node_param = (RemoteNodeParamData *) lfirst(lc);
+
+			if (node_param->node_id == handle->node_id)
+			{
+				paramval_data = node_param->paramval_data;
+				paramval_len = node_param->paramval_len;
+				break;
+			}
+		}
 
 		if (step->base_tlist != NULL ||
 			step->exec_nodes->accesstype == RELATION_ACCESS_READ ||
@@ -452,7 +607,19 @@ HandleStartRemoteQuery(NodeHandle *handle, RemoteQueryState *node)
 
 		/* if prepared statement is referenced see if it is already exist */
 		if (step->statement)
+		{
+			HandleCheckRemoteSession(handle);
 			prepared = ActivateDatanodeStatementOnNode(step->statement, handle->node_id);
+			stmt_name = step->statement;
+		} else
+		{
+			/* reuse the statement prepared by former execution */
+			stmt_name = HandleGetRemoteStatement(handle,
+												 step->sql_statement,
+												 node->rqs_num_params,
+												 node->rqs_param_types,
+												 &prepared);
+		}
 		/*
 		 * execute and fetch rows only if they will be consumed
 		 * immediately by the sorter
@@ -464,15 +631,15 @@ HandleStartRemoteQuery(NodeHandle *handle, RemoteQueryState *node)
 								   cid,
 								   snapshot,
 								   prepared ? NULL : step->sql_statement,
-								   step->statement,
+								   stmt_name,
 								   step->cursor,
 								   send_desc,
 								   fetch,
 								   node->rqs_num_params,
 								   node->rqs_param_types,
 								   NULL,
-								   node->paramval_data,
-								   node->paramval_len,
+								   paramval_data,
+								   paramval_len,
 								   0,
 								   NULL))
 			return false;
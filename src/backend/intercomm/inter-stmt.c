@@ -0,0 +1,473 @@
+/*-------------------------------------------------------------------------
+ *
+ * inter-stmt.c
+ *	  Cache of statements prepared on remote sessions for shipped queries
+ *
+ * A shipped query using extended query protocol used to be parsed and
+ * planned by the remote node again for every execution. Now it is prepared
+ * once as a named statement on the remote session, later executions send
+ * Bind and Execute only. Only queries having parameters are cached, they
+ * come from a generic plan of a prepared statement or plan cache; a query
+ * with literal values is hardly run again. When a remote session has
+ * remote_statement_cache_size statements, the least recently used one not
+ * used by current transaction is closed to cache a new one.
+ *
+ * Pooled remote sessions are shared by backends. When pool manager gives a
+ * session to another backend, the remote node drops all its prepared
+ * statements and bumps the "session_epoch" it reports, so statements
+ * cached for a node are forgotten once the remote backend pid, cancel key
+ * or epoch changed.
+ *
+ * A statement used by an aborted transaction is forgotten too, in case its
+ * Parse failed or it became unusable after DDL, the next execution prepares
+ * it again by another name. It is closed on the remote session before the
+ * session is used next time, when no error is pending any more.
+ *
+ * Statement names include MyProcPid, so names of former owner of a pooled
+ * session never collide with ours even if its statements were left there.
+ *
+ * Portions Copyright (c) 2016-2017, ADB Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/intercomm/inter-stmt.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/xact.h"
+#include "commands/prepare.h"
+#include "intercomm/inter-comm.h"
+#include "lib/ilist.h"
+#include "libpq/libpq-fe.h"
+#include "libpq/libpq-int.h"
+#include "miscadmin.h"
+#include "nodes/pg_list.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+
+/* the remote session statements of a node were prepared on */
+typedef struct RemoteSession
+{
+	Oid			node_id;		/* hash key */
+	int			be_pid;
+	int			be_key;
+	uint32		epoch;
+	int			num_stmts;		/* statements cached for the session */
+	dlist_head	lru;			/* statements cached for the session, most
+								 * recently used first */
+	List	   *closing;		/* names of forgotten statements not closed
+								 * yet, palloc in RemoteStmtContext */
+} RemoteSession;
+
+typedef struct RemoteStmtKey
+{
+	Oid			node_id;
+	const char *sql;
+	int			num_params;
+	const Oid  *param_types;
+} RemoteStmtKey;
+
+typedef struct RemoteStmt
+{
+	RemoteStmtKey	key;			/* hash key, palloc in RemoteStmtContext */
+	char			name[NAMEDATALEN];
+	dlist_node		lru_node;		/* in RemoteSession::lru */
+	SubTransactionId subid;			/* subtransaction used it last, invalid
+									 * if not used by current transaction */
+} RemoteStmt;
+
+/* GUC variable, statements cached for each remote node */
+int RemoteStatementCacheSize = 64;
+
+static MemoryContext RemoteStmtContext = NULL;
+static HTAB *remote_sessions = NULL;
+static HTAB *remote_stmts = NULL;
+static uint32 remote_stmt_counter = 0;
+static int remote_stmts_in_xact = 0;	/* statements having valid subid */
+
+static void InitRemoteStmtCache(void);
+static uint32 RemoteStmtHash(const void *key, Size keysize);
+static int RemoteStmtMatch(const void *key1, const void *key2, Size keysize);
+static RemoteSession *GetRemoteSession(NodeHandle *handle, bool *changed);
+static void ForgetRemoteStmt(RemoteStmt *stmt, bool close);
+static bool EvictRemoteStmt(RemoteSession *session);
+static void CloseForgottenStmts(NodeHandle *handle, RemoteSession *session);
+static void RemoteStmtXactCallback(XactEvent event, void *arg);
+static void RemoteStmtSubXactCallback(SubXactEvent event, SubTransactionId mySubid,
+									  SubTransactionId parentSubid, void *arg);
+
+static void
+InitRemoteStmtCache(void)
+{
+	HASHCTL		hctl;
+
+	Assert(RemoteStmtContext == NULL);
+	RemoteStmtContext = AllocSetContextCreate(TopMemoryContext,
+											  "Remote statement cache",
+											  ALLOCSET_DEFAULT_SIZES);
+
+	MemSet(&hctl, 0, sizeof(hctl));
+	hctl.keysize = sizeof(Oid);
+	hctl.entrysize = sizeof(RemoteSession);
+	hctl.hcxt = RemoteStmtContext;
+	remote_sessions = hash_create("Remote sessions", 64, &hctl,
+								  HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+	MemSet(&hctl, 0, sizeof(hctl));
+	hctl.keysize = sizeof(RemoteStmtKey);
+	hctl.entrysize = sizeof(RemoteStmt);
+	hctl.hash = RemoteStmtHash;
+	hctl.match = RemoteStmtMatch;
+	hctl.hcxt = RemoteStmtContext;
+	remote_stmts = hash_create("Remote statements", 256, &hctl,
+							   HASH_ELEM | HASH_FUNCTION | HASH_COMPARE | HASH_CONTEXT);
+
+	RegisterXactCallback(RemoteStmtXactCallback, NULL);
+	RegisterSubXactCallback(RemoteStmtSubXactCallback, NULL);
+}
+
+static uint32
+RemoteStmtHash(const void *key, Size keysize)
+{
+	const RemoteStmtKey *k = (const RemoteStmtKey *) key;
+	uint32		h;
+
+	h = DatumGetUInt32(hash_any((const unsigned char *) k->sql, strlen(k->sql)));
+	h ^= DatumGetUInt32(hash_uint32(k->node_id));
+	if (k->num_params > 0)
+		h ^= DatumGetUInt32(hash_any((const unsigned char *) k->param_types,
+									 k->num_params * sizeof(Oid)));
+
+	return h;
+}
+
+static int
+RemoteStmtMatch(const void *key1, const void *key2, Size keysize)
+{
+	const RemoteStmtKey *k1 = (const RemoteStmtKey *) key1;
+	const RemoteStmtKey *k2 = (const RemoteStmtKey *) key2;
+
+	if (k1->node_id != k2->node_id ||
+		k1->num_params != k2->num_params)
+		return 1;
+	if (k1->num_params > 0 &&
+		memcmp(k1->param_types, k2->param_types, k1->num_params * sizeof(Oid)) != 0)
+		return 1;
+
+	return strcmp(k1->sql, k2->sql);
+}
+
+/*
+ * Get the remote session of handle, statements cached for the node are
+ * forgotten and "changed" is set true if it is not the one they were
+ * prepared on.
+ *
+ * return NULL if the session can not be identified
+ */
+static RemoteSession *
+GetRemoteSession(NodeHandle *handle, bool *changed)
+{
+	PGconn		   *conn = handle->node_conn;
+	RemoteSession  *session;
+	const char	   *epoch_str;
+	uint32			epoch;
+	bool			found;
+
+	*changed = false;
+	/* old remote node don't report epoch */
+	epoch_str = PQparameterStatus(conn, "session_epoch");
+	if (epoch_str == NULL || conn->be_pid == 0)
+		return NULL;
+	epoch = (uint32) strtoul(epoch_str, NULL, 10);
+
+	if (remote_sessions == NULL)
+		InitRemoteStmtCache();
+
+	session = (RemoteSession *) hash_search(remote_sessions, &handle->node_id,
+											HASH_ENTER, &found);
+	if (found &&
+		session->be_pid == conn->be_pid &&
+		session->be_key == conn->be_key &&
+		session->epoch == epoch)
+	{
+		if (session->closing != NIL)
+			CloseForgottenStmts(handle, session);
+		return session;
+	}
+
+	if (found)
+	{
+		HASH_SEQ_STATUS seq;
+		RemoteStmt	   *stmt;
+
+		hash_seq_init(&seq, remote_stmts);
+		while ((stmt = (RemoteStmt *) hash_seq_search(&seq)) != NULL)
+		{
+			if (stmt->key.node_id == handle->node_id)
+				ForgetRemoteStmt(stmt, false);
+		}
+		/* the remote node dropped them already */
+		list_free_deep(session->closing);
+		*changed = true;
+	}
+	session->closing = NIL;
+	session->be_pid = conn->be_pid;
+	session->be_key = conn->be_key;
+	session->epoch = epoch;
+	session->num_stmts = 0;
+	dlist_init(&session->lru);
+
+	return session;
+}
+
+/*
+ * Remove stmt from the cache, "close" says if it is still prepared on the
+ * remote session and should be closed there.
+ */
+static void
+ForgetRemoteStmt(RemoteStmt *stmt, bool close)
+{
+	RemoteSession  *session;
+	char		   *sql = (char *) stmt->key.sql;
+	Oid			   *param_types = (Oid *) stmt->key.param_types;
+
+	session = (RemoteSession *) hash_search(remote_sessions, &stmt->key.node_id,
+											HASH_FIND, NULL);
+	dlist_delete(&stmt->lru_node);
+	if (session)
+	{
+		session->num_stmts--;
+		if (close)
+		{
+			MemoryContext old_context = MemoryContextSwitchTo(RemoteStmtContext);
+			session->closing = lappend(session->closing, pstrdup(stmt->name));
+			MemoryContextSwitchTo(old_context);
+		}
+	}
+	if (stmt->subid != InvalidSubTransactionId)
+		remote_stmts_in_xact--;
+
+	hash_search(remote_stmts, &stmt->key, HASH_REMOVE, NULL);
+	pfree(sql);
+	if (param_types)
+		pfree(param_types);
+}
+
+/*
+ * Forget the least recently used statement of session not used by current
+ * transaction, CloseForgottenStmts() closes it on the remote session.
+ *
+ * return false if all of them are used by current transaction
+ */
+static bool
+EvictRemoteStmt(RemoteSession *session)
+{
+	dlist_iter		iter;
+	RemoteStmt	   *stmt;
+
+	dlist_reverse_foreach(iter, &session->lru)
+	{
+		stmt = dlist_container(RemoteStmt, lru_node, iter.cur);
+		if (stmt->subid == InvalidSubTransactionId)
+		{
+			ForgetRemoteStmt(stmt, true);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Close statements forgotten by aborted transactions or evicted on the
+ * remote session of handle. A statement failed to close is left there, its name is never
+ * used again.
+ */
+static void
+CloseForgottenStmts(NodeHandle *handle, RemoteSession *session)
+{
+	List	   *closing = session->closing;
+	ListCell   *lc;
+
+	/* forget them first, don't try again if close failed */
+	session->closing = NIL;
+
+	HandleCacheOrGC(handle);
+	foreach (lc, closing)
+	{
+		const char *name = (const char *) lfirst(lc);
+
+		if (!HandleClose(handle, true, name))
+			ereport(DEBUG1,
+					(errmsg("fail to close remote statement \"%s\"", name),
+					 errnode(NameStr(handle->node_name)),
+					 errhint("%s", PQerrorMessage(handle->node_conn))));
+	}
+	list_free_deep(closing);
+}
+
+/*
+ * HandleCheckRemoteSession
+ *
+ * Make sure Datanode statements are not considered active on the remote
+ * node of handle if its session was changed.
+ */
+void
+HandleCheckRemoteSession(NodeHandle *handle)
+{
+	bool		changed;
+
+	Assert(handle && handle->node_conn);
+	(void) GetRemoteSession(handle, &changed);
+	if (changed)
+		DeactivateDatanodeStatementsOnNode(handle->node_id);
+}
+
+/*
+ * HandleGetRemoteStatement
+ *
+ * Get name of statement to run "sql" on remote session of handle, set
+ * "prepared" true if the statement is already prepared there and Parse
+ * is not needed.
+ *
+ * return NULL if the statement is not cached, use unnamed statement then.
+ * Statement without parameters is not cached.
+ */
+const char *
+HandleGetRemoteStatement(NodeHandle *handle,
+						 const char *sql,
+						 int num_params,
+						 const Oid *param_types,
+						 bool *prepared)
+{
+	RemoteSession  *session;
+	RemoteStmt	   *stmt;
+	RemoteStmtKey	key;
+	MemoryContext	old_context;
+	bool			changed;
+
+	Assert(handle && prepared);
+	*prepared = false;
+	if (RemoteStatementCacheSize <= 0 || sql == NULL || num_params <= 0)
+		return NULL;
+
+	session = GetRemoteSession(handle, &changed);
+	if (session == NULL)
+		return NULL;
+	if (changed)
+		DeactivateDatanodeStatementsOnNode(handle->node_id);
+
+	key.node_id = handle->node_id;
+	key.sql = sql;
+	key.num_params = num_params;
+	key.param_types = param_types;
+	stmt = (RemoteStmt *) hash_search(remote_stmts, &key, HASH_FIND, NULL);
+	if (stmt == NULL)
+	{
+		if (session->num_stmts >= RemoteStatementCacheSize)
+		{
+			while (session->num_stmts >= RemoteStatementCacheSize)
+			{
+				if (!EvictRemoteStmt(session))
+					return NULL;
+			}
+			CloseForgottenStmts(handle, session);
+		}
+
+		/* copy key first, no entry is left if out of memory */
+		old_context = MemoryContextSwitchTo(RemoteStmtContext);
+		key.sql = pstrdup(sql);
+		{
+			Oid *types = (Oid *) palloc(num_params * sizeof(Oid));
+			memcpy(types, param_types, num_params * sizeof(Oid));
+			key.param_types = types;
+		}
+		MemoryContextSwitchTo(old_context);
+
+		stmt = (RemoteStmt *) hash_search(remote_stmts, &key, HASH_ENTER, NULL);
+		snprintf(stmt->name, sizeof(stmt->name), "adb_stmt_%d_%u",
+				 MyProcPid, ++remote_stmt_counter);
+		stmt->subid = InvalidSubTransactionId;
+		dlist_push_head(&session->lru, &stmt->lru_node);
+		session->num_stmts++;
+	}else
+	{
+		dlist_move_head(&session->lru, &stmt->lru_node);
+		*prepared = true;
+	}
+
+	if (stmt->subid == InvalidSubTransactionId)
+		remote_stmts_in_xact++;
+	stmt->subid = GetCurrentSubTransactionId();
+
+	return stmt->name;
+}
+
+static void
+RemoteStmtXactCallback(XactEvent event, void *arg)
+{
+	HASH_SEQ_STATUS seq;
+	RemoteStmt	   *stmt;
+
+	if (remote_stmts_in_xact == 0)
+		return;
+
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PREPARE:
+			hash_seq_init(&seq, remote_stmts);
+			while ((stmt = (RemoteStmt *) hash_seq_search(&seq)) != NULL)
+				stmt->subid = InvalidSubTransactionId;
+			remote_stmts_in_xact = 0;
+			break;
+		case XACT_EVENT_ABORT:
+			hash_seq_init(&seq, remote_stmts);
+			while ((stmt = (RemoteStmt *) hash_seq_search(&seq)) != NULL)
+			{
+				if (stmt->subid != InvalidSubTransactionId)
+					ForgetRemoteStmt(stmt, true);
+			}
+			Assert(remote_stmts_in_xact == 0);
+			break;
+		default:
+			break;
+	}
+}
+
+static void
+RemoteStmtSubXactCallback(SubXactEvent event, SubTransactionId mySubid,
+						  SubTransactionId parentSubid, void *arg)
+{
+	HASH_SEQ_STATUS seq;
+	RemoteStmt	   *stmt;
+
+	if (remote_stmts_in_xact == 0)
+		return;
+
+	switch (event)
+	{
+		case SUBXACT_EVENT_COMMIT_SUB:
+			hash_seq_init(&seq, remote_stmts);
+			while ((stmt = (RemoteStmt *) hash_seq_search(&seq)) != NULL)
+			{
+				if (stmt->subid == mySubid)
+					stmt->subid = parentSubid;
+			}
+			break;
+		case SUBXACT_EVENT_ABORT_SUB:
+			hash_seq_init(&seq, remote_stmts);
+			while ((stmt = (RemoteStmt *) hash_seq_search(&seq)) != NULL)
+			{
+				if (stmt->subid != InvalidSubTransactionId &&
+					stmt->subid >= mySubid)
+					ForgetRemoteStmt(stmt, true);
+			}
+			break;
+		default:
+			break;
+	}
+}
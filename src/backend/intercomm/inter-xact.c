@@ -49,11 +49,21 @@ static InterXactStateData TopInterXactStateData = {
 	NULL,						/* array of remote nodes already start transaction */
 	0,							/* count of remote nodes already start transaction */
 	0,							/* max count of remote nodes already malloc */
+	NULL,						/* array of remote nodes which may write */
+	0,							/* count of remote nodes which may write */
+	0,							/* max count of written remote nodes already malloc */
 	NULL,						/* NodeMixHandle for the current query in the inter transaction block */
 	NULL						/* NodeMixHandle for the whole inter transaction block */
 };
 
+/* GUC variable */
+bool AsyncCommitPrepared = false;
+
+/* last GID whose second phase is left to the remote xact manager */
+static char AsyncCommitGID[NAMEDATALEN] = {'\0'};
+
 static void ResetInterXactState(InterXactState state);
+static void InterXactSaveNode(InterXactState state, Oid **nodes, int *count, int *max, Oid node);
 static void InterXactTwoPhase(const char *gid, Oid *nodes, int nnodes, TwoPhaseState tp_state, bool missing_ok);
 static void InterXactTwoPhaseInternal(List *handle_list, char *command, const char *command_tag, bool no_error);
 
@@ -112,6 +122,8 @@ ResetInterXactState(InterXactState state)
 			pfree(state->gid);
 		if (state->trans_nodes)
 			MemSet(state->trans_nodes, 0, sizeof(Oid) * state->trans_max);
+		if (state->write_nodes)
+			MemSet(state->write_nodes, 0, sizeof(Oid) * state->write_max);
 		FreeMixHandle(state->cur_handle);
 		FreeMixHandle(state->all_handle);
 		state->gid = NULL;
@@ -119,6 +131,7 @@ ResetInterXactState(InterXactState state)
 		state->implicit = false;
 		state->need_xact_block = false;
 		state->trans_count = 0;
+		state->write_count = 0;
 		state->cur_handle = NULL;
 		state->all_handle = NULL;
 	}
@@ -138,6 +151,8 @@ FreeInterXactState(InterXactState state)
 			pfree(state->gid);
 		if (state->trans_nodes)
 			pfree(state->trans_nodes);
+		if (state->write_nodes)
+			pfree(state->write_nodes);
 		FreeMixHandle(state->cur_handle);
 		FreeMixHandle(state->all_handle);
 		if (state != &TopInterXactStateData)
@@ -193,6 +208,9 @@ MakeInterXactState(MemoryContext context, const List *node_list)
 	state->trans_nodes = NULL;
 	state->trans_count = 0;
 	state->trans_max = 0;
+	state->write_nodes = NULL;
+	state->write_count = 0;
+	state->write_max = 0;
 	if (node_list)
 	{
 		NodeMixHandle  *cur_handle;
@@ -328,6 +346,8 @@ ExecInterXactUtility(RemoteQuery *node, InterXactState state)
 	/* Make up InterXactStateData */
 	state = MakeInterXactState2(state, node_list);
 	state->need_xact_block = need_xact_block;
+	if (need_xact_block)
+		InterXactSaveWriteNodes(state, node_list);
 	pfree(node_list);
 
 	/* Utility */
@@ -378,34 +398,68 @@ InterXactSetXID(InterXactState state, TransactionId xid)
  */
 void
 InterXactSaveBeginNodes(InterXactState state, Oid node)
+{
+	Assert(state);
+	InterXactSaveNode(state,
+					  &(state->trans_nodes),
+					  &(state->trans_count),
+					  &(state->trans_max),
+					  node);
+}
+
+/*
+ * InterXactSaveWriteNodes
+ *
+ * save nodes which may write in the transaction
+ */
+void
+InterXactSaveWriteNodes(InterXactState state, const List *node_list)
+{
+	const ListCell *lc;
+
+	Assert(state);
+	foreach (lc, node_list)
+		InterXactSaveNode(state,
+						  &(state->write_nodes),
+						  &(state->write_count),
+						  &(state->write_max),
+						  lfirst_oid(lc));
+}
+
+/*
+ * InterXactSaveNode
+ *
+ * append "node" to the array of "state" if it is not there yet
+ */
+static void
+InterXactSaveNode(InterXactState state, Oid **nodes, int *count, int *max, Oid node)
 {
 	MemoryContext	old_context;
 	int				i, new_max;
 
-	Assert(state);
-	for (i = 0; i < state->trans_count; i++)
+	for (i = 0; i < *count; i++)
 	{
 		/* return if already exists */
-		if (state->trans_nodes[i] == node)
+		if ((*nodes)[i] == node)
 			return ;
 	}
 	/* a new node will be saved */
 	old_context = MemoryContextSwitchTo(state->context);
-	if (state->trans_max == 0)
+	if (*max == 0)
 	{
-		Assert(state->trans_count == 0);
+		Assert(*count == 0);
 		new_max = 16;
-		state->trans_nodes = (Oid *) palloc(sizeof(Oid) * new_max);
-		state->trans_max = new_max;
+		*nodes = (Oid *) palloc(sizeof(Oid) * new_max);
+		*max = new_max;
 	} else
-	if (state->trans_count >= state->trans_max)
+	if (*count >= *max)
 	{
-		new_max = state->trans_max + 16;
-		state->trans_nodes = (Oid *) repalloc(state->trans_nodes, sizeof(Oid) * new_max);
-		state->trans_max = new_max;
+		new_max = *max + 16;
+		*nodes = (Oid *) repalloc(*nodes, sizeof(Oid) * new_max);
+		*max = new_max;
 	}
-	state->trans_nodes[state->trans_count++] = node;
-	Assert(state->trans_count <= state->trans_max);
+	(*nodes)[(*count)++] = node;
+	Assert(*count <= *max);
 	(void) MemoryContextSwitchTo(old_context);
 }
 
@@ -454,6 +508,110 @@ InterXactBeginNodes(InterXactState state, bool include_self, int *node_num)
 	return res;
 }
 
+/*
+ * InterXactCanOnePhaseCommit
+ *
+ * return true if at most one remote node of "state" may have written,
+ * all the others only read and have nothing to make durable.
+ */
+bool
+InterXactCanOnePhaseCommit(InterXactState state)
+{
+	if (!IsCoordMaster() || state == NULL)
+		return false;
+
+	return state->write_count <= 1;
+}
+
+/*
+ * InterXactOnePhaseCommit
+ *
+ * Commit all the remote nodes of "state" without two-phase commit.
+ *
+ * The read-only nodes are committed first and the written node last, so
+ * any failure before the last one still leaves the written node able to
+ * roll back with the rest of the transaction. Nodes are forgotten after
+ * that, the later remote commit only has AGTM left to do.
+ */
+void
+InterXactOnePhaseCommit(InterXactState state)
+{
+	Oid		   *nodes;
+	Oid			write_node = InvalidOid;
+	int			count;
+	int			i;
+
+	Assert(InterXactCanOnePhaseCommit(state));
+	if (state->trans_count == 0)
+		return ;
+
+	if (state->write_count == 1)
+		write_node = state->write_nodes[0];
+
+	nodes = (Oid *) palloc(sizeof(Oid) * state->trans_count);
+	count = 0;
+	for (i = 0; i < state->trans_count; i++)
+	{
+		if (state->trans_nodes[i] != write_node)
+			nodes[count++] = state->trans_nodes[i];
+	}
+	if (count < state->trans_count)
+		nodes[count++] = write_node;
+	Assert(count == state->trans_count);
+
+	InterXactCommit(NULL, nodes, count, false);
+	pfree(nodes);
+
+	state->trans_count = 0;
+}
+
+/*
+ * InterXactCommitReadOnly
+ *
+ * Commit the remote nodes of "state" which only read, before the written
+ * nodes are prepared. They have nothing to make durable, so they need not
+ * take part in two-phase commit, and a failure to prepare the written nodes
+ * later still aborts the transaction. Only the written nodes are left in
+ * "state" for the rest of the commit.
+ */
+void
+InterXactCommitReadOnly(InterXactState state)
+{
+	Oid		   *read_nodes;
+	Oid		   *write_nodes;
+	int			read_count = 0;
+	int			write_count = 0;
+	int			i, j;
+
+	if (!IsCoordMaster() || state == NULL || state->trans_count == 0)
+		return ;
+
+	read_nodes = (Oid *) palloc(sizeof(Oid) * state->trans_count);
+	write_nodes = (Oid *) palloc(sizeof(Oid) * state->trans_count);
+	for (i = 0; i < state->trans_count; i++)
+	{
+		for (j = 0; j < state->write_count; j++)
+		{
+			if (state->write_nodes[j] == state->trans_nodes[i])
+				break;
+		}
+		if (j < state->write_count)
+			write_nodes[write_count++] = state->trans_nodes[i];
+		else
+			read_nodes[read_count++] = state->trans_nodes[i];
+	}
+
+	if (read_count > 0)
+	{
+		InterXactCommit(NULL, read_nodes, read_count, false);
+		memcpy(state->trans_nodes, write_nodes, sizeof(Oid) * write_count);
+		state->trans_count = write_count;
+	}
+
+	pfree(read_nodes);
+	pfree(write_nodes);
+}
+
 /*
  * InterXactSerializeSnapshot
  *
@@ -583,7 +741,6 @@ InterXactUtility(InterXactState state, Snapshot snapshot,
 	NodeMixHandle	   *cur_handle;
 	NodeHandle		   *handle;
 	ListCell		   *lc_handle;
-	bool				already_begin;
 	bool				need_xact_block;
 
 	Assert(state);
@@ -602,11 +759,18 @@ InterXactUtility(InterXactState state, Snapshot snapshot,
 			gxid = GetCurrentTransactionIdIfAny();
 		timestamp = GetCurrentTransactionStartTimestamp();
 
+		handle = HandleListBegin(state, cur_handle->handles,
+								 gxid, timestamp, need_xact_block);
+		if (handle)
+			ereport(ERROR,
+					(errmsg("Fail to process utility query on remote node."),
+					 errnode(NameStr(handle->node_name)),
+					 errdetail("%s", HandleGetError(handle))));
+
 		foreach (lc_handle, cur_handle->handles)
 		{
 			handle = (NodeHandle *) lfirst(lc_handle);
-			if (!HandleBegin(state, handle, gxid, timestamp, need_xact_block, &already_begin) ||
-				!HandleSendQueryTree(handle, InvalidCommandId, snapshot, utility, utility_tree) ||
+			if (!HandleSendQueryTree(handle, InvalidCommandId, snapshot, utility, utility_tree) ||
 				!HandleFinishCommand(handle, NULL_TAG))
 			{
 				ereport(ERROR,
@@ -635,8 +799,6 @@ InterXactBegin(InterXactState state, const List *node_list)
 	InterXactState		new_state;
 	NodeMixHandle	   *cur_handle;
 	NodeHandle		   *handle;
-	ListCell		   *lc_handle;
-	bool				already_begin;
 	bool				need_xact_block;
 
 	new_state = MakeInterXactState2(state, node_list);
@@ -655,15 +817,13 @@ InterXactBegin(InterXactState state, const List *node_list)
 			gxid = GetCurrentTransactionIdIfAny();
 		timestamp = GetCurrentTransactionStartTimestamp();
 
-		foreach (lc_handle, cur_handle->handles)
-		{
-			handle = (NodeHandle *) lfirst(lc_handle);
-			if (!HandleBegin(state, handle, gxid, timestamp, need_xact_block, &already_begin))
-				ereport(ERROR,
-						(errmsg("Fail to begin transaction"),
-						 errnode(NameStr(handle->node_name)),
-						 errdetail("%s:", HandleGetError(handle))));
-		}
+		handle = HandleListBegin(state, cur_handle->handles,
+								 gxid, timestamp, need_xact_block);
+		if (handle)
+			ereport(ERROR,
+					(errmsg("Fail to begin transaction"),
+					 errnode(NameStr(handle->node_name)),
+					 errdetail("%s:", HandleGetError(handle))));
 	} PG_CATCH();
 	{
 		InterXactGCCurrent(new_state);
@@ -894,6 +1054,55 @@ EndFinishPreparedRxact(const char *gid,
 		AbortPreparedRxact(gid, nnodes, nodes, isMissingOK);
 }
 
+/*
+ * EndFinishPreparedRxactAsync
+ *
+ * Leave COMMIT PREPARED of an implicit two-phase transaction to the
+ * remote xact manager, it finishes the second phase in background just
+ * like it does for a backend which fails to do it. The decision is
+ * already durable, both in the rxact log and in the local commit.
+ *
+ * return false if the remote xact manager can not take it over, then
+ * the caller should finish it itself.
+ */
+bool
+EndFinishPreparedRxactAsync(const char *gid)
+{
+	if (!IsCoordMaster() || IsConnFromRxactMgr())
+		return false;
+
+	AssertArg(gid && gid[0]);
+
+	if (strlen(gid) >= NAMEDATALEN ||
+		!RecordRemoteXactFailed(gid, RX_COMMIT, true))
+		return false;
+
+	/* make the next transaction of this session wait for it */
+	strcpy(AsyncCommitGID, gid);
+
+	return true;
+}
+
+/*
+ * WaitAsyncCommitPrepared
+ *
+ * Wait until the remote xact manager finish the second phase of the
+ * last transaction committed by EndFinishPreparedRxactAsync, so this
+ * session always read its own writes.
+ */
+void
+WaitAsyncCommitPrepared(void)
+{
+	if (AsyncCommitGID[0] == '\0')
+		return ;
+
+	if (!RxactWaitGID(AsyncCommitGID, true))
+		ereport(WARNING,
+				(errmsg("could not wait for remote transaction \"%s\" to finish",
+						AsyncCommitGID)));
+	AsyncCommitGID[0] = '\0';
+}
+
 static void
 CommitPreparedRxact(const char *gid,
 					int nnodes,
@@ -27,9 +27,24 @@
 static AGTM_Sequence agtm_DealSequence(const char *seqname, const char * database,
 								const char * schema, AGTM_MessageType type, AGTM_ResultType rtype);
 static PGresult* agtm_get_result(AGTM_MessageType msg_type);
+static void agtm_flush_message(PGconn *conn, AGTM_MessageType msg_type);
+static PGresult* agtm_read_result(PGconn *conn, AGTM_MessageType msg_type);
 static void agtm_send_message(AGTM_MessageType msg, const char *fmt, ...)
 			__attribute__((format(PG_PRINTF_ATTRIBUTE, 2, 3)));
 
+/* GUC variable */
+bool AGtmPrefetchSnapshot = true;
+
+/*
+ * Snapshot request sent by agtm_PrefetchGlobalSnapShot() ahead of need.
+ * Only one request can be outstanding on the AGTM connection, so any other
+ * use of the connection reads its reply first (agtm_CompletePrefetch).
+ * The reply may only be used by the statement which asked for it.
+ */
+static bool		 agtm_snap_pending = false;		/* reply not read yet */
+static bool		 agtm_snap_usable = false;		/* current statement may use it */
+static PGresult	*agtm_snap_result = NULL;		/* reply read but not used yet */
+
 TransactionId
 agtm_GetGlobalTransactionId(bool isSubXact)
 {
@@ -323,8 +338,21 @@ agtm_GetGlobalSnapShot(Snapshot snapshot)
 		ereport(ERROR,
 			(errmsg("agtm_GetGlobalSnapShot function must under AGTM")));
 
-	agtm_send_message(AGTM_MSG_SNAPSHOT_GET, " ");
-	res = agtm_get_result(AGTM_MSG_SNAPSHOT_GET);
+	res = NULL;
+	if (agtm_snap_usable)
+	{
+		/* requested ahead by agtm_PrefetchGlobalSnapShot */
+		agtm_CompletePrefetch();
+		res = agtm_snap_result;
+		agtm_snap_result = NULL;
+		agtm_snap_usable = false;
+	}
+
+	if (res == NULL)
+	{
+		agtm_send_message(AGTM_MSG_SNAPSHOT_GET, " ");
+		res = agtm_get_result(AGTM_MSG_SNAPSHOT_GET);
+	}
 	Assert(res);
 	agtm_use_result_type(res, &buf, AGTM_SNAPSHOT_GET_RESULT);
 
@@ -359,6 +387,96 @@ agtm_GetGlobalSnapShot(Snapshot snapshot)
 	return snapshot;
 }
 
+/*
+ * Send a snapshot request to AGTM without waiting for the reply, so the
+ * round trip overlaps with the work the statement does before it needs
+ * a snapshot.  The next agtm_GetGlobalSnapShot() of the statement picks
+ * the reply up.
+ */
+void
+agtm_PrefetchGlobalSnapShot(void)
+{
+	PGconn *conn;
+
+	if (!AGtmPrefetchSnapshot || !IsUnderAGTM() || !IsCoordMaster())
+		return;
+
+	/* already on its way */
+	if (agtm_snap_usable)
+		return;
+
+	/* transaction snapshot was taken, no more snapshot will be needed */
+	if (FirstSnapshotSet && IsolationUsesXactSnapshot())
+		return;
+
+	if (IsAbortedTransactionBlockState())
+		return;
+
+	agtm_send_message(AGTM_MSG_SNAPSHOT_GET, " ");
+	conn = getAgtmConnection();
+	agtm_flush_message(conn, AGTM_MSG_SNAPSHOT_GET);
+
+	agtm_snap_pending = true;
+	agtm_snap_usable = true;
+}
+
+/*
+ * The statement which prefetched a snapshot is done, the snapshot is too
+ * old for any later statement.  A reply not read yet is dropped on the
+ * next use of the AGTM connection, we do not wait for it here.
+ */
+void
+agtm_ReleasePrefetchedSnapShot(void)
+{
+	agtm_snap_usable = false;
+	if (agtm_snap_result)
+	{
+		PQclear(agtm_snap_result);
+		agtm_snap_result = NULL;
+	}
+}
+
+/*
+ * Read the reply of the prefetched snapshot request if there is one
+ * outstanding.  Must be called before anything else is sent on the
+ * AGTM connection.
+ */
+void
+agtm_CompletePrefetch(void)
+{
+	PGconn		*conn;
+	PGresult	*res;
+
+	if (!agtm_snap_pending)
+		return;
+
+	conn = getAgtmConnection();
+	/* connection was reset, the request is gone */
+	if (!agtm_snap_pending)
+		return;
+
+	agtm_snap_pending = false;
+	res = agtm_read_result(conn, AGTM_MSG_SNAPSHOT_GET);
+	if (agtm_snap_usable)
+	{
+		Assert(agtm_snap_result == NULL);
+		agtm_snap_result = res;
+	} else
+	{
+		PQclear(res);
+	}
+}
+
+/*
+ * AGTM connection closed, forget the request sent on it.
+ */
+void
+agtm_ForgetPrefetch(void)
+{
+	agtm_snap_pending = false;
+	agtm_ReleasePrefetchedSnapShot();
+}
+
 XidStatus
 agtm_TransactionIdGetStatus(TransactionId xid, XLogRecPtr *lsn)
 {
@@ -681,6 +799,62 @@ agtm_GetSeqNextVal(const char *seqname, const char * database,	const char * sche
 			, AGTM_SEQUENCE_GET_NEXT_RESULT);
 }
 
+/*
+ * lease a range of at most "count" values of a sequence from AGTM,
+ * returns the first value and saves the last one in "last"
+ */
+AGTM_Sequence
+agtm_GetSeqNextRange(const char *seqname, const char * database,
+			const char * schema, AGTM_Sequence count, AGTM_Sequence *last)
+{
+	PGresult		*res;
+	StringInfoData	buf;
+	AGTM_Sequence	seq;
+
+	int				seqNameSize;
+	int 			databaseSize;
+	int				schemaSize;
+
+	Assert(seqname != NULL && database != NULL && schema != NULL && last != NULL);
+
+	if(!IsUnderAGTM())
+		ereport(ERROR,
+			(errmsg("agtm_GetSeqNextRange function must under AGTM")));
+
+	if(seqname[0] == '\0' || database[0] == '\0' || schema[0] == '\0')
+		ereport(ERROR,
+			(errmsg("message type = %s, parameter seqname is null",
+			"AGTM_MSG_SEQUENCE_GET_RANGE")));
+
+	seqNameSize = strlen(seqname);
+	databaseSize = strlen(database);
+	schemaSize = strlen(schema);
+
+	agtm_send_message(AGTM_MSG_SEQUENCE_GET_RANGE,
+					"%d%d %p%d %d%d %p%d %d%d %p%d %p%d",
+					seqNameSize, 4,
+					seqname, seqNameSize,
+					databaseSize, 4,
+					database, databaseSize,
+					schemaSize, 4,
+					schema, schemaSize,
+					&count, (int)sizeof(count));
+
+	res = agtm_get_result(AGTM_MSG_SEQUENCE_GET_RANGE);
+	Assert(res);
+	agtm_use_result_type(res, &buf, AGTM_SEQUENCE_GET_RANGE_RESULT);
+	pq_copymsgbytes(&buf, (char*)&seq, sizeof(seq));
+	pq_copymsgbytes(&buf, (char*)last, sizeof(*last));
+
+	agtm_use_result_end(res, &buf);
+
+	ereport(DEBUG1,
+		(errmsg("lease sequence %s range " INT64_FORMAT " to " INT64_FORMAT " from agtm",
+			seqname, seq, *last)));
+
+	return seq;
+}
+
 AGTM_Sequence
 agtm_GetSeqCurrVal(const char *seqname, const char * database,	const char * schema)
 {
@@ -790,6 +964,9 @@ static void agtm_send_message(AGTM_MessageType msg, const char *fmt, ...)
 	char c;
 	AssertArg(fmt);
 
+	/* reply of a prefetched request must be read first */
+	agtm_CompletePrefetch();
+
 	/* get connection */
 	conn = getAgtmConnection();
 
@@ -945,11 +1122,17 @@ agtm_PrepareResult(PGconn *conn)
 static PGresult* agtm_get_result(AGTM_MessageType msg_type)
 {
 	PGconn *conn;
-	PGresult *result;
-	ExecStatusType state;
-	int res;
 
 	conn = getAgtmConnection();
+	agtm_flush_message(conn, msg_type);
+
+	return agtm_read_result(conn, msg_type);
+}
+
+static void
+agtm_flush_message(PGconn *conn, AGTM_MessageType msg_type)
+{
+	int res;
 
 	while((res=pqFlush(conn)) > 0)
 		; /* nothing todo */
@@ -960,6 +1143,13 @@ static PGresult* agtm_get_result(AGTM_MessageType msg_type)
 			(errmsg("flush message to AGTM error:%s, message type:%s",
 			PQerrorMessage(conn), gtm_util_message_name(msg_type))));
 	}
+}
+
+static PGresult*
+agtm_read_result(PGconn *conn, AGTM_MessageType msg_type)
+{
+	PGresult *result;
+	ExecStatusType state;
 
 	agtm_PrepareResult(conn);
 
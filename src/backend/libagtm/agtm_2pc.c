@@ -205,6 +205,9 @@ agtm_execute_query(const char *query)
 		resetStringInfo(ErrorBuffer);
 	}
 
+	/* PQexec can not deal with the reply of a prefetched request */
+	agtm_CompletePrefetch();
+
 	agtm_conn = getAgtmConnection();
 	if (agtm_conn == NULL)
 	{
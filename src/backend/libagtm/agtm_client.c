@@ -182,6 +182,8 @@ agtm_SetDefaultPort(void)
 
 void agtm_Close(void)
 {
+	agtm_ForgetPrefetch();
+
 	if (agtm_conn)
 	{
 		if(agtm_conn->pg_res)
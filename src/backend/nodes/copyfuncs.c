@@ -4671,6 +4671,8 @@ _copyExecNodes(const ExecNodes *from)
 	COPY_NODE_FIELD(en_expr);
 	COPY_NODE_FIELD(en_dist_vars);
 	COPY_NODE_FIELD(nodeids);
+	COPY_SCALAR_FIELD(en_expr_is_array);
+	COPY_SCALAR_FIELD(en_array_paramid);
 
 	return newnode;
 }
@@ -589,6 +589,8 @@ _outExecNodes(StringInfo str, const ExecNodes *node)
 	WRITE_NODE_FIELD(en_expr);
 	WRITE_NODE_FIELD(en_dist_vars);
 	WRITE_NODE_FIELD(nodeids);
+	WRITE_BOOL_FIELD(en_expr_is_array);
+	WRITE_INT_FIELD(en_array_paramid);
 }
 
 static void
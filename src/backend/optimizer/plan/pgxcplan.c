@@ -2147,6 +2147,8 @@ pgxc_set_en_expr(Oid tableoid, Index resultRelationIndex)
 	 * XXX Need further testing for replicated and round-robin tables
 	 */
 	if (rel_loc_info->locatorType == LOCATOR_TYPE_HASH ||
+		rel_loc_info->locatorType == LOCATOR_TYPE_HASHMAP ||
+		rel_loc_info->locatorType == LOCATOR_TYPE_RANGE ||
 		rel_loc_info->locatorType == LOCATOR_TYPE_MODULO)
 	{
 		tp = SearchSysCache(ATTNUM,
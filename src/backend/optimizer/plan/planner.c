@@ -6800,6 +6800,8 @@ static Path* reduce_to_relation_insert(PlannerInfo *root, Index rel_id, Path *pa
 		reduce_info = MakeRoundReduceInfo(storage_nodes);
 		path = create_cluster_reduce_path(root, path, list_make1(reduce_info), path->parent, NIL);
 	}else if(loc_info->locatorType == LOCATOR_TYPE_HASH ||
+			 loc_info->locatorType == LOCATOR_TYPE_HASHMAP ||
+			 loc_info->locatorType == LOCATOR_TYPE_RANGE ||
 			 loc_info->locatorType == LOCATOR_TYPE_MODULO ||
 			 loc_info->locatorType == LOCATOR_TYPE_USER_DEFINED)
 	{
@@ -6815,6 +6817,18 @@ static Path* reduce_to_relation_insert(PlannerInfo *root, Index rel_id, Path *pa
 			reduce_info = MakeHashReduceInfo(storage_nodes,
 											 NIL,
 											 expr);
+		}else if(loc_info->locatorType == LOCATOR_TYPE_HASHMAP)
+		{
+			expr = list_nth(path->pathtarget->exprs, loc_info->partAttrNum - 1);
+			reduce_info = MakeHashmapReduceInfo(loc_info,
+												NIL,
+												expr);
+		}else if(loc_info->locatorType == LOCATOR_TYPE_RANGE)
+		{
+			expr = list_nth(path->pathtarget->exprs, loc_info->partAttrNum - 1);
+			reduce_info = MakeRangeReduceInfo(loc_info,
+											  NIL,
+											  expr);
 		}else if(loc_info->locatorType == LOCATOR_TYPE_MODULO)
 		{
 			expr = list_nth(path->pathtarget->exprs, loc_info->partAttrNum - 1);
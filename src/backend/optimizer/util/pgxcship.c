@@ -74,6 +74,15 @@ typedef struct
 	bool		sc_groupby_has_distcol;	/* GROUP BY clause has distribution column */
 } Shippability_context;
 
+#ifdef ADB
+/* Context of pgxc_count_param_refs_walker */
+typedef struct
+{
+	int			paramid;			/* external parameter to look for */
+	int			count;				/* references found */
+} ParamRefsContext;
+#endif
+
 /*
  * ShippabilityStat
  * List of reasons why a query/expression is not shippable to remote nodes.
@@ -122,6 +131,11 @@ static ExecNodes *pgxc_FQS_get_relation_nodes(RangeTblEntry *rte,
 											  Index varno,
 											  Query *query);
 static ExecNodes *pgxc_FQS_find_datanodes(Shippability_context *sc_context);
+#ifdef ADB
+static void pgxc_FQS_set_param_datanodes(Query *query, ExecNodes *exec_nodes);
+static int pgxc_count_param_refs(Query *query, int paramid);
+static bool pgxc_count_param_refs_walker(Node *node, ParamRefsContext *context);
+#endif
 static bool pgxc_query_needs_coord(Query *query);
 static bool pgxc_query_contains_only_pg_catalog(List *rtable);
 static bool pgxc_is_var_distrib_column(Var *var, List *rtable);
@@ -433,6 +447,10 @@ pgxc_FQS_find_datanodes(Shippability_context *sc_context)
 			exec_nodes->nodeids = GetPreferredRepNodeIds(tmp_list);
 			list_free(tmp_list);
 		}
+#ifdef ADB
+		else if (sc_context->sc_query_level == 0)
+			pgxc_FQS_set_param_datanodes(query, exec_nodes);
+#endif /* ADB */
 		return exec_nodes;
 	}
 	/*
@@ -446,6 +464,123 @@ pgxc_FQS_find_datanodes(Shippability_context *sc_context)
 }
 
 
+#ifdef ADB
+/*
+ * pgxc_FQS_set_param_datanodes
+ * A statement on single relation distributed by value whose distribution
+ * column equals to a parameter, like "WHERE id = $1" of a prepared statement,
+ * is shipped to all the Datanodes because the value is not known when
+ * planning. Set the parameter expression in ExecNodes, then the executor
+ * finds out the only Datanode by the bound value, and a generic plan is as
+ * good as a custom plan for it.
+ */
+static void
+pgxc_FQS_set_param_datanodes(Query *query, ExecNodes *exec_nodes)
+{
+	RangeTblEntry	*rte;
+	RelationLocInfo	*rel_loc_info;
+	Expr			*distcol_expr;
+
+	if (query->commandType != CMD_SELECT &&
+		query->commandType != CMD_UPDATE &&
+		query->commandType != CMD_DELETE)
+		return;
+	if (query->hasSubLinks ||
+		list_length(query->rtable) != 1 ||
+		query->jointree->quals == NULL ||
+		exec_nodes->en_expr != NIL ||
+		OidIsValid(exec_nodes->en_relid) ||
+		list_length(exec_nodes->nodeids) <= 1 ||
+		!IsExecNodesDistributedByValue(exec_nodes))
+		return;
+
+	rte = rt_fetch(1, query->rtable);
+	if (rte->rtekind != RTE_RELATION)
+		return;
+	rel_loc_info = GetRelationLocInfo(rte->relid);
+	if (rel_loc_info == NULL)
+		return;
+
+	distcol_expr = GetRelationDistribExprByQuals(rel_loc_info, 1,
+												 query->jointree->quals);
+	if (distcol_expr)
+	{
+		exec_nodes->en_expr = list_make1(distcol_expr);
+		exec_nodes->en_relid = rel_loc_info->relid;
+	}
+	else if ((distcol_expr = GetRelationDistribArrayByQuals(rel_loc_info, 1,
+														query->jointree->quals)) != NULL)
+	{
+		/*
+		 * "WHERE id = ANY($1)" runs on the nodes of all the elements. When
+		 * $1 is used nowhere else, rows of other nodes can not match, so each
+		 * node is sent only its own elements.
+		 */
+		Expr   *param = distcol_expr;
+
+		/* a binary-coercible array is relabeled, or coerced without a function */
+		for (;;)
+		{
+			if (IsA(param, RelabelType))
+				param = ((RelabelType *) param)->arg;
+			else if (IsA(param, ArrayCoerceExpr) &&
+					 !OidIsValid(((ArrayCoerceExpr *) param)->elemfuncid))
+				param = ((ArrayCoerceExpr *) param)->arg;
+			else
+				break;
+		}
+
+		exec_nodes->en_expr = list_make1(distcol_expr);
+		exec_nodes->en_relid = rel_loc_info->relid;
+		exec_nodes->en_expr_is_array = true;
+		if (IsA(param, Param) &&
+			((Param *) param)->paramkind == PARAM_EXTERN &&
+			pgxc_count_param_refs(query, ((Param *) param)->paramid) == 1)
+			exec_nodes->en_array_paramid = ((Param *) param)->paramid;
+	}
+	FreeRelationLocInfo(rel_loc_info);
+}
+
+/*
+ * pgxc_count_param_refs
+ * Count the references to external parameter paramid in the query.
+ */
+static int
+pgxc_count_param_refs(Query *query, int paramid)
+{
+	ParamRefsContext	context;
+
+	context.paramid = paramid;
+	context.count = 0;
+	(void) query_tree_walker(query, pgxc_count_param_refs_walker,
+							 (void *) &context, 0);
+
+	return context.count;
+}
+
+static bool
+pgxc_count_param_refs_walker(Node *node, ParamRefsContext *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Param))
+	{
+		if (((Param *) node)->paramkind == PARAM_EXTERN &&
+			((Param *) node)->paramid == context->paramid)
+			context->count++;
+		return false;
+	}
+
+	if (IsA(node, Query))
+		return query_tree_walker((Query *) node, pgxc_count_param_refs_walker,
+								 (void *) context, 0);
+
+	return expression_tree_walker(node, pgxc_count_param_refs_walker,
+								  (void *) context);
+}
+#endif /* ADB */
+
 /*
  * pgxc_FQS_get_relation_nodes
  * Return ExecNodes structure so as to decide which node the query should
@@ -2054,6 +2189,8 @@ pgxc_check_index_shippability(RelationLocInfo *relLocInfo,
 				break;
 
 			case LOCATOR_TYPE_HASH:
+			case LOCATOR_TYPE_HASHMAP:
+			case LOCATOR_TYPE_RANGE:
 			case LOCATOR_TYPE_MODULO:
 				/*
 				 * Unique indexes on Hash and Modulo tables are shippable if the
@@ -2146,7 +2283,6 @@ pgxc_check_index_shippability(RelationLocInfo *relLocInfo,
 				break;
 #endif
 			/* Those types are not supported yet */
-			case LOCATOR_TYPE_RANGE:
 			case LOCATOR_TYPE_NONE:
 			case LOCATOR_TYPE_DISTRIBUTED:
 			case LOCATOR_TYPE_CUSTOM:
@@ -2212,6 +2348,8 @@ pgxc_check_fk_shippability(RelationLocInfo *parentLocInfo,
 		case LOCATOR_TYPE_USER_DEFINED:
 #endif
 		case LOCATOR_TYPE_HASH:
+		case LOCATOR_TYPE_HASHMAP:
+		case LOCATOR_TYPE_RANGE:
 		case LOCATOR_TYPE_MODULO:
 			/*
 			 * If parent table is distributed, the child table can reference
@@ -2252,6 +2390,22 @@ pgxc_check_fk_shippability(RelationLocInfo *parentLocInfo,
 				break;
 			}
 #ifdef ADB
+			/* Hashmap tables need to send each bucket to the same node */
+			if (parentLocInfo->locatorType == LOCATOR_TYPE_HASHMAP &&
+				!IsLocatorBucketMapEqual(parentLocInfo, childLocInfo))
+			{
+				result = false;
+				break;
+			}
+
+			/* Range tables need the same bounds on the same nodes */
+			if (parentLocInfo->locatorType == LOCATOR_TYPE_RANGE &&
+				!IsLocatorRangeBoundsEqual(parentLocInfo, childLocInfo))
+			{
+				result = false;
+				break;
+			}
+
 			if (IsRelationDistributedByUserDefined(parentLocInfo))
 			{
 				List *childRefsDiff = NIL;
@@ -2321,7 +2475,6 @@ pgxc_check_fk_shippability(RelationLocInfo *parentLocInfo,
 			/* By being here, parent-child constraint can be shipped correctly */
 			break;
 
-		case LOCATOR_TYPE_RANGE:
 		case LOCATOR_TYPE_NONE:
 		case LOCATOR_TYPE_DISTRIBUTED:
 		case LOCATOR_TYPE_CUSTOM:
@@ -2540,6 +2693,11 @@ pgxc_is_join_shippable(ExecNodes *inner_en, ExecNodes *outer_en,
 		 * merged.
 		 */
 		if (inner_en->baselocatortype == outer_en->baselocatortype &&
+#ifdef ADB
+			/* bucket maps and bounds are not known here, leave them to reduce info */
+			inner_en->baselocatortype != LOCATOR_TYPE_HASHMAP &&
+			inner_en->baselocatortype != LOCATOR_TYPE_RANGE &&
+#endif
 			IsExecNodesDistributedByValue(inner_en))
 		{
 			Expr *equi_join_expr = pgxc_find_dist_equijoin_qual(inner_en->en_dist_vars,
@@ -35,6 +35,7 @@
 static Param *makeReduceParam(Oid type, int paramid, int parammod, Oid collid);
 static oidvector *makeOidVector(List *list);
 static Expr* makeReduceArrayRef(List *oid_list, Expr *modulo, bool try_const);
+static Expr* makeReduceVectorRef(Const *vector, Expr *modulo, bool try_const);
 static Node* ReduceParam2ExprMutator(Node *node, List *params);
 static int CompareOid(const void *a, const void *b);
 
@@ -66,6 +67,55 @@ ReduceInfo *MakeHashReduceInfo(const List *storage, const List *exclude, const E
 	return rinfo;
 }
 
+/*
+ * Hash reduce of a hashmap table, the node of each bucket is kept in
+ * a Const oid vector, which makes tables with the same bucket map equal
+ */
+ReduceInfo *MakeHashmapReduceInfo(const RelationLocInfo *loc_info, const List *exclude, const Expr *param)
+{
+	ReduceInfo *rinfo;
+	List *bucket_nodes = NIL;
+	int i;
+	AssertArg(loc_info && loc_info->locatorType == LOCATOR_TYPE_HASHMAP);
+
+	rinfo = MakeHashReduceInfo(loc_info->nodeids, exclude, param);
+	for(i=0;i<loc_info->numBuckets;++i)
+		bucket_nodes = lappend_oid(bucket_nodes,
+								   list_nth_oid(loc_info->nodeids, loc_info->bucketMap[i]));
+	rinfo->expr = (Expr*)makeConst(OIDARRAYOID,
+								   -1,
+								   InvalidOid,
+								   -1,
+								   PointerGetDatum(makeOidVector(bucket_nodes)),
+								   false,
+								   false);
+	rinfo->type = REDUCE_TYPE_HASHMAP;
+	list_free(bucket_nodes);
+
+	return rinfo;
+}
+
+/*
+ * Reduce of a range table, the upper bounds of nodes are kept in a Const
+ * array, which makes tables with the same bounds equal
+ */
+ReduceInfo *MakeRangeReduceInfo(const RelationLocInfo *loc_info, const List *exclude, const Expr *param)
+{
+	ReduceInfo *rinfo;
+	AssertArg(loc_info && loc_info->locatorType == LOCATOR_TYPE_RANGE && param);
+	AssertArg(exclude == NIL || IsA(exclude, OidList));
+
+	rinfo = MakeEmptyReduceInfo();
+	rinfo->storage_nodes = list_copy(loc_info->nodeids);
+	rinfo->exclude_exec = list_copy(exclude);
+	rinfo->params = list_make1(copyObject(param));
+	rinfo->expr = (Expr*)MakeRangeBoundsConst(loc_info);
+	rinfo->relids = pull_varnos((Node*)param);
+	rinfo->type = REDUCE_TYPE_RANGE;
+
+	return rinfo;
+}
+
 ReduceInfo *MakeCustomReduceInfoByRel(const List *storage, const List *exclude,
 						const List *attnums, Oid funcid, Oid reloid, Index rel_index)
 {
@@ -222,6 +272,14 @@ ReduceInfo *MakeReduceInfoFromLocInfo(const RelationLocInfo *loc_info, const Lis
 		{
 			Var *var = makeVarByRel(loc_info->partAttrNum, reloid, relid);
 			rinfo = MakeHashReduceInfo(rnodes, exclude, (Expr*)var);
+		}else if(loc_info->locatorType == LOCATOR_TYPE_HASHMAP)
+		{
+			Var *var = makeVarByRel(loc_info->partAttrNum, reloid, relid);
+			rinfo = MakeHashmapReduceInfo(loc_info, exclude, (Expr*)var);
+		}else if(loc_info->locatorType == LOCATOR_TYPE_RANGE)
+		{
+			Var *var = makeVarByRel(loc_info->partAttrNum, reloid, relid);
+			rinfo = MakeRangeReduceInfo(loc_info, exclude, (Expr*)var);
 		}else if(loc_info->locatorType == LOCATOR_TYPE_USER_DEFINED)
 		{
 			rinfo = MakeCustomReduceInfoByRel(rnodes,
@@ -1583,6 +1641,11 @@ List *FindJoinEqualExprs(ReduceInfo *rinfo, List *restrictlist, RelOptInfo *inne
 				right_expr = tmp;
 			}
 		}
+		/* range compares values of the same type only */
+		if(nth >= 0 &&
+		   rinfo->type == REDUCE_TYPE_RANGE &&
+		   getBaseType(exprType((Node*)right_expr)) != getBaseType(exprType((Node*)left_expr)))
+			continue;
 		if(nth >= 0)
 		{
 			result = lappend(result, right_expr);
@@ -1882,6 +1945,53 @@ Expr *CreateExprUsingReduceInfo(ReduceInfo *reduce)
 									  COERCE_EXPLICIT_CALL);
 		result = makeReduceArrayRef(reduce->storage_nodes, result, bms_is_empty(reduce->relids));
 		break;
+	case REDUCE_TYPE_HASHMAP:
+		{
+			oidvector *buckets;
+			Assert(list_length(reduce->params) == 1 && IsA(reduce->expr, Const));
+			buckets = (oidvector*)DatumGetPointer(((Const*)reduce->expr)->constvalue);
+			result = makeHashExpr(linitial(reduce->params));
+			result = makeModuloExpr(result, buckets->dim1);
+			Assert(exprType((Node*)result) == INT4OID);
+			result = (Expr*) makeFuncExpr(F_INT4ABS,
+										  INT4OID,
+										  list_make1(result),
+										  InvalidOid, InvalidOid,
+										  COERCE_EXPLICIT_CALL);
+			result = makeReduceVectorRef(copyObject(reduce->expr), result, bms_is_empty(reduce->relids));
+		}
+		break;
+	case REDUCE_TYPE_RANGE:
+		{
+			/* width_bucket(param, bounds) is the index of node */
+			Const *bounds;
+			Oid elemtype;
+			Assert(list_length(reduce->params) == 1 && IsA(reduce->expr, Const));
+			bounds = (Const*)reduce->expr;
+			elemtype = get_element_type(bounds->consttype);
+			result = linitial(reduce->params);
+			result = (Expr*)coerce_to_target_type(NULL,
+												  (Node*)result,
+												  exprType((Node*)result),
+												  elemtype,
+												  -1,
+												  COERCION_IMPLICIT,
+												  COERCE_IMPLICIT_CAST,
+												  -1);
+			if (result == NULL)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATATYPE_MISMATCH),
+						 errmsg("can not reduce type %s by range of type %s",
+								format_type_be(exprType(linitial(reduce->params))),
+								format_type_be(elemtype))));
+			result = (Expr*) makeFuncExpr(F_WIDTH_BUCKET_ARRAY,
+										  INT4OID,
+										  list_make2(result, copyObject(bounds)),
+										  InvalidOid, bounds->constcollid,
+										  COERCE_EXPLICIT_CALL);
+			result = makeReduceArrayRef(reduce->storage_nodes, result, bms_is_empty(reduce->relids));
+		}
+		break;
 	case REDUCE_TYPE_CUSTOM:
 		Assert(list_length(reduce->params) > 0 && reduce->expr != NULL);
 		result = (Expr*)ReduceParam2ExprMutator((Node*)reduce->expr, reduce->params);
@@ -2071,9 +2181,25 @@ static oidvector *makeOidVector(List *list)
  * oid_list[modulo] expr
  */
 static Expr* makeReduceArrayRef(List *oid_list, Expr *modulo, bool try_const)
+{
+	Const *vector = makeConst(OIDARRAYOID,
+							  -1,
+							  InvalidOid,
+							  -1,
+							  PointerGetDatum(makeOidVector(oid_list)),
+							  false,
+							  false);
+	return makeReduceVectorRef(vector, modulo, try_const);
+}
+
+/*
+ * vector[modulo] expr, vector is a Const oidvector
+ */
+static Expr* makeReduceVectorRef(Const *vector, Expr *modulo, bool try_const)
 {
 	ArrayRef *aref;
 	CoalesceExpr *coalesce;
+	oidvector *oids = (oidvector*)DatumGetPointer(vector->constvalue);
 	if(try_const)
 	{
 		Node *node = eval_const_expressions(NULL, (Node*)modulo);
@@ -2084,14 +2210,14 @@ static Expr* makeReduceArrayRef(List *oid_list, Expr *modulo, bool try_const)
 			if (c->constisnull)
 			{
 				/* when is null reduce to first node */
-				node_oid = linitial_oid(oid_list);
+				node_oid = oids->values[0];
 			}else
 			{
 				int32 n;
 				Assert(c->consttype == INT4OID);
 				n = DatumGetInt32(c->constvalue);
-				Assert(n>=0 && n<list_length(oid_list));
-				node_oid = list_nth_oid(oid_list, n);
+				Assert(n>=0 && n<oids->dim1);
+				node_oid = oids->values[n];
 				Assert(OidIsValid(node_oid));
 			}
 			return (Expr*)makeConst(OIDOID,
@@ -2127,13 +2253,7 @@ static Expr* makeReduceArrayRef(List *oid_list, Expr *modulo, bool try_const)
 	aref->refcollid = InvalidOid;
 	aref->refupperindexpr = list_make1(coalesce);
 	aref->reflowerindexpr = NIL;
-	aref->refexpr = (Expr*)makeConst(OIDARRAYOID,
-									 -1,
-									 InvalidOid,
-									 -1,
-									 PointerGetDatum(makeOidVector(oid_list)),
-									 false,
-									 false);
+	aref->refexpr = (Expr*)vector;
 	aref->refassgnexpr = NULL;
 
 	return (Expr*)aref;
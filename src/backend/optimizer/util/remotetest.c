@@ -14,6 +14,7 @@
  */
 #include "postgres.h"
 
+#include "access/stratnum.h"
 #include "access/sysattr.h"
 #include "catalog/pg_aux_class.h"
 #include "catalog/pg_operator.h"
@@ -35,6 +36,7 @@
 #include "parser/parse_oper.h"
 #include "pgxc/locator.h"
 #include "utils/array.h"
+#include "utils/builtins.h"
 #include "utils/datum.h"
 #include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
@@ -42,6 +44,7 @@
 #include "utils/rel.h"
 #include "utils/ruleutils.h"
 #include "utils/snapmgr.h"
+#include "utils/typcache.h"
 
 typedef struct ModifyContext
 {
@@ -89,6 +92,9 @@ static Expr* makeInt4ArrayIn(Expr *l, Datum *values, int count);
 static Expr* makeInt4Const(int32 val);
 static Expr* makeNotNullTest(Expr *expr, bool isrow);
 static Expr* makePartitionExpr(RelationLocInfo *loc_info, Node *node);
+static List* makeRangeConstraints(RelationLocInfo *loc_info, Index varno, int nth);
+static Expr* makeRangeBoundOp(Oid opfamily, int16 strategy, Expr *var,
+							  RelationLocInfo *loc_info, int nth_bound);
 static List* make_new_qual_list(ModifyContext *context, Node *quals, bool need_eval_const);
 static Node* mutator_equal_expr(Node *node, ModifyContext *context);
 static void init_context_expr_if_need(ModifyContext *context);
@@ -273,6 +279,10 @@ List *relation_remote_by_constraints_base(PlannerInfo *root, Node *quals, Relati
 			temp_constraints = lappend(temp_constraints, expr);
 		}
 
+		if (loc_info->locatorType == LOCATOR_TYPE_RANGE)
+			temp_constraints = list_concat(temp_constraints,
+										   makeRangeConstraints(loc_info, varno, i));
+
 		if (predicate_refuted_by(temp_constraints, new_clauses) == false)
 		{
 			MemoryContextSwitchTo(old_mctx);
@@ -363,6 +373,51 @@ static Expr* makePartitionExpr(RelationLocInfo *loc_info, Node *node)
 	case LOCATOR_TYPE_MODULO:
 		expr = (Expr*)node;
 		break;
+	case LOCATOR_TYPE_HASHMAP:
+		{
+			/* bucket_map[coalesce(abs(hash(node) % buckets), 0)] */
+			ArrayRef *aref;
+
+			expr = makeHashExpr((Expr*)node);
+			expr = makeModuloExpr(expr, loc_info->numBuckets);
+			expr = (Expr*)makeFuncExpr(F_INT4ABS,
+										INT4OID,
+										list_make1(expr),
+										InvalidOid,
+										InvalidOid,
+										COERCE_EXPLICIT_CALL);
+			coalesce = makeNode(CoalesceExpr);
+			coalesce->coalescetype = INT4OID;
+			coalesce->coalescecollid = InvalidOid;
+			coalesce->args = list_make2(expr, makeInt4Const(0)); /* when null, first bucket */
+
+			aref = makeNode(ArrayRef);
+			aref->refarraytype = INT2ARRAYOID;
+			aref->refelemtype = INT2OID;
+			aref->reftypmod = -1;
+			aref->refcollid = InvalidOid;
+			aref->refupperindexpr = list_make1(coalesce);
+			aref->reflowerindexpr = NIL;
+			aref->refexpr = (Expr*)makeConst(INT2ARRAYOID,
+											 -1,
+											 InvalidOid,
+											 -1,
+											 PointerGetDatum(buildint2vector(loc_info->bucketMap,
+																			 loc_info->numBuckets)),
+											 false,
+											 false);
+			aref->refassgnexpr = NULL;
+
+			/* the bucket map gives the index of node directly */
+			return (Expr*)coerce_to_target_type(NULL,
+												(Node*)aref,
+												INT2OID,
+												INT4OID,
+												-1,
+												COERCION_EXPLICIT,
+												COERCE_IMPLICIT_CAST,
+												-1);
+		}
 	case LOCATOR_TYPE_USER_DEFINED:
 		if(list_length(loc_info->funcAttrNums) != 1)
 		{
@@ -428,6 +483,93 @@ static Expr* makePartitionExpr(RelationLocInfo *loc_info, Node *node)
 	return (Expr*)coalesce;
 }
 
+/*
+ * make constraints of range partition key for the nth remote node,
+ * it holds values from bound nth-1 (included) to bound nth (excluded),
+ * and first node holds NULL too
+ */
+static List* makeRangeConstraints(RelationLocInfo *loc_info, Index varno, int nth)
+{
+	TypeCacheEntry *typentry;
+	Expr	   *var;
+	Expr	   *expr;
+	List	   *result = NIL;
+
+	AssertArg(loc_info->locatorType == LOCATOR_TYPE_RANGE);
+	typentry = lookup_type_cache(loc_info->rangeType, TYPECACHE_BTREE_OPFAMILY);
+	if (!OidIsValid(typentry->btree_opf))
+		return NIL;
+
+	var = (Expr*)makeVarByRel(loc_info->partAttrNum, loc_info->relid, varno);
+	if (exprType((Node*)var) != loc_info->rangeType)
+	{
+		/* column is a domain, compare same as parser did */
+		var = (Expr*)makeRelabelType(var,
+									 loc_info->rangeType,
+									 -1,
+									 loc_info->rangeCollid,
+									 COERCE_IMPLICIT_CAST);
+	}
+
+	if (nth > 0)
+	{
+		expr = makeRangeBoundOp(typentry->btree_opf, BTGreaterEqualStrategyNumber,
+								var, loc_info, nth-1);
+		result = lappend(result, expr);
+	}
+
+	if (nth < loc_info->numRangeBounds)
+	{
+		expr = makeRangeBoundOp(typentry->btree_opf, BTLessStrategyNumber,
+								var, loc_info, nth);
+		if (nth == 0)
+		{
+			NullTest *null_test = makeNode(NullTest);
+			null_test->arg = var;
+			null_test->nulltesttype = IS_NULL;
+			null_test->argisrow = false;
+			null_test->location = -1;
+			expr = make_orclause(list_make2(expr, null_test));
+		}
+		result = lappend(result, expr);
+	}
+
+	return result;
+}
+
+static Expr* makeRangeBoundOp(Oid opfamily, int16 strategy, Expr *var,
+							  RelationLocInfo *loc_info, int nth_bound)
+{
+	Const	   *bound;
+	OpExpr	   *op;
+	Oid			opno;
+	int16		typlen;
+	bool		typbyval;
+
+	opno = get_opfamily_member(opfamily,
+							   loc_info->rangeType,
+							   loc_info->rangeType,
+							   strategy);
+	if (!OidIsValid(opno))
+		elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+			 strategy, loc_info->rangeType, loc_info->rangeType, opfamily);
+
+	get_typlenbyval(loc_info->rangeType, &typlen, &typbyval);
+	bound = makeConst(loc_info->rangeType,
+					  -1,
+					  loc_info->rangeCollid,
+					  typlen,
+					  loc_info->rangeBounds[nth_bound],
+					  false,
+					  typbyval);
+
+	op = (OpExpr*)make_opclause(opno, BOOLOID, false, var, (Expr*)bound,
+								InvalidOid, loc_info->rangeCollid);
+	set_opfuncid(op);
+
+	return (Expr*)op;
+}
+
 static List* make_new_qual_list(ModifyContext *context, Node *quals, bool need_eval_const)
 {
 	List *result;
@@ -567,6 +709,7 @@ static Node* mutator_equal_expr(Node *node, ModifyContext *context)
 				Datum	   *new_values;
 				bool	   *nulls;
 				int			num_elems;
+				int			num_nodes;
 				int			i;
 				int16		elmlen;
 				bool		elmbyval;
@@ -586,8 +729,11 @@ static Node* mutator_equal_expr(Node *node, ModifyContext *context)
 				new_values = palloc(sizeof(Datum)*num_elems);
 				if (convert)
 					convert_state = ExecInitExpr(convert, NULL);
+				num_nodes = 0;
 				for (i=0;i<num_elems;++i)
 				{
+					int j;
+					Datum node_index;
 					MemoryContextReset(context->expr_context->ecxt_per_tuple_memory);
 					if (convert_state)
 					{
@@ -603,14 +749,26 @@ static Node* mutator_equal_expr(Node *node, ModifyContext *context)
 						context->const_expr->constvalue = values[i];
 						context->const_expr->constisnull = nulls[i];
 					}
-					new_values[i] = ExecEvalExprSwitchContext(context->right_state,
-															  context->expr_context,
-															  &elmbyval,	/* Interim use */
-															  NULL);
+					node_index = ExecEvalExprSwitchContext(context->right_state,
+														   context->expr_context,
+														   &elmbyval,	/* Interim use */
+														   NULL);
 					/* right_expr not return NULL value, even input is NULL */
 					Assert(elmbyval == false);
+
+					/*
+					 * keep each node once, a long list of values gives no more
+					 * than the nodes, and predicate test expands short arrays only
+					 */
+					for (j=0;j<num_nodes;++j)
+					{
+						if (DatumGetInt32(new_values[j]) == DatumGetInt32(node_index))
+							break;
+					}
+					if (j == num_nodes)
+						new_values[num_nodes++] = node_index;
 				}
-				node = (Node*)makeInt4ArrayIn(context->partition_expr, new_values, num_elems);
+				node = (Node*)makeInt4ArrayIn(context->partition_expr, new_values, num_nodes);
 				context->hint = true;
 				pfree(new_values);
 				if (convert_state)
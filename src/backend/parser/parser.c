@@ -1664,7 +1664,7 @@ void transformDistributeBy(DistributeBy *dbstmt)
 
 	/*
 	 * try to judge distribution type
-	 * HASH or MODULE or USER-DEFINED.
+	 * HASH or HASHMAP or MODULE or RANGE or USER-DEFINED.
 	 */
 	if (list_length(funcname) == 1)
 	{
@@ -1682,6 +1682,18 @@ void transformDistributeBy(DistributeBy *dbstmt)
 
 			dbstmt->disttype = DISTTYPE_HASH;
 			dbstmt->colname = strVal(linitial(((ColumnRef *)argnode)->fields));
+		} else if (strcasecmp(fname, "HASHMAP") == 0)
+		{
+			if (list_length(funcargs) != 1 ||
+				IsA(argnode, ColumnRef) == false ||
+				list_length(((ColumnRef *)argnode)->fields) != 1)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("Invalid distribution column specified for \"HASHMAP\""),
+						 errhint("Valid syntax input: HASHMAP(column)")));
+
+			dbstmt->disttype = DISTTYPE_HASHMAP;
+			dbstmt->colname = strVal(linitial(((ColumnRef *)argnode)->fields));
 		} else if (strcasecmp(fname, "MODULO") == 0)
 		{
 			if (list_length(funcargs) != 1 ||
@@ -1694,6 +1706,18 @@ void transformDistributeBy(DistributeBy *dbstmt)
 
 			dbstmt->disttype = DISTTYPE_MODULO;
 			dbstmt->colname = strVal(linitial(((ColumnRef *)argnode)->fields));
+		} else if (strcasecmp(fname, "RANGE") == 0)
+		{
+			/* column first, then the upper bound of each node but the last */
+			if (IsA(argnode, ColumnRef) == false ||
+				list_length(((ColumnRef *)argnode)->fields) != 1)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("Invalid distribution column specified for \"RANGE\""),
+						 errhint("Valid syntax input: RANGE(column [, bound ...])")));
+
+			dbstmt->disttype = DISTTYPE_RANGE;
+			dbstmt->colname = strVal(linitial(((ColumnRef *)argnode)->fields));
 		} else
 		{
 			/*
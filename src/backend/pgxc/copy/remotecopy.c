@@ -221,6 +221,14 @@ RemoteCopyBuildStatement(RemoteCopyState *state,
 
 	if (state->is_from)
 		appendStringInfoString(&state->query_buf, " FROM STDIN");
+#ifdef ADB
+	else if (options->rco_filename)
+	{
+		/* Node writes the file itself */
+		appendStringInfoString(&state->query_buf, " TO ");
+		RemoteCopyQuoteStr(&state->query_buf, options->rco_filename);
+	}
+#endif
 	else
 		appendStringInfoString(&state->query_buf, " TO STDOUT");
 
@@ -253,6 +261,12 @@ RemoteCopyBuildStatement(RemoteCopyState *state,
 	if (options->rco_csv_mode)
 		appendStringInfoString(&state->query_buf, " CSV");
 
+#ifdef ADB
+	/* A file written by the node itself needs its own header */
+	if (options->rco_header)
+		appendStringInfoString(&state->query_buf, " HEADER");
+#endif
+
 	/*
 	 * It is not necessary to send the HEADER part to Datanodes.
 	 * Sending data is sufficient.
@@ -269,6 +283,11 @@ RemoteCopyBuildStatement(RemoteCopyState *state,
 		RemoteCopyQuoteStr(&state->query_buf, options->rco_escape);
 	}
 
+#ifdef ADB
+	if (options->rco_force_quote_all)
+		appendStringInfoString(&state->query_buf, " FORCE QUOTE *");
+	else
+#endif
 	if (options->rco_force_quote)
 	{
 		ListCell *cell;
@@ -298,6 +317,14 @@ RemoteCopyBuildStatement(RemoteCopyState *state,
 			prev = cell;
 		}
 	}
+
+#ifdef ADB
+	if (options->rco_encoding)
+	{
+		appendStringInfoString(&state->query_buf, " ENCODING ");
+		RemoteCopyQuoteStr(&state->query_buf, options->rco_encoding);
+	}
+#endif
 }
 
 
@@ -317,6 +344,12 @@ makeRemoteCopyOptions(void)
 	res->rco_escape = NULL;
 	res->rco_force_quote = NIL;
 	res->rco_force_notnull = NIL;
+#ifdef ADB
+	res->rco_header = false;
+	res->rco_force_quote_all = false;
+	res->rco_encoding = NULL;
+	res->rco_filename = NULL;
+#endif
 	return res;
 }
 
@@ -345,6 +378,12 @@ FreeRemoteCopyOptions(RemoteCopyOptions *options)
 		list_free(options->rco_force_quote);
 	if (options->rco_force_notnull)
 		list_free(options->rco_force_notnull);
+#ifdef ADB
+	if (options->rco_encoding)
+		pfree(options->rco_encoding);
+	if (options->rco_filename)
+		pfree(options->rco_filename);
+#endif
 
 	/* Then finish the work */
 	pfree(options);
@@ -39,6 +39,7 @@
 #include "nodes/nodes.h"
 #include "nodes/nodeFuncs.h"
 #include "nodes/pg_list.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/catcache.h"
 #include "utils/datum.h"
@@ -50,6 +51,7 @@
 #include "utils/tqual.h"
 #include "optimizer/clauses.h"
 #include "optimizer/paths.h"
+#include "optimizer/plancat.h"
 #include "parser/parse_coerce.h"
 #include "pgxc/nodemgr.h"
 #include "pgxc/locator.h"
@@ -91,6 +93,8 @@ typedef struct CreateReduceExprContext
 } CreateReduceExprContext;
 
 static Expr *pgxc_find_distcol_expr(Index varno, AttrNumber attrNum, Node *quals);
+static int get_range_index(RelationLocInfo *rel_loc_info, FmgrInfo *cmp_finfo, Datum value);
+static bool pgxc_exec_time_expr_walker(Node *node, bool *has_param);
 
 Oid		primary_data_node = InvalidOid;
 int		num_preferred_data_nodes = 0;
@@ -130,6 +134,164 @@ get_nodeid_from_modulo(int modulo, List *nodeids)
 	return list_nth_oid(nodeids, modulo);
 }
 
+/*
+ * get_modulo_value - value % nnodes of a modulo table
+ *
+ * Same as execModuloValue, integers are done here without an executor.
+ */
+static int
+get_modulo_value(Datum value, Oid typid, int nnodes)
+{
+	int64		modulo;
+
+	switch (typid)
+	{
+		case INT2OID:
+			modulo = DatumGetInt16(value) % nnodes;
+			break;
+		case INT4OID:
+			modulo = DatumGetInt32(value) % nnodes;
+			break;
+		case INT8OID:
+			modulo = DatumGetInt64(value) % nnodes;
+			break;
+		default:
+			return execModuloValue(value, typid, nnodes);
+	}
+
+	return (int) (modulo < 0 ? -modulo : modulo);
+}
+
+/*
+ * IsLocatorBucketMapEqual
+ * Check that two hashmap tables send each bucket to the same node.
+ */
+bool
+IsLocatorBucketMapEqual(RelationLocInfo *locInfo1,
+						RelationLocInfo *locInfo2)
+{
+	int i;
+
+	Assert(locInfo1 && locInfo2);
+
+	if (locInfo1->numBuckets != locInfo2->numBuckets)
+		return false;
+
+	for (i = 0; i < locInfo1->numBuckets; i++)
+	{
+		if (list_nth_oid(locInfo1->nodeids, locInfo1->bucketMap[i]) !=
+			list_nth_oid(locInfo2->nodeids, locInfo2->bucketMap[i]))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * get_nodeid_from_range - determine node of a range table
+ *
+ * Node i holds the values from bound i-1 included to bound i excluded, so
+ * the index of the node is the number of bounds not above the value.
+ */
+static Oid
+get_nodeid_from_range(RelationLocInfo *rel_loc_info, Datum value)
+{
+	TypeCacheEntry *typentry;
+
+	typentry = lookup_type_cache(rel_loc_info->rangeType, TYPECACHE_CMP_PROC_FINFO);
+	Assert(OidIsValid(typentry->cmp_proc_finfo.fn_oid));
+
+	return get_nodeid_from_modulo(get_range_index(rel_loc_info,
+												  &typentry->cmp_proc_finfo,
+												  value),
+								  rel_loc_info->nodeids);
+}
+
+/*
+ * get_range_index - index in nodeids of the range holding value
+ */
+static int
+get_range_index(RelationLocInfo *rel_loc_info, FmgrInfo *cmp_finfo, Datum value)
+{
+	int			left = 0;
+	int			right = rel_loc_info->numRangeBounds;
+
+	while (left < right)
+	{
+		int			mid = (left + right) / 2;
+		int32		cmp;
+
+		cmp = DatumGetInt32(FunctionCall2Coll(cmp_finfo,
+											  rel_loc_info->rangeCollid,
+											  rel_loc_info->rangeBounds[mid],
+											  value));
+		if (cmp <= 0)
+			left = mid + 1;
+		else
+			right = mid;
+	}
+
+	return left;
+}
+
+/*
+ * IsLocatorRangeBoundsEqual
+ * Check that two range tables put each value on the same node.
+ */
+bool
+IsLocatorRangeBoundsEqual(RelationLocInfo *locInfo1,
+						  RelationLocInfo *locInfo2)
+{
+	int16		typlen;
+	bool		typbyval;
+	int			i;
+
+	Assert(locInfo1 && locInfo2);
+
+	if (locInfo1->rangeType != locInfo2->rangeType ||
+		locInfo1->rangeCollid != locInfo2->rangeCollid ||
+		locInfo1->numRangeBounds != locInfo2->numRangeBounds)
+		return false;
+
+	get_typlenbyval(locInfo1->rangeType, &typlen, &typbyval);
+	for (i = 0; i < locInfo1->numRangeBounds; i++)
+	{
+		if (!datumIsEqual(locInfo1->rangeBounds[i], locInfo2->rangeBounds[i],
+						  typbyval, typlen))
+			return false;
+	}
+
+	/* and each range goes to the node at the same place */
+	return equal(locInfo1->nodeids, locInfo2->nodeids);
+}
+
+/*
+ * MakeRangeBoundsConst
+ * Make an array Const of the bounds of a range table.
+ */
+Const *
+MakeRangeBoundsConst(const RelationLocInfo *locInfo)
+{
+	ArrayType  *bounds;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+
+	Assert(locInfo->locatorType == LOCATOR_TYPE_RANGE);
+
+	get_typlenbyvalalign(locInfo->rangeType, &typlen, &typbyval, &typalign);
+	bounds = construct_array(locInfo->rangeBounds, locInfo->numRangeBounds,
+							 locInfo->rangeType, typlen, typbyval, typalign);
+
+	return makeConst(get_array_type(locInfo->rangeType),
+					 -1,
+					 locInfo->rangeCollid,
+					 -1,
+					 PointerGetDatum(bounds),
+					 false,
+					 false);
+}
+
 
 /*
  * GetRelationDistribColumn
@@ -299,6 +461,16 @@ IsLocatorInfoEqual(RelationLocInfo *locInfo1,
 	if (!equal(locInfo1->funcAttrNums, locInfo2->funcAttrNums))
 		return false;
 
+	/* Same bucket map? */
+	if (locInfo1->locatorType == LOCATOR_TYPE_HASHMAP &&
+		!IsLocatorBucketMapEqual(locInfo1, locInfo2))
+		return false;
+
+	/* Same range bounds? */
+	if (locInfo1->locatorType == LOCATOR_TYPE_RANGE &&
+		!IsLocatorRangeBoundsEqual(locInfo1, locInfo2))
+		return false;
+
 	/* Everything is equal */
 	return true;
 }
@@ -322,6 +494,116 @@ ExecNodes *MakeExecNodesByOids(RelationLocInfo *loc_info, List *oids, RelationAc
 	return exec_nodes;
 }
 
+/*
+ * GetRelationNodeIndexes
+ *
+ * Find the node to insert each of nvalues values of the distribution column
+ * into, the node GetRelationNodes gives for RELATION_ACCESS_INSERT of one
+ * value, as an index in nodeids of the relation. Hash values of the whole
+ * batch are computed at once by hash_datum_array if the type has a kernel.
+ * Returns false if rows of the relation do not go to one node chosen by
+ * the value.
+ */
+bool
+GetRelationNodeIndexes(RelationLocInfo *rel_loc_info, Oid typid, int nvalues,
+					   const Datum *values, const bool *nulls, int *node_indexes)
+{
+	int			nnodes = list_length(rel_loc_info->nodeids);
+	int			i;
+
+	Assert(nnodes > 0);
+	switch (rel_loc_info->locatorType)
+	{
+		case LOCATOR_TYPE_HASH:
+		case LOCATOR_TYPE_HASHMAP:
+			{
+				TypeCacheEntry *typeCache = NULL;
+				uint32	   *hashes;
+				int			divisor;
+
+				hashes = (uint32 *) palloc(sizeof(uint32) * nvalues);
+				if (!type_is_enum(typid))
+					typeCache = lookup_type_cache(typid, TYPECACHE_HASH_PROC);
+				if (typeCache == NULL ||
+					!hash_datum_array(typeCache->hash_proc, values, nulls,
+									  nvalues, hashes))
+				{
+					for (i = 0; i < nvalues; i++)
+					{
+						if (!nulls[i])
+							hashes[i] = (uint32) execHashValue(values[i], typid, InvalidOid);
+					}
+				}
+
+				if (rel_loc_info->locatorType == LOCATOR_TYPE_HASHMAP)
+				{
+					Assert(rel_loc_info->bucketMap && rel_loc_info->numBuckets > 0);
+					divisor = rel_loc_info->numBuckets;
+				}else
+				{
+					divisor = nnodes;
+				}
+
+				for (i = 0; i < nvalues; i++)
+				{
+					int32		modulo;
+
+					/* Insert NULL to first node, or node of first bucket */
+					if (nulls[i])
+						modulo = 0;
+					else
+					{
+						modulo = ((int32) hashes[i]) % divisor;
+						if (modulo < 0)
+							modulo = -modulo;
+					}
+
+					if (rel_loc_info->locatorType == LOCATOR_TYPE_HASHMAP)
+						node_indexes[i] = rel_loc_info->bucketMap[modulo];
+					else
+						node_indexes[i] = modulo;
+				}
+				pfree(hashes);
+			}
+			break;
+
+		case LOCATOR_TYPE_MODULO:
+			for (i = 0; i < nvalues; i++)
+			{
+				/* Insert NULL to first node */
+				if (nulls[i])
+					node_indexes[i] = 0;
+				else
+					node_indexes[i] = get_modulo_value(values[i], typid, nnodes);
+			}
+			break;
+
+		case LOCATOR_TYPE_RANGE:
+			{
+				TypeCacheEntry *typentry;
+
+				typentry = lookup_type_cache(rel_loc_info->rangeType, TYPECACHE_CMP_PROC_FINFO);
+				Assert(OidIsValid(typentry->cmp_proc_finfo.fn_oid));
+				for (i = 0; i < nvalues; i++)
+				{
+					/* Insert NULL to first node */
+					if (nulls[i])
+						node_indexes[i] = 0;
+					else
+						node_indexes[i] = get_range_index(rel_loc_info,
+														  &typentry->cmp_proc_finfo,
+														  values[i]);
+				}
+			}
+			break;
+
+		default:
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * GetRelationNodes
  *
@@ -403,22 +685,52 @@ GetRelationNodes(RelationLocInfo *rel_loc_info,
 					}
 				}else
 				{
-					if(rel_loc_info->locatorType == LOCATOR_TYPE_HASH)
+					GetRelationNodeIndexes(rel_loc_info, dist_col_types[0], 1,
+										   dist_col_values, dist_col_nulls, &modulo);
+				}
+				exec_nodes->nodeids = list_make1_oid(get_nodeid_from_modulo(modulo, rel_loc_info->nodeids));
+			}
+			break;
+
+		case LOCATOR_TYPE_HASHMAP:
+			{
+				if(dist_col_nulls[0])
+				{
+					if(accessType == RELATION_ACCESS_INSERT)
 					{
-						int32 hashVal = execHashValue(dist_col_values[0],
-											  dist_col_types[0],
-											  InvalidOid);
-						modulo = execModuloValue(Int32GetDatum(hashVal),
-												 INT4OID,
-												 list_length(rel_loc_info->nodeids));
+						/* Insert NULL to the node of first bucket */
+						exec_nodes->nodeids = list_make1_oid(
+							get_nodeid_from_modulo(rel_loc_info->bucketMap[0], rel_loc_info->nodeids));
 					}else
 					{
-						modulo = execModuloValue(dist_col_values[0],
-												dist_col_types[0],
-												list_length(rel_loc_info->nodeids));
+						exec_nodes->nodeids = list_copy(rel_loc_info->nodeids);
 					}
+				}else
+				{
+					int node_index;
+
+					GetRelationNodeIndexes(rel_loc_info, dist_col_types[0], 1,
+										   dist_col_values, dist_col_nulls, &node_index);
+					exec_nodes->nodeids = list_make1_oid(get_nodeid_from_modulo(node_index,
+																				rel_loc_info->nodeids));
+				}
+			}
+			break;
+
+		case LOCATOR_TYPE_RANGE:
+			{
+				if(dist_col_nulls[0])
+				{
+					if(accessType == RELATION_ACCESS_INSERT)
+						/* Insert NULL to first node*/
+						exec_nodes->nodeids = list_make1_oid(linitial_oid(rel_loc_info->nodeids));
+					else
+						exec_nodes->nodeids = list_copy(rel_loc_info->nodeids);
+				}else
+				{
+					exec_nodes->nodeids = list_make1_oid(get_nodeid_from_range(rel_loc_info,
+																			   dist_col_values[0]));
 				}
-				exec_nodes->nodeids = list_make1_oid(get_nodeid_from_modulo(modulo, rel_loc_info->nodeids));
 			}
 			break;
 
@@ -488,7 +800,6 @@ GetRelationNodes(RelationLocInfo *rel_loc_info,
 			}
 			break;
 
-			/* PGXCTODO case LOCATOR_TYPE_RANGE: */
 			/* PGXCTODO case LOCATOR_TYPE_CUSTOM: */
 		default:
 			ereport(ERROR, (errmsg("Error: no such supported locator type: %c\n",
@@ -532,6 +843,23 @@ GetRelationNodesByQuals(Oid reloid, Index varno, Node *quals,
 										   quals,
 										   relaccess);
 
+	/*
+	 * IN lists, ORs of equalities, and comparisons of a range distributed
+	 * table can reduce the Datanodes too, leave them to the constraints of
+	 * each node, like for a read.
+	 */
+	if (IsRelationDistributedByValue(rel_loc_info) &&
+		relaccess != RELATION_ACCESS_INSERT &&
+		quals != NULL)
+	{
+		List *oids = relation_remote_by_constraints_base(NULL,
+														 quals,
+														 rel_loc_info,
+														 varno);
+		if (oids != NIL)
+			return MakeExecNodesByOids(rel_loc_info, oids, relaccess);
+	}
+
 	/*
 	 * If the table distributed by value, check if we can reduce the Datanodes
 	 * by looking at the qualifiers for this relation
@@ -590,6 +918,176 @@ GetRelationNodesByQuals(Oid reloid, Index varno, Node *quals,
 	return exec_nodes;
 }
 
+/*
+ * GetRelationDistribExprByQuals
+ * Find the expression the distribution column of a relation distributed by
+ * value equals to in the quals, which can not be folded to a constant when
+ * planning, but the Coordinator can evaluate it before execution, like a
+ * parameter of a prepared statement. Returns NULL if there is no such
+ * expression of the distribution column type. A value of other type is not
+ * coerced, the operator may compare it with the column in its own type, and
+ * coercion may round or fail where the comparison does not.
+ */
+Expr *
+GetRelationDistribExprByQuals(RelationLocInfo *rel_loc_info, Index varno,
+							  Node *quals)
+{
+	Expr	   *distcol_expr;
+	bool		has_param = false;
+
+	if (!rel_loc_info || !IsRelationDistributedByValue(rel_loc_info))
+		return NULL;
+
+	distcol_expr = pgxc_find_distcol_expr(varno, rel_loc_info->partAttrNum,
+										  quals);
+	if (distcol_expr == NULL ||
+		pgxc_exec_time_expr_walker((Node *) distcol_expr, &has_param) ||
+		!has_param ||
+		contain_volatile_functions((Node *) distcol_expr))
+		return NULL;
+
+	/* run on all Datanodes if the value is not of the column type */
+	if (exprType((Node *) distcol_expr) !=
+		get_atttype(rel_loc_info->relid, rel_loc_info->partAttrNum))
+		return NULL;
+
+	return (Expr *) eval_const_expressions(NULL, (Node *) distcol_expr);
+}
+
+/*
+ * GetRelationDistribArrayByQuals
+ * Like GetRelationDistribExprByQuals, but for "distcol = ANY(array)" or
+ * "distcol = expr1 OR distcol = expr2 ..." in the quals. Returns an array of
+ * the distribution column type, each element of it gives the Datanodes to
+ * run on, or NULL if there is no such expression. Elements of other types
+ * are not coerced, for the same reason as GetRelationDistribExprByQuals.
+ */
+Expr *
+GetRelationDistribArrayByQuals(RelationLocInfo *rel_loc_info, Index varno,
+							   Node *quals)
+{
+	List	   *lquals;
+	ListCell   *lc;
+	Oid			disttype;
+	Oid			arraytype;
+
+	if (!rel_loc_info || !IsRelationDistributedByValue(rel_loc_info) ||
+		quals == NULL)
+		return NULL;
+
+	disttype = get_atttype(rel_loc_info->relid, rel_loc_info->partAttrNum);
+	arraytype = get_array_type(disttype);
+	if (!OidIsValid(arraytype))
+		return NULL;
+
+	if (!IsA(quals, List))
+		lquals = make_ands_implicit((Expr *) quals);
+	else
+		lquals = (List *) quals;
+
+	foreach(lc, lquals)
+	{
+		Node	   *qual = (Node *) lfirst(lc);
+		Expr	   *array_expr = NULL;
+		bool		has_param = false;
+
+		if (IsA(qual, ScalarArrayOpExpr) &&
+			((ScalarArrayOpExpr *) qual)->useOr)
+		{
+			ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) qual;
+			Node	   *lexpr = linitial(saop->args);
+
+			if (IsA(lexpr, RelabelType))
+				lexpr = (Node *) ((RelabelType *) lexpr)->arg;
+			if (IsA(lexpr, Var) &&
+				((Var *) lexpr)->varno == varno &&
+				((Var *) lexpr)->varattno == rel_loc_info->partAttrNum &&
+				(op_mergejoinable(saop->opno, exprType(lexpr)) ||
+				 op_hashjoinable(saop->opno, exprType(lexpr))))
+				array_expr = (Expr *) lsecond(saop->args);
+		}
+		else if (or_clause(qual))
+		{
+			/* every arm has to give a value of the distribution column */
+			ListCell   *lc_arm;
+			List	   *elems = NIL;
+
+			foreach(lc_arm, ((BoolExpr *) qual)->args)
+			{
+				Node	   *elem;
+
+				elem = (Node *) pgxc_find_distcol_expr(varno,
+													   rel_loc_info->partAttrNum,
+													   lfirst(lc_arm));
+				if (elem == NULL || exprType(elem) != disttype)
+				{
+					list_free(elems);
+					elems = NIL;
+					break;
+				}
+				elems = lappend(elems, elem);
+			}
+
+			if (elems != NIL)
+			{
+				ArrayExpr  *arr = makeNode(ArrayExpr);
+
+				arr->array_typeid = arraytype;
+				arr->array_collid = get_typcollation(disttype);
+				arr->element_typeid = disttype;
+				arr->elements = elems;
+				arr->multidims = false;
+				arr->location = -1;
+				array_expr = (Expr *) arr;
+			}
+		}
+
+		if (array_expr == NULL ||
+			exprType((Node *) array_expr) != arraytype ||
+			pgxc_exec_time_expr_walker((Node *) array_expr, &has_param) ||
+			!has_param ||
+			contain_volatile_functions((Node *) array_expr))
+			continue;
+
+		return (Expr *) eval_const_expressions(NULL, (Node *) array_expr);
+	}
+
+	return NULL;
+}
+
+/*
+ * Return true if the expression can not be evaluated without a row or a
+ * plan, has_param is set if it references a parameter given by client.
+ */
+static bool
+pgxc_exec_time_expr_walker(Node *node, bool *has_param)
+{
+	if (node == NULL)
+		return false;
+
+	switch (nodeTag(node))
+	{
+		case T_Var:
+		case T_Aggref:
+		case T_WindowFunc:
+		case T_SubLink:
+		case T_SubPlan:
+		case T_AlternativeSubPlan:
+		case T_CurrentOfExpr:
+			return true;
+		case T_Param:
+			if (((Param *) node)->paramkind != PARAM_EXTERN)
+				return true;
+			*has_param = true;
+			return false;
+		default:
+			break;
+	}
+
+	return expression_tree_walker(node, pgxc_exec_time_expr_walker,
+								  (void *) has_param);
+}
+
 ExecNodes *
 GetRelationNodesByMultQuals(RelationLocInfo *rel_loc_info,
 							Oid reloid, Index varno, Node *quals,
@@ -819,6 +1317,57 @@ RelationBuildLocator(Relation rel)
 
 	relationLocInfo->funcid = InvalidOid;
 	relationLocInfo->funcAttrNums = NIL;
+	relationLocInfo->numBuckets = 0;
+	relationLocInfo->bucketMap = NULL;
+	if (relationLocInfo->locatorType == LOCATOR_TYPE_HASHMAP)
+	{
+		Datum bucketmapDatum;
+		bool isnull;
+		int2vector *bucketmap;
+
+		bucketmapDatum = SysCacheGetAttr(PGXCCLASSRELID, htup,
+										 Anum_pgxc_class_pcbucketmap, &isnull);
+		Assert(!isnull);
+		bucketmap = (int2vector *)DatumGetPointer(bucketmapDatum);
+		relationLocInfo->numBuckets = bucketmap->dim1;
+		relationLocInfo->bucketMap = (int16 *) palloc(sizeof(int16) * bucketmap->dim1);
+		memcpy(relationLocInfo->bucketMap, bucketmap->values, sizeof(int16) * bucketmap->dim1);
+	}
+
+	relationLocInfo->rangeType = InvalidOid;
+	relationLocInfo->rangeCollid = InvalidOid;
+	relationLocInfo->numRangeBounds = 0;
+	relationLocInfo->rangeBounds = NULL;
+	if (relationLocInfo->locatorType == LOCATOR_TYPE_RANGE)
+	{
+		Datum boundsDatum;
+		bool isnull;
+		ArrayType *bounds;
+		Datum *values;
+		int16 typlen;
+		bool typbyval;
+		char typalign;
+
+		boundsDatum = SysCacheGetAttr(PGXCCLASSRELID, htup,
+									  Anum_pgxc_class_pcrangebounds, &isnull);
+		Assert(!isnull);
+		bounds = DatumGetArrayTypeP(boundsDatum);
+		relationLocInfo->rangeType = ARR_ELEMTYPE(bounds);
+		relationLocInfo->rangeCollid =
+			rel->rd_att->attrs[relationLocInfo->partAttrNum - 1]->attcollation;
+
+		/* copy the bounds, the tuple goes away with the scan */
+		get_typlenbyvalalign(relationLocInfo->rangeType, &typlen, &typbyval, &typalign);
+		deconstruct_array(bounds, relationLocInfo->rangeType, typlen, typbyval, typalign,
+						  &values, NULL, &relationLocInfo->numRangeBounds);
+		relationLocInfo->rangeBounds = (Datum *) palloc(sizeof(Datum) * relationLocInfo->numRangeBounds);
+		for (j = 0; j < relationLocInfo->numRangeBounds; j++)
+			relationLocInfo->rangeBounds[j] = datumCopy(values[j], typbyval, typlen);
+		pfree(values);
+		if ((Pointer) bounds != DatumGetPointer(boundsDatum))
+			pfree(bounds);
+	}
+
 	if (relationLocInfo->locatorType == LOCATOR_TYPE_USER_DEFINED)
 	{
 		Datum funcidDatum;
@@ -886,6 +1435,26 @@ CopyRelationLocInfo(RelationLocInfo *srcInfo)
 	destInfo->nodeids = list_copy(srcInfo->nodeids);
 	destInfo->funcid = srcInfo->funcid;
 	destInfo->funcAttrNums = list_copy(srcInfo->funcAttrNums);
+	destInfo->numBuckets = srcInfo->numBuckets;
+	if (srcInfo->bucketMap)
+	{
+		destInfo->bucketMap = (int16 *) palloc(sizeof(int16) * srcInfo->numBuckets);
+		memcpy(destInfo->bucketMap, srcInfo->bucketMap, sizeof(int16) * srcInfo->numBuckets);
+	}
+	destInfo->rangeType = srcInfo->rangeType;
+	destInfo->rangeCollid = srcInfo->rangeCollid;
+	destInfo->numRangeBounds = srcInfo->numRangeBounds;
+	if (srcInfo->rangeBounds)
+	{
+		int16 typlen;
+		bool typbyval;
+		int i;
+
+		get_typlenbyval(srcInfo->rangeType, &typlen, &typbyval);
+		destInfo->rangeBounds = (Datum *) palloc(sizeof(Datum) * srcInfo->numRangeBounds);
+		for (i = 0; i < srcInfo->numRangeBounds; i++)
+			destInfo->rangeBounds[i] = datumCopy(srcInfo->rangeBounds[i], typbyval, typlen);
+	}
 
 	/* Note: for roundrobin, we use the relcache entry */
 	return destInfo;
@@ -903,6 +1472,18 @@ FreeRelationLocInfo(RelationLocInfo *relationLocInfo)
 	{
 		list_free(relationLocInfo->nodeids);
 		list_free(relationLocInfo->funcAttrNums);
+		if (relationLocInfo->bucketMap)
+			pfree(relationLocInfo->bucketMap);
+		if (relationLocInfo->rangeBounds)
+		{
+			if (!get_typbyval(relationLocInfo->rangeType))
+			{
+				int i;
+				for (i = 0; i < relationLocInfo->numRangeBounds; i++)
+					pfree(DatumGetPointer(relationLocInfo->rangeBounds[i]));
+			}
+			pfree(relationLocInfo->rangeBounds);
+		}
 		pfree(relationLocInfo);
 	}
 }
@@ -1082,17 +1663,51 @@ GetInvolvedNodes(RelationLocInfo *rel_loc,
 					}
 				} else
 				{
-					if(rel_loc->locatorType == LOCATOR_TYPE_HASH)
-					{
-						int32 hashVal = execHashValue(dist_values[0], dist_types[0], InvalidOid);
-						modulo = execModuloValue(Int32GetDatum(hashVal), INT4OID, nnodes);
-					}else
-						modulo = execModuloValue(dist_values[0], dist_types[0], nnodes);
+					GetRelationNodeIndexes(rel_loc, dist_types[0], 1,
+										   dist_values, dist_nulls, &modulo);
 				}
 				node_list = list_make1_oid(list_nth_oid(rel_loc->nodeids, modulo));
 			}
 			break;
 
+		case LOCATOR_TYPE_HASHMAP:
+			{
+				if(dist_nulls[0])
+				{
+					if(accessType == RELATION_ACCESS_INSERT)
+						/* Insert NULL to the node of first bucket */
+						node_list = list_make1_oid(list_nth_oid(rel_loc->nodeids,
+																rel_loc->bucketMap[0]));
+					else
+						node_list = list_copy(rel_loc->nodeids);
+				} else
+				{
+					int node_index;
+
+					GetRelationNodeIndexes(rel_loc, dist_types[0], 1,
+										   dist_values, dist_nulls, &node_index);
+					node_list = list_make1_oid(get_nodeid_from_modulo(node_index,
+																	  rel_loc->nodeids));
+				}
+			}
+			break;
+
+		case LOCATOR_TYPE_RANGE:
+			{
+				if(dist_nulls[0])
+				{
+					if(accessType == RELATION_ACCESS_INSERT)
+						/* Insert NULL to first node*/
+						node_list = list_make1_oid(linitial_oid(rel_loc->nodeids));
+					else
+						node_list = list_copy(rel_loc->nodeids);
+				} else
+				{
+					node_list = list_make1_oid(get_nodeid_from_range(rel_loc, dist_values[0]));
+				}
+			}
+			break;
+
 		case LOCATOR_TYPE_RROBIN:
 			{
 				/*
@@ -1159,7 +1774,6 @@ GetInvolvedNodes(RelationLocInfo *rel_loc,
 			}
 			break;
 
-			/* TODO case LOCATOR_TYPE_RANGE: */
 			/* TODO case LOCATOR_TYPE_CUSTOM: */
 		default:
 			ereport(ERROR,
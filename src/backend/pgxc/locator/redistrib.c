@@ -30,7 +30,31 @@
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
 #ifdef ADB
+#include "access/heapam.h"
+#include "access/relscan.h"
+#include "commands/copy.h"
+#include "executor/execCluster.h"
+#include "executor/executor.h"
 #include "intercomm/inter-comm.h"
+#include "libpq/libpq-fe.h"
+#include "libpq/libpq-node.h"
+#include "nodes/makefuncs.h"
+#include "optimizer/reduceinfo.h"
+#include "storage/mem_toc.h"
+#include "utils/memutils.h"
+
+/* rows of a Datanode scanned by DISTRIB_REDUCE */
+typedef struct RedistribScanState
+{
+	Relation		rel;
+	HeapScanDesc	scan;
+	TupleTableSlot *slot;
+	ExprContext	   *econtext;
+	ExprState	   *reduce;		/* reduce expr of new distribution */
+	uint64			moved;
+} RedistribScanState;
+
+extern bool enable_cluster_plan;
 #endif
 
 #define IsCommandTypePreUpdate(x) (x == CATALOG_UPDATE_BEFORE || \
@@ -46,6 +70,11 @@ static void distrib_copy_from(RedistribState *distribState, ExecNodes *exec_node
 static void distrib_truncate(RedistribState *distribState, ExecNodes *exec_nodes);
 static void distrib_reindex(RedistribState *distribState, ExecNodes *exec_nodes);
 static void distrib_delete_hash(RedistribState *distribState, ExecNodes *exec_nodes);
+#ifdef ADB
+static void distrib_reduce(RedistribState *distribState, ExecNodes *exec_nodes);
+static bool distrib_reduce_finish_hook(void *context, struct pg_conn *conn, PQNHookFuncType type, ...);
+static TupleTableSlot *distrib_reduce_next_row(CopyState cstate, ExprContext *econtext, void *data);
+#endif
 
 /* Functions used to build the command list */
 static void pgxc_redist_build_entry(RedistribState *distribState,
@@ -58,6 +87,11 @@ static void pgxc_redist_build_replicate_to_distrib(RedistribState *distribState,
 								RelationLocInfo *oldLocInfo,
 								RelationLocInfo *newLocInfo);
 
+#ifdef ADB
+static void pgxc_redist_build_reduce(RedistribState *distribState,
+								RelationLocInfo *oldLocInfo,
+								RelationLocInfo *newLocInfo);
+#endif
 static void pgxc_redist_build_default(RedistribState *distribState);
 static void pgxc_redist_add_reindex(RedistribState *distribState);
 
@@ -137,6 +171,11 @@ pgxc_redist_build_entry(RedistribState *distribState,
 	/* Evaluate cases for replicated to distributed tables */
 	pgxc_redist_build_replicate_to_distrib(distribState, oldLocInfo, newLocInfo);
 
+#ifdef ADB
+	/* Evaluate cases Datanodes can move rows among themselves */
+	pgxc_redist_build_reduce(distribState, oldLocInfo, newLocInfo);
+#endif
+
 	/* PGXCTODO: perform more complex builds of command list */
 
 	/* Fallback to default */
@@ -174,9 +213,12 @@ pgxc_redist_build_replicate_to_distrib(RedistribState *distribState,
 
 	/*
 	 * If some nodes are added, turn back to default, we need to fetch data
-	 * and then redistribute it properly.
+	 * and then redistribute it properly. Rows of a hashmap or range table
+	 * cannot be filtered by a hash condition on remote nodes either.
 	 */
-	if (newNodeIds != NIL)
+	if (newNodeIds != NIL ||
+		newLocInfo->locatorType == LOCATOR_TYPE_HASHMAP ||
+		newLocInfo->locatorType == LOCATOR_TYPE_RANGE)
 		return;
 
 	/* Nodes removed have to be truncated, so add a TRUNCATE commands to removed nodes */
@@ -292,6 +334,61 @@ pgxc_redist_build_replicate(RedistribState *distribState,
 }
 
 
+#ifdef ADB
+/*
+ * pgxc_redist_build_reduce
+ * Build redistribution command list for a table whose rows are stored once
+ * and are distributed by value after. Instead of fetching the whole table to
+ * the Coordinator, every Datanode scans its own rows and sends only those
+ * whose new owner is another node through reduce, in parallel. For a hashmap
+ * table these are only the rows of the buckets given to another node, all
+ * of them in this one command. Otherwise the default COPY TO, TRUNCATE and
+ * COPY FROM moves every row, of every bucket.
+ */
+static void
+pgxc_redist_build_reduce(RedistribState *distribState,
+						 RelationLocInfo *oldLocInfo,
+						 RelationLocInfo *newLocInfo)
+{
+	Relation	rel;
+	ExecNodes  *execNodes;
+	bool		can_reduce;
+
+	/* If a command list has already been built, nothing to do */
+	if (list_length(distribState->commands) != 0)
+		return;
+
+	if (!enable_cluster_plan ||
+		IsRelationReplicated(oldLocInfo) ||
+		(newLocInfo->locatorType != LOCATOR_TYPE_HASH &&
+		 newLocInfo->locatorType != LOCATOR_TYPE_HASHMAP &&
+		 newLocInfo->locatorType != LOCATOR_TYPE_RANGE &&
+		 newLocInfo->locatorType != LOCATOR_TYPE_MODULO &&
+		 newLocInfo->locatorType != LOCATOR_TYPE_USER_DEFINED))
+		return;
+
+	/*
+	 * Moved rows are inserted by COPY and deleted silently, which would make
+	 * triggers see only a part of the change, and auxiliary tables refer to
+	 * the old place of rows. Temporary tables are not seen by cluster plans.
+	 */
+	rel = relation_open(distribState->relid, NoLock);
+	can_reduce = (rel->trigdesc == NULL &&
+				  rel->rd_auxlist == NIL &&
+				  !IsTempTable(RelationGetRelid(rel)));
+	relation_close(rel, NoLock);
+	if (!can_reduce)
+		return;
+
+	/* Both nodes removed and nodes added take part */
+	execNodes = makeNode(ExecNodes);
+	execNodes->nodeids = list_union_oid(oldLocInfo->nodeids, newLocInfo->nodeids);
+	distribState->commands = lappend(distribState->commands,
+				 makeRedistribCommand(DISTRIB_REDUCE, CATALOG_UPDATE_AFTER, execNodes));
+}
+#endif /* ADB */
+
+
 /*
  * pgxc_redist_build_default
  * Build a default list consisting of
@@ -367,6 +464,11 @@ distrib_execute_command(RedistribState *distribState, RedistribCommand *command)
 		case DISTRIB_DELETE_MODULO:
 			distrib_delete_hash(distribState, command->execNodes);
 			break;
+#ifdef ADB
+		case DISTRIB_REDUCE:
+			distrib_reduce(distribState, command->execNodes);
+			break;
+#endif
 		case DISTRIB_NONE:
 		default:
 			Assert(0); /* Should not happen */
@@ -824,6 +926,199 @@ distrib_delete_hash(RedistribState *distribState, ExecNodes *exec_nodes)
 	pfree(buf);
 }
 
+#ifdef ADB
+/*
+ * distrib_reduce
+ * Start a cluster COPY on all nodes in exec_nodes to move rows to their new
+ * owner, see ClusterRedistribTable. Catalogs are updated already, so the
+ * locator information of relation is the new distribution.
+ */
+static void
+distrib_reduce(RedistribState *distribState, ExecNodes *exec_nodes)
+{
+	Relation		rel;
+	CopyStmt	   *stmt;
+	ReduceInfo	   *rinfo;
+	Expr		   *reduce;
+	List		   *conns;
+	StringInfoData	mem_toc;
+
+	/* A sufficient lock level needs to be taken at a higher level */
+	rel = relation_open(distribState->relid, NoLock);
+
+	/* Inform client of operation being done */
+	ereport(DEBUG1,
+			(errmsg("Moving tuples among Datanodes for relation \"%s.%s\"",
+					get_namespace_name(RelationGetNamespace(rel)),
+					RelationGetRelationName(rel))));
+
+	rinfo = MakeReduceInfoFromLocInfo(RelationGetLocInfo(rel),
+									  NIL,
+									  RelationGetRelid(rel),
+									  1 /* only have one relation */);
+	reduce = CreateExprUsingReduceInfo(rinfo);
+
+	stmt = makeNode(CopyStmt);
+	stmt->relation = makeRangeVar(get_namespace_name(RelationGetNamespace(rel)),
+								  pstrdup(RelationGetRelationName(rel)),
+								  -1);
+	stmt->is_from = true;
+
+	initStringInfo(&mem_toc);
+	begin_mem_toc_insert(&mem_toc, REDISTRIB_KEY_REDUCE);
+	saveNode(&mem_toc, (Node*)reduce);
+	end_mem_toc_insert(&mem_toc, REDISTRIB_KEY_REDUCE);
+
+	begin_mem_toc_insert(&mem_toc, REDISTRIB_KEY_NODES);
+	saveNode(&mem_toc, (Node*)exec_nodes->nodeids);
+	end_mem_toc_insert(&mem_toc, REDISTRIB_KEY_NODES);
+
+	conns = ExecStartClusterCopy(exec_nodes->nodeids,
+								 stmt,
+								 &mem_toc,
+								 EXEC_CLUSTER_FLAG_NEED_REDUCE);
+	PQNListExecFinish(conns, NULL, distrib_reduce_finish_hook, NULL, true);
+
+	list_free(conns);
+	pfree(mem_toc.data);
+	relation_close(rel, NoLock);
+
+	/* Be sure to advance the command counter after the last command */
+	CommandCounterIncrement();
+}
+
+static bool
+distrib_reduce_finish_hook(void *context, struct pg_conn *conn, PQNHookFuncType type, ...)
+{
+	va_list		args;
+
+	switch(type)
+	{
+	case PQNHFT_ERROR:
+		return PQNEFHNormal(NULL, conn, type);
+	case PQNHFT_COPY_IN_ONLY:
+		PQputCopyEnd(conn, NULL);
+		break;
+	case PQNHFT_RESULT:
+		{
+			PGresult *res;
+			va_start(args, type);
+			res = va_arg(args, PGresult*);
+			if(res)
+			{
+				ExecStatusType status = PQresultStatus(res);
+				if(status == PGRES_FATAL_ERROR)
+					PQNReportResultError(res, conn, ERROR, true);
+				else if(status == PGRES_COPY_IN)
+					PQputCopyEnd(conn, NULL);
+			}
+			va_end(args);
+		}
+		break;
+	default:
+		/* nothing is sent back but the end of copy */
+		break;
+	}
+	return false;
+}
+
+/*
+ * ClusterRedistribTable
+ * Run on a Datanode for DISTRIB_REDUCE. Rows of the relation owned by other
+ * nodes under the new distribution are deleted here and sent to their owner
+ * by reduce, rows sent by other nodes are inserted. Rows staying here are
+ * not touched at all.
+ */
+void
+ClusterRedistribTable(CopyStmt *stmt, StringInfo mem_toc)
+{
+	RedistribScanState	state;
+	StringInfoData		buf;
+	Expr			   *reduce;
+	List			   *rnodes;
+
+	buf.data = mem_toc_lookup(mem_toc, REDISTRIB_KEY_REDUCE, &buf.len);
+	if (buf.data == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("Can not found reduce info in cluster message")));
+	buf.maxlen = buf.len;
+	buf.cursor = 0;
+	reduce = (Expr*)loadNode(&buf);
+
+	buf.data = mem_toc_lookup(mem_toc, REDISTRIB_KEY_NODES, &buf.len);
+	if (buf.data == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("Can not found relation storage info in cluster message")));
+	buf.maxlen = buf.len;
+	buf.cursor = 0;
+	rnodes = (List*)loadNode(&buf);
+
+	/* Coordinator holds the table, keep out writers connected directly too */
+	MemSet(&state, 0, sizeof(state));
+	state.rel = heap_openrv(stmt->relation, ExclusiveLock);
+	state.slot = MakeSingleTupleTableSlot(RelationGetDescr(state.rel));
+	state.econtext = CreateStandaloneExprContext();
+	state.reduce = ExecInitExpr(reduce, NULL);
+
+	/*
+	 * Rows inserted by the COPY below are not visible to this snapshot, so
+	 * rows received from other nodes are never scanned again.
+	 */
+	state.scan = heap_beginscan(state.rel, GetActiveSnapshot(), 0, NULL);
+
+	ClusterCopyFromReduce(state.rel, reduce, rnodes, 1, distrib_reduce_next_row, &state);
+
+	heap_endscan(state.scan);
+	FreeExprContext(state.econtext, true);
+	ExecDropSingleTupleTableSlot(state.slot);
+
+	ereport(DEBUG1,
+			(errmsg("Moved " UINT64_FORMAT " tuples of relation \"%s\" to other Datanodes",
+					state.moved, RelationGetRelationName(state.rel))));
+
+	heap_close(state.rel, NoLock);
+}
+
+/*
+ * Return next local row whose owner is another node, after deleting it.
+ */
+static TupleTableSlot *
+distrib_reduce_next_row(CopyState cstate, ExprContext *econtext, void *data)
+{
+	RedistribScanState *state = data;
+	HeapTuple			tuple;
+	Datum				datum;
+	ExprDoneCond		done;
+	bool				isnull;
+
+	while ((tuple = heap_getnext(state->scan, ForwardScanDirection)) != NULL)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		ExecStoreTuple(tuple, state->slot, state->scan->rs_cbuf, false);
+		ResetExprContext(state->econtext);
+		state->econtext->ecxt_scantuple = state->slot;
+		datum = ExecEvalExpr(state->reduce, state->econtext, &isnull, &done);
+		if (isnull || done == ExprEndResult)
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("ReduceExpr return a null value")));
+
+		/* the row stays here */
+		if (DatumGetObjectId(datum) == PGXCNodeOid)
+			continue;
+
+		simple_heap_delete(state->rel, &tuple->t_self);
+		state->moved++;
+		return state->slot;
+	}
+
+	return ExecClearTuple(state->slot);
+}
+#endif /* ADB */
+
 
 /*
  * makeRedistribState
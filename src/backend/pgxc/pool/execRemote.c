@@ -619,6 +619,7 @@ ExecEndRemoteQuery(RemoteQueryState *node)
 		node->paramval_data = NULL;
 		node->paramval_len = 0;
 	}
+	FreeNodeDataRowForExtParams(node);
 
 	/* Free the param types if they are newly allocated */
 	if (node->rqs_param_types &&
@@ -703,6 +704,77 @@ close_node_cursors(PGXCNodeHandle **connections, int conn_count, char *cursor)
 }
 #endif
 
+/*
+ * Append the first num_params parameter values to buf in format of DataRow
+ * message, the value of parameter paramid is replaced by paramval if it is
+ * not 0.
+ */
+static void
+AppendExtParamsDataRow(StringInfo buf, ParamListInfo paraminfo, int num_params,
+					   int paramid, Datum paramval)
+{
+	uint16 n16;
+	int i;
+
+	/* Number of parameter values */
+	n16 = htons(num_params);
+	appendBinaryStringInfo(buf, (char *) &n16, 2);
+
+	/* Parameter values */
+	for (i = 0; i < num_params; i++)
+	{
+		ParamExternData *param = &paraminfo->params[i];
+		uint32 n32;
+		Datum	value = param->value;
+		bool	isnull = param->isnull;
+
+		if (i + 1 == paramid)
+		{
+			value = paramval;
+			isnull = false;
+		}
+
+		/*
+		 * Parameters with no types are considered as NULL and treated as integer
+		 * The same trick is used for dropped columns for remote DML generation.
+		 */
+		if (isnull || !OidIsValid(param->ptype))
+		{
+			n32 = htonl(-1);
+			appendBinaryStringInfo(buf, (char *) &n32, 4);
+		}
+		else
+		{
+			Oid		typOutput;
+			bool	typIsVarlena;
+			Datum	pval;
+			char   *pstring;
+			int		len;
+
+			/* Get info needed to output the value */
+			getTypeOutputInfo(param->ptype, &typOutput, &typIsVarlena);
+
+			/*
+			 * If we have a toasted datum, forcibly detoast it here to avoid
+			 * memory leakage inside the type's output routine.
+			 */
+			if (typIsVarlena)
+				pval = PointerGetDatum(PG_DETOAST_DATUM(value));
+			else
+				pval = value;
+
+			/* Convert Datum to string */
+			pstring = OidOutputFunctionCall(typOutput, pval);
+
+			/* copy data to the buffer */
+			len = strlen(pstring);
+			n32 = htonl(len);
+			appendBinaryStringInfo(buf, (char *) &n32, 4);
+			appendBinaryStringInfo(buf, pstring, len);
+		}
+	}
+}
+
 /*
  * Encode parameter values to format of DataRow message (the same format is
  * used in Bind) to prepare for sending down to Datanodes.
@@ -712,7 +784,6 @@ void
 SetDataRowForExtParams(ParamListInfo paraminfo, RemoteQueryState *rq_state)
 {
 	StringInfoData buf;
-	uint16 n16;
 	int i;
 	int real_num_params = 0;
 	RemoteQuery *node = (RemoteQuery*) rq_state->ss.ps.plan;
@@ -771,56 +842,7 @@ SetDataRowForExtParams(ParamListInfo paraminfo, RemoteQueryState *rq_state)
 	}
 
 	initStringInfo(&buf);
-
-	/* Number of parameter values */
-	n16 = htons(real_num_params);
-	appendBinaryStringInfo(&buf, (char *) &n16, 2);
-
-	/* Parameter values */
-	for (i = 0; i < real_num_params; i++)
-	{
-		ParamExternData *param = &paraminfo->params[i];
-		uint32 n32;
-
-		/*
-		 * Parameters with no types are considered as NULL and treated as integer
-		 * The same trick is used for dropped columns for remote DML generation.
-		 */
-		if (param->isnull || !OidIsValid(param->ptype))
-		{
-			n32 = htonl(-1);
-			appendBinaryStringInfo(&buf, (char *) &n32, 4);
-		}
-		else
-		{
-			Oid		typOutput;
-			bool	typIsVarlena;
-			Datum	pval;
-			char   *pstring;
-			int		len;
-
-			/* Get info needed to output the value */
-			getTypeOutputInfo(param->ptype, &typOutput, &typIsVarlena);
-
-			/*
-			 * If we have a toasted datum, forcibly detoast it here to avoid
-			 * memory leakage inside the type's output routine.
-			 */
-			if (typIsVarlena)
-				pval = PointerGetDatum(PG_DETOAST_DATUM(param->value));
-			else
-				pval = param->value;
-
-			/* Convert Datum to string */
-			pstring = OidOutputFunctionCall(typOutput, pval);
-
-			/* copy data to the buffer */
-			len = strlen(pstring);
-			n32 = htonl(len);
-			appendBinaryStringInfo(&buf, (char *) &n32, 4);
-			appendBinaryStringInfo(&buf, pstring, len);
-		}
-	}
+	AppendExtParamsDataRow(&buf, paraminfo, real_num_params, 0, (Datum) 0);
 
 
 	/*
@@ -853,6 +875,51 @@ SetDataRowForExtParams(ParamListInfo paraminfo, RemoteQueryState *rq_state)
 	rq_state->paramval_len = buf.len;
 }
 
+/*
+ * Encode parameter values for the Datanode node_id only, like
+ * SetDataRowForExtParams, but the value of parameter paramid is replaced
+ * by paramval. HandleStartRemoteQuery sends it instead of paramval_data.
+ */
+void
+SetNodeDataRowForExtParams(ParamListInfo paraminfo, RemoteQueryState *rq_state,
+						   Oid node_id, int paramid, Datum paramval)
+{
+	RemoteNodeParamData *node_param;
+	StringInfoData buf;
+
+	Assert(rq_state->paramval_data);
+	Assert(paramid > 0 && paramid <= rq_state->rqs_num_params);
+
+	initStringInfo(&buf);
+	AppendExtParamsDataRow(&buf, paraminfo, rq_state->rqs_num_params,
+						   paramid, paramval);
+
+	node_param = (RemoteNodeParamData *) palloc(sizeof(RemoteNodeParamData));
+	node_param->node_id = node_id;
+	node_param->paramval_data = buf.data;
+	node_param->paramval_len = buf.len;
+	rq_state->node_paramvals = lappend(rq_state->node_paramvals, node_param);
+}
+
+/*
+ * Free the parameter values of each Datanode set by SetNodeDataRowForExtParams
+ */
+void
+FreeNodeDataRowForExtParams(RemoteQueryState *rq_state)
+{
+	ListCell   *lc;
+
+	foreach(lc, rq_state->node_paramvals)
+	{
+		RemoteNodeParamData *node_param = (RemoteNodeParamData *) lfirst(lc);
+
+		pfree(node_param->paramval_data);
+		pfree(node_param);
+	}
+	list_free(rq_state->node_paramvals);
+	rq_state->node_paramvals = NIL;
+}
+
 
 /* ----------------------------------------------------------------
  *		ExecRemoteQueryReScan
@@ -39,23 +39,40 @@ static int pool_block_recv(pgsocket sock, void *ptr, uint32 size);
 #ifdef HAVE_UNIX_SOCKETS
 
 static const char sock_path[] = {".s.PGPOOL"};
+/* socket of the pool manager shard listening in this process */
+static char listen_path[MAXPGPATH] = {""};
+
+static void pool_shard_sock_path(char *path, Size size, int shard);
 
 static void StreamDoUnlink(int code, Datum arg);
 
 static int	Lock_AF_UNIX(void);
 #endif
 
+/*
+ * Socket path of pool manager shard, the first shard keeps the old name
+ */
+static void
+pool_shard_sock_path(char *path, Size size, int shard)
+{
+	if (shard == 0)
+		strlcpy(path, sock_path, size);
+	else
+		snprintf(path, size, "%s.%d", sock_path, shard);
+}
+
 /*
  * Open server socket on specified port to accept connection from sessions
  */
 int
-pool_listen()
+pool_listen(int shard)
 {
 #ifdef HAVE_UNIX_SOCKETS
 	int			fd,
 				len;
 	struct sockaddr_un unix_addr;
 
+	pool_shard_sock_path(listen_path, sizeof(listen_path), shard);
 	if (Lock_AF_UNIX() < 0)
 		return -1;
 
@@ -66,7 +83,7 @@ pool_listen()
 	/* fill in socket address structure */
 	memset(&unix_addr, 0, sizeof(unix_addr));
 	unix_addr.sun_family = AF_UNIX;
-	strcpy(unix_addr.sun_path, sock_path);
+	strcpy(unix_addr.sun_path, listen_path);
 	len = sizeof(unix_addr.sun_family) +
 		strlen(unix_addr.sun_path) + 1;
 
@@ -99,8 +116,8 @@ pool_listen()
 static void
 StreamDoUnlink(int code, Datum arg)
 {
-	Assert(sock_path[0]);
-	unlink(sock_path);
+	Assert(listen_path[0]);
+	unlink(listen_path);
 }
 #endif   /* HAVE_UNIX_SOCKETS */
 
@@ -108,19 +125,19 @@ StreamDoUnlink(int code, Datum arg)
 static int
 Lock_AF_UNIX(void)
 {
-	CreateSocketLockFile(sock_path, true, "");
+	CreateSocketLockFile(listen_path, true, "");
 
-	unlink(sock_path);
+	unlink(listen_path);
 
 	return 0;
 }
 #endif
 
 /*
- * Connect to pooler listening on specified port
+ * Connect to pooler shard listening on specified port
  */
 int
-pool_connect(void)
+pool_connect(int shard)
 {
 	int			fd,
 				len;
@@ -133,7 +150,7 @@ pool_connect(void)
 
 	memset(&unix_addr, 0, sizeof(unix_addr));
 	unix_addr.sun_family = AF_UNIX;
-	strcpy(unix_addr.sun_path, sock_path);
+	pool_shard_sock_path(unix_addr.sun_path, sizeof(unix_addr.sun_path), shard);
 	len = sizeof(unix_addr.sun_family) +
 		strlen(unix_addr.sun_path) + 1;
 
@@ -810,7 +827,7 @@ pool_sendpids(PoolPort *port, int *pids, int count)
 
 const char* pool_get_sock_path(void)
 {
-	return sock_path;
+	return listen_path[0] ? listen_path : sock_path;
 }
 
 static void pool_report_error(pgsocket sock, uint32 msg_len)
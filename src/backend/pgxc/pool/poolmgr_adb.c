@@ -10,6 +10,8 @@
 #include "agtm/agtm_client.h"
 #include "catalog/pgxc_node.h"
 #include "commands/dbcommands.h"
+#include "commands/prepare.h"
+#include "funcapi.h"
 #include "libpq/pqformat.h"
 #include "libpq/pqsignal.h"
 #include "lib/ilist.h"
@@ -18,15 +20,20 @@
 #include "nodes/nodes.h"
 #include "pgxc/pgxc.h"
 #include "pgxc/poolmgr.h"
+#include "pgxc/poolstat.h"
 #include "pgxc/poolutils.h"
+#include "postmaster/bgworker.h"
 #include "postmaster/postmaster.h"		/* For Unix_socket_directories */
+#include "storage/fd.h"
 #include "storage/ipc.h"
+#include "storage/lock.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
+#include "utils/timestamp.h"
 #include "libpq/libpq-fe.h"
 #include "libpq/libpq-int.h"
 #include "pgxc/pause.h"
@@ -35,6 +42,14 @@
 #define START_POOL_ALLOC	512
 #define STEP_POLL_ALLOC		8
 
+/* warm-up of node pools, see warm_up_node_pools() */
+#define POOL_WARMUP_MAX_WINDOW		60		/* in minutes */
+#define POOL_WARMUP_CONNECT_STEP	4		/* connects of a node pool each second */
+#define POOL_WARMUP_RETRY_INTERVAL	10		/* in seconds, after a connect failed */
+#define POOL_WARMUP_SAVE_INTERVAL	60		/* in seconds */
+#define POOL_WARMUP_FILE			"pg_pool_warmup"
+#define POOL_WARMUP_FILE_MAGIC		0x50574D31
+
 #define PM_MSG_ABORT_TRANSACTIONS	'a'
 #define PM_MSG_SEND_LOCAL_COMMAND	'b'
 #define PM_MSG_CONNECT				'c'
@@ -46,6 +61,8 @@
 #define PM_MSG_CLOSE_CONNECT		'C'
 #define PM_MSG_ERROR				'E'
 #define PM_MSG_CLOSE_IDLE_CONNECT	'S'
+#define PM_MSG_PARAMS_STATS			'p'
+#define PM_MSG_IDLE_CONNECT			'i'
 
 typedef enum SlotStateType
 {
@@ -67,6 +84,9 @@ typedef enum SlotStateType
 
 	,SLOT_STATE_QUERY_RESET_ALL			/* sended "reset all" */
 	,SLOT_STATE_END_RESET_ALL = SLOT_STATE_QUERY_RESET_ALL+1
+
+	,SLOT_STATE_QUERY_DISCARD			/* sended session discard */
+	,SLOT_STATE_END_DISCARD = SLOT_STATE_QUERY_DISCARD+1
 }SlotStateType;
 
 typedef enum SlotCurrentList
@@ -103,7 +123,7 @@ typedef enum SlotCurrentList
 		printf("slot %p owner from %p set to %p:%d:%s\n",				\
 			   slot_, slot_->owner, owner_, __LINE__,addr_str);			\
 		fflush(stdout);													\
-		slot_->owner = owner_;											\
+		set_slot_owner(slot_, owner_);									\
 	}while(0)
 #define SET_SLOT_LIST(slot_, list_)										\
 	do{																	\
@@ -116,11 +136,11 @@ typedef enum SlotCurrentList
 		printf("slot %p list from %d set to %d:%d:%s\n",				\
 			   slot_, slot_->current_list, list_, __LINE__,addr_str);	\
 		fflush(stdout);													\
-		slot_->current_list = list_;									\
+		set_slot_list(slot_, list_);									\
 	}while(0)
 #else
-#define SET_SLOT_OWNER(slot_, owner_)	(slot_->owner = owner_)
-#define SET_SLOT_LIST(slot_, list_)		(slot_->current_list = list_)
+#define SET_SLOT_OWNER(slot_, owner_)	set_slot_owner(slot_, owner_)
+#define SET_SLOT_LIST(slot_, list_)		set_slot_list(slot_, list_)
 #endif
 
 /* Connection pool entry */
@@ -142,6 +162,11 @@ typedef struct ADBNodePoolSlot
 	int					retry;				/* try to reconnect times, at most three times */
 	uint32				session_magic;		/* sended session params magic number */
 	uint32				local_magic;		/* sended local params magic number */
+	uint32				params_fingerprint;	/* fingerprint of session params applied,
+											 * 0 for none */
+	char				*session_params;	/* session params applied, NULL for none,
+											 * palloc in PoolerMemoryContext */
+	TimestampTz			acquire_time;		/* when agent asked for it */
 	SlotCurrentList		current_list;
 } ADBNodePoolSlot;
 
@@ -162,6 +187,13 @@ typedef struct ADBNodePool
 	char	   *connstr;
 	Size		last_idle;
 	struct DatabasePool *parent;
+	PoolStatEntry *stat;				/* NULL if no free entry */
+	int			slot_count[NULL_SLOT];	/* slots in each list */
+	int			total_slots;			/* slots allocated */
+	int			owned_slots;			/* slots having owner */
+	int			warm_peak[POOL_WARMUP_MAX_WINDOW];	/* most owned_slots of each minute */
+	time_t		warm_minute;			/* minute of latest warm_peak entry */
+	time_t		warm_retry_time;		/* no warm-up connect before it */
 } ADBNodePool;
 
 typedef struct DatabaseInfo
@@ -200,6 +232,7 @@ typedef struct PoolAgent
 	char		   *local_params;
 	uint32			session_magic;	/* magic number for session_params */
 	uint32			local_magic;	/* magic number for local_params */
+	uint32			session_fingerprint;	/* fingerprint of session_params */
 	List		   *list_wait;		/* List of ADBNodePoolSlot in connecting */
 	MemoryContext	mctx;
 	/* Process ID of postmaster child process associated to pool agent */
@@ -212,14 +245,19 @@ struct PoolHandle
 {
 	/* communication channel */
 	PoolPort	port;
+	int			shard;		/* pool manager shard connected to */
 };
 
 /* Configuration options */
 int			MinPoolSize = 1;
 int			MaxPoolSize = 100;
 int			PoolRemoteCmdTimeout = 0;
+int			PoolManagerShards = 1;
+int			PoolWarmupWindow = 10;
 
 bool		PersistentConnections = false;
+bool		PoolMatchSessionParams = true;
+int			PoolMode = POOL_MODE_SESSION;
 
 /* pool time out */
 extern int pool_time_out;
@@ -234,6 +272,9 @@ volatile bool signal_quit = false;
 /* Flag to tell if we are Postgres-XC pooler process */
 static bool am_pgxc_pooler = false;
 
+/* shard served by this pool manager process */
+static int pool_shard = 0;
+
 /* The root memory context */
 static MemoryContext PoolerMemoryContext;
 
@@ -244,6 +285,10 @@ static PoolAgent **poolAgents;
 
 static PoolHandle *poolHandle = NULL;
 
+/* slots reused with or without replaying session params */
+static uint64 params_match_hits = 0;
+static uint64 params_match_misses = 0;
+
 static int	is_pool_locked = false;
 static pgsocket server_fd = PGINVALID_SOCKET;
 static volatile sig_atomic_t got_SIGHUP = false;
@@ -267,6 +312,7 @@ static bool check_slot_status(ADBNodePoolSlot *slot);
 
 static void agent_create(volatile pgsocket new_fd);
 static void agent_release_connections(PoolAgent *agent, bool force_destroy);
+static void agent_idle_released_connections(PoolAgent *agent);
 static void agent_idle_connections(PoolAgent *agent, bool force_destroy);
 static void process_slot_event(ADBNodePoolSlot *slot);
 static void save_slot_error(ADBNodePoolSlot *slot);
@@ -274,14 +320,32 @@ static bool get_slot_result(ADBNodePoolSlot *slot);
 static void agent_acquire_connections(PoolAgent *agent, StringInfo msg);
 static int agent_session_command(PoolAgent *agent, const char *set_command, PoolCommandType command_type, StringInfo errMsg);
 static int send_local_commands(PoolAgent *agent, StringInfo msg);
-
-static void destroy_slot(ADBNodePoolSlot *slot, bool send_cancel);
+static uint32 session_params_fingerprint(const char *params);
+static void count_params_match(PoolAgent *agent, ADBNodePoolSlot *slot, bool match);
+static void set_slot_params(ADBNodePoolSlot *slot, PoolAgent *agent);
+static void reset_slot_params(ADBNodePoolSlot *slot);
+static bool slot_params_match(ADBNodePoolSlot *slot, PoolAgent *agent);
+static bool send_discard_session(ADBNodePoolSlot *slot);
+static void pool_recv_reply(PoolHandle *handle, char msgtype, StringInfo buf);
+
+static void destroy_slot(ADBNodePoolSlot *slot, bool send_cancel, PoolDestroyReason reason);
+static void set_slot_list(ADBNodePoolSlot *slot, SlotCurrentList list);
+static void set_slot_owner(ADBNodePoolSlot *slot, PoolAgent *owner);
+static ADBNodePoolSlot *alloc_uninit_slot(ADBNodePool *node_pool);
+static bool start_slot_connect(ADBNodePoolSlot *slot);
 static void release_slot(ADBNodePoolSlot *slot, bool force_close);
 static void idle_slot(ADBNodePoolSlot *slot, bool reset);
 static void destroy_node_pool(ADBNodePool *node_pool, bool bfree);
 static bool node_pool_in_using(ADBNodePool *node_pool);
 static time_t close_timeout_idle_slots(time_t cur_time);
 static time_t idle_timeout_released_slots(time_t cur_time);
+static int *warm_peak_of_minute(ADBNodePool *node_pool, time_t cur_time);
+static int warm_target(ADBNodePool *node_pool, time_t cur_time);
+static time_t warm_up_node_pools(time_t cur_time);
+static void load_warm_up_file(void);
+static void save_warm_up_file(void);
+static void write_warm_up_string(FILE *fp, const char *str);
+static char *read_warm_up_string(FILE *fp);
 static bool pool_exec_set_query(PGconn *conn, const char *query, StringInfo errMsg);
 static int pool_wait_pq(PGconn *conn);
 static int pq_custom_msg(PGconn *conn, char id, int msgLength);
@@ -298,6 +362,7 @@ static int match_host_info(const void *key1, const void *key2, Size keysize);
 static void create_htab_database(void);
 static void destroy_htab_database(void);
 static DatabasePool *get_database_pool(const char *database, const char *user_name, const char *pgoptions);
+static ADBNodePool *get_node_pool(DatabasePool *db_pool, const HostInfo *info);
 static void destroy_database_pool(DatabasePool *db_pool, bool bfree);
 
 static void pool_end_flush_msg(PoolPort *port, StringInfo buf);
@@ -306,6 +371,13 @@ static const char *pool_getstring(StringInfo buf);
 static void pool_sendint(StringInfo buf, int ival);
 static int pool_getint(StringInfo buf);
 static void on_exit_pooler(int code, Datum arg);
+
+static int pool_shard_of(const char *database, const char *user_name);
+static PoolHandle *get_shard_handle(int shard);
+static void send_connect_msg(PoolHandle *handle, const char *database,
+							 const char *user_name, const char *pgoptions);
+static List *connect_other_shards(void);
+static void close_shard_handles(List *handles);
 /*
  * usage:
  *  HostInfo info;
@@ -422,6 +494,9 @@ PoolManagerInit()
 	/* Allocate pooler structures in the Pooler context */
 	MemoryContextSwitchTo(PoolerMemoryContext);
 
+	/* entries of our last incarnation, if any, are useless now */
+	PoolStatResetShard(pool_shard);
+
 	max_agent_count = (MaxConnections << 1) + max_worker_processes;
 	poolAgents = (PoolAgent **) palloc(max_agent_count * sizeof(PoolAgent *));
 	agentCount = 0;
@@ -432,6 +507,43 @@ PoolManagerInit()
 	proc_exit(1);
 }
 
+/*
+ * Register background workers running the pool manager shards other
+ * than the first one, which is the pooler auxiliary process.
+ */
+void
+RegisterPoolerShards(void)
+{
+	BackgroundWorker	worker;
+	int					shard;
+
+	for (shard = 1; shard < PoolManagerShards; shard++)
+	{
+		MemSet(&worker, 0, sizeof(worker));
+		snprintf(worker.bgw_name, BGW_MAXLEN, "pool manager shard %d", shard);
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+		worker.bgw_restart_time = 1;
+		sprintf(worker.bgw_library_name, "postgres");
+		sprintf(worker.bgw_function_name, "PoolerShardMain");
+		worker.bgw_main_arg = Int32GetDatum(shard);
+		RegisterBackgroundWorker(&worker);
+	}
+}
+
+/*
+ * Main entry of pool manager shard background worker
+ */
+void
+PoolerShardMain(Datum main_arg)
+{
+	pool_shard = DatumGetInt32(main_arg);
+	Assert(pool_shard > 0 && pool_shard < PoolManagerShards);
+
+	PGXCPoolerProcessIam();
+	PoolManagerInit();
+}
+
 static void PoolerLoop(void)
 {
 	MemoryContext volatile context;
@@ -449,11 +561,12 @@ static void PoolerLoop(void)
 	HASH_SEQ_STATUS hseq1,hseq2;
 	sigjmp_buf	local_sigjmp_buf;
 	time_t next_close_idle_time, next_idle_released_time, cur_time;
+	time_t next_warm_up_time, next_save_warm_up_time;
 	StringInfoData input_msg;
 	int rval;
 	pgsocket new_socket;
 
-	server_fd = pool_listen();
+	server_fd = pool_listen(pool_shard);
 	if(server_fd == PGINVALID_SOCKET)
 	{
 		ereport(PANIC, (errcode_for_socket_access(),
@@ -486,6 +599,12 @@ static void PoolerLoop(void)
 	next_close_idle_time = cur_time + pool_time_out;
 	next_idle_released_time = cur_time + pool_release_to_idle_timeout;
 
+	/* pools used before restart, warm_up_node_pools() connect them */
+	if (PoolWarmupWindow > 0)
+		load_warm_up_file();
+	next_warm_up_time = cur_time;
+	next_save_warm_up_time = cur_time + POOL_WARMUP_SAVE_INTERVAL;
+
 	if(sigsetjmp(local_sigjmp_buf, 1) != 0)
 	{
 		/* Cleanup something */
@@ -572,6 +691,7 @@ static void PoolerLoop(void)
 					case SLOT_STATE_QUERY_PARAMS_SESSION:
 					case SLOT_STATE_QUERY_PARAMS_LOCAL:
 					case SLOT_STATE_QUERY_RESET_ALL:
+					case SLOT_STATE_QUERY_DISCARD:
 						rval = POLLIN;
 						break;
 					case SLOT_STATE_ERROR:
@@ -698,6 +818,17 @@ static void PoolerLoop(void)
 		if (pool_release_to_idle_timeout > 0 &&
 			cur_time >= next_idle_released_time)
 			next_idle_released_time = idle_timeout_released_slots(cur_time);
+
+		/* keep pools connected to their learned low-water mark */
+		if (PoolWarmupWindow > 0 && !signal_quit &&
+			cur_time >= next_warm_up_time)
+			next_warm_up_time = warm_up_node_pools(cur_time);
+
+		if (PoolWarmupWindow > 0 && cur_time >= next_save_warm_up_time)
+		{
+			save_warm_up_file();
+			next_save_warm_up_time = cur_time + POOL_WARMUP_SAVE_INTERVAL;
+		}
 	}
 }
 
@@ -723,13 +854,35 @@ PoolManagerDestroy(void)
  * Returned PoolHandle structure will be inherited by session process
  */
 PoolHandle *
-GetPoolManagerHandle(void)
+GetPoolManagerHandle(const char *database, const char *user_name)
+{
+	return get_shard_handle(pool_shard_of(database, user_name));
+}
+
+/*
+ * Sessions are spread to pool manager shards by database and user,
+ * so all sessions of one pool always share the same shard.
+ */
+static int
+pool_shard_of(const char *database, const char *user_name)
+{
+	if (PoolManagerShards <= 1)
+		return 0;
+
+	AssertArg(database && user_name);
+	return (int) (hash_any_v(database, strlen(database),
+							 user_name, strlen(user_name),
+							 NULL) % PoolManagerShards);
+}
+
+static PoolHandle *
+get_shard_handle(int shard)
 {
 	PoolHandle *handle;
 	int			fdsock;
 
 	/* Connect to the pooler */
-	fdsock = pool_connect();
+	fdsock = pool_connect(shard);
 	if (fdsock < 0)
 	{
 		ereport(ERROR,
@@ -746,6 +899,7 @@ GetPoolManagerHandle(void)
 		handle->port.RecvLength = 0;
 		handle->port.RecvPointer = 0;
 		handle->port.SendPointer = 0;
+		handle->shard = shard;
 	}PG_CATCH();
 	{
 		closesocket(fdsock);
@@ -880,12 +1034,20 @@ PoolManagerConnect(PoolHandle *handle,
 	               const char *database, const char *user_name,
 	               const char *pgoptions)
 {
-	StringInfoData buf;
 	AssertArg(handle && database && user_name);
 
 	/* save the handle */
 	poolHandle = handle;
 
+	send_connect_msg(handle, database, user_name, pgoptions);
+}
+
+static void
+send_connect_msg(PoolHandle *handle, const char *database,
+				 const char *user_name, const char *pgoptions)
+{
+	StringInfoData buf;
+
 	pq_beginmessage(&buf, PM_MSG_CONNECT);
 
 	/* PID number */
@@ -905,6 +1067,8 @@ void
 PoolManagerReconnect(void)
 {
 	PoolHandle *handle;
+	char *database;
+	char *user_name;
 	char *options = session_options();
 
 	if (poolHandle)
@@ -912,14 +1076,61 @@ PoolManagerReconnect(void)
 		PoolManagerDisconnect();
 	}
 
-	handle = GetPoolManagerHandle();
-	PoolManagerConnect(handle,
-					   get_database_name(MyDatabaseId),
-					   GetUserNameFromId(GetUserId(), false),
-					   options);
+	database = get_database_name(MyDatabaseId);
+	user_name = GetUserNameFromId(GetUserId(), false);
+	handle = GetPoolManagerHandle(database, user_name);
+	PoolManagerConnect(handle, database, user_name, options);
 	pfree(options);
 }
 
+/*
+ * Connect to all the pool manager shards but the one of this session,
+ * it is used by the commands which must reach every pooled session.
+ */
+static List *
+connect_other_shards(void)
+{
+	PoolHandle *handle;
+	List	   *handles = NIL;
+	char	   *database;
+	char	   *user_name;
+	int			shard;
+
+	Assert(poolHandle);
+	if (PoolManagerShards <= 1)
+		return NIL;
+
+	database = get_database_name(MyDatabaseId);
+	user_name = GetUserNameFromId(GetUserId(), false);
+	PG_TRY();
+	{
+		for (shard = 0; shard < PoolManagerShards; shard++)
+		{
+			if (shard == poolHandle->shard)
+				continue;
+			handle = get_shard_handle(shard);
+			handles = lappend(handles, handle);
+			send_connect_msg(handle, database, user_name, "");
+		}
+	} PG_CATCH();
+	{
+		close_shard_handles(handles);
+		PG_RE_THROW();
+	} PG_END_TRY();
+
+	return handles;
+}
+
+static void
+close_shard_handles(List *handles)
+{
+	ListCell *lc;
+
+	foreach (lc, handles)
+		PoolManagerCloseHandle(lfirst(lc));
+	list_free(handles);
+}
+
 int
 PoolManagerSetCommand(PoolCommandType command_type, const char *set_command)
 {
@@ -1082,6 +1293,7 @@ agent_destroy(PoolAgent *agent)
 				slot->slot_state != SLOT_STATE_QUERY_PARAMS_SESSION	&&
 				slot->slot_state != SLOT_STATE_QUERY_PARAMS_LOCAL &&
 				slot->slot_state != SLOT_STATE_QUERY_RESET_ALL &&
+				slot->slot_state != SLOT_STATE_QUERY_DISCARD &&
 				slot->current_list != NULL_SLOT)
 			{
 				Assert(slot->current_list != NULL_SLOT);
@@ -1207,23 +1419,67 @@ int
 PoolManagerAbortTransactions(char *dbname, char *username, int **proc_pids)
 {
 	StringInfoData buf;
+	PoolHandle *handle;
+	List	   *handles;
+	ListCell   *lc;
+	int		   *shard_pids;
+	int			count;
+	int			shard_count;
 	AssertArg(proc_pids);
 
 	if (!poolHandle)
 		PoolManagerReconnect();
 	Assert(poolHandle);
 
-	pq_beginmessage(&buf, PM_MSG_ABORT_TRANSACTIONS);
+	handles = connect_other_shards();
+	PG_TRY();
+	{
+		pq_beginmessage(&buf, PM_MSG_ABORT_TRANSACTIONS);
 
-	/* send database name */
-	pool_sendstring(&buf, dbname);
+		/* send database name */
+		pool_sendstring(&buf, dbname);
 
-	/* send user name */
-	pool_sendstring(&buf, username);
+		/* send user name */
+		pool_sendstring(&buf, username);
 
-	pool_end_flush_msg(&(poolHandle->port), &buf);
+		/* every shard has its own sessions, ask them all */
+		foreach (lc, handles)
+		{
+			handle = lfirst(lc);
+			if (pool_putmessage(&handle->port, (char)(buf.cursor), buf.data, buf.len) != 0 ||
+				pool_flush(&handle->port) != 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_CONNECTION_FAILURE),
+						 errmsg("failed to send message to pool manager shard %d", handle->shard)));
+		}
+		pool_end_flush_msg(&(poolHandle->port), &buf);
+
+		count = pool_recvpids(&(poolHandle->port), proc_pids);
+		foreach (lc, handles)
+		{
+			handle = lfirst(lc);
+			shard_count = pool_recvpids(&(handle->port), &shard_pids);
+			if (shard_count <= 0)
+				continue;
+			if (count > 0)
+			{
+				*proc_pids = repalloc(*proc_pids, (count + shard_count) * sizeof(int));
+				memcpy(*proc_pids + count, shard_pids, shard_count * sizeof(int));
+				pfree(shard_pids);
+			}else
+			{
+				*proc_pids = shard_pids;
+			}
+			count += shard_count;
+		}
+	} PG_CATCH();
+	{
+		close_shard_handles(handles);
+		PG_RE_THROW();
+	} PG_END_TRY();
+	close_shard_handles(handles);
 
-	return pool_recvpids(&(poolHandle->port), proc_pids);
+	return count;
 }
 
 
@@ -1234,23 +1490,54 @@ PoolManagerAbortTransactions(char *dbname, char *username, int **proc_pids)
 void PoolManagerCleanConnectionOid(List *oidlist, const char *dbname, const char *username)
 {
 	StringInfoData buf;
+	PoolHandle *handle;
+	List	   *handles;
+	ListCell   *lc;
+	bool		completed;
 	if (oidlist == NIL)
 		return;
 
-	pq_beginmessage(&buf, PM_MSG_CLEAN_CONNECT);
+	handles = connect_other_shards();
+	PG_TRY();
+	{
+		pq_beginmessage(&buf, PM_MSG_CLEAN_CONNECT);
 
-	send_host_info(&buf, oidlist);
+		send_host_info(&buf, oidlist);
 
-	/* send database string */
-	pool_sendstring(&buf, dbname);
+		/* send database string */
+		pool_sendstring(&buf, dbname);
 
-	/* send user name */
-	pool_sendstring(&buf, username);
+		/* send user name */
+		pool_sendstring(&buf, username);
 
-	pool_end_flush_msg(&(poolHandle->port), &buf);
+		/* every shard has its own pools, clean them all */
+		foreach (lc, handles)
+		{
+			handle = lfirst(lc);
+			if (pool_putmessage(&handle->port, (char)(buf.cursor), buf.data, buf.len) != 0 ||
+				pool_flush(&handle->port) != 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_CONNECTION_FAILURE),
+						 errmsg("failed to send message to pool manager shard %d", handle->shard)));
+		}
+		pool_end_flush_msg(&(poolHandle->port), &buf);
+
+		/* Receive result message */
+		completed = (pool_recvres(&poolHandle->port) == CLEAN_CONNECTION_COMPLETED);
+		foreach (lc, handles)
+		{
+			handle = lfirst(lc);
+			if (pool_recvres(&handle->port) != CLEAN_CONNECTION_COMPLETED)
+				completed = false;
+		}
+	} PG_CATCH();
+	{
+		close_shard_handles(handles);
+		PG_RE_THROW();
+	} PG_END_TRY();
+	close_shard_handles(handles);
 
-	/* Receive result message */
-	if (pool_recvres(&poolHandle->port) != CLEAN_CONNECTION_COMPLETED)
+	if (!completed)
 		ereport(ERROR,
 				(errcode(ERRCODE_INTERNAL_ERROR),
 				 errmsg("Clean connections not completed")));
@@ -1258,10 +1545,19 @@ void PoolManagerCleanConnectionOid(List *oidlist, const char *dbname, const char
 
 void PoolManagerReleaseConnections(bool force_close)
 {
+	char msgtype;
 	Assert(poolHandle);
-	pool_putmessage(&(poolHandle->port)
-		, force_close ? PM_MSG_CLOSE_CONNECT:PM_MSG_RELEASE_CONNECT
-		, NULL, 0);
+
+	if (force_close)
+		msgtype = PM_MSG_CLOSE_CONNECT;
+	else if (PoolMode == POOL_MODE_TRANSACTION &&
+			 !HaveActiveDatanodeStatements() &&
+			 !LockHeldSession(USER_LOCKMETHOD))
+		msgtype = PM_MSG_IDLE_CONNECT;
+	else
+		msgtype = PM_MSG_RELEASE_CONNECT;
+
+	pool_putmessage(&(poolHandle->port), msgtype, NULL, 0);
 	pool_flush(&(poolHandle->port));
 }
 
@@ -1420,6 +1716,11 @@ static void agent_handle_input(PoolAgent * agent, StringInfo s)
 			pq_getmsgend(s);
 			agent_release_connections(agent, qtype == PM_MSG_CLOSE_CONNECT);
 			break;
+		case PM_MSG_IDLE_CONNECT:
+			err_calback.arg = NULL; /* do not send error if have */
+			pq_getmsgend(s);
+			agent_idle_released_connections(agent);
+			break;
 		case PM_MSG_SET_COMMAND:
 			{
 				StringInfoData msg;
@@ -1441,6 +1742,17 @@ static void agent_handle_input(PoolAgent * agent, StringInfo s)
 				close_idle_connection();
 			}
 			break;
+		case PM_MSG_PARAMS_STATS:
+			{
+				StringInfoData msg;
+				pq_beginmessage(&msg, PM_MSG_PARAMS_STATS);
+				pq_sendint64(&msg, params_match_hits);
+				pq_sendint64(&msg, params_match_misses);
+				pool_putmessage(&agent->port, (char)(msg.cursor), msg.data, msg.len);
+				pool_flush(&agent->port);
+				pfree(msg.data);
+			}
+			break;
 		default:
 			agent_destroy(agent);
 			ereport(WARNING, (errcode(ERRCODE_INTERNAL_ERROR),
@@ -1518,7 +1830,9 @@ static void agent_check_waiting_slot(PoolAgent *agent)
 	 * SLOT_STATE_END_PARAMS_SESSION	-> SLOT_STATE_QUERY_PARAMS_LOCAL
 	 * SLOT_STATE_END_PARAMS_LOCAL		-> SLOT_STATE_QUERY_AGTM_PORT
 	 * SLOT_STATE_END_AGTM_PORT			-> SLOT_STATE_LOCKED
-	 * SLOT_STATE_RELEASED				-> SLOT_STATE_QUERY_RESET_ALL or SLOT_STATE_LOCKED
+	 * SLOT_STATE_END_DISCARD			-> SLOT_STATE_QUERY_PARAMS_LOCAL
+	 * SLOT_STATE_RELEASED				-> SLOT_STATE_QUERY_RESET_ALL, SLOT_STATE_QUERY_DISCARD
+	 *									   or SLOT_STATE_LOCKED
 	 */
 	all_ready = true;
 	PG_TRY();
@@ -1534,6 +1848,20 @@ static void agent_check_waiting_slot(PoolAgent *agent)
 					, "BadState", __FILE__, __LINE__);
 				break;
 			case SLOT_STATE_IDLE:
+				/*
+				 * The slot may still have the session params of its last user,
+				 * no need to replay them when they are the same as ours.
+				 */
+				if (PoolMatchSessionParams && slot_params_match(slot, agent))
+				{
+					count_params_match(agent, slot, true);
+					COPY_PARAMS_MAGIC(slot->session_magic, agent->session_magic);
+					goto send_local_params_;
+				}
+				count_params_match(agent, slot, false);
+				if (slot->params_fingerprint != 0)
+					goto send_reset_all_;
+				/* fall through */
 			case SLOT_STATE_END_RESET_ALL:
 send_session_params_:
 				if(agent->session_params != NULL)
@@ -1545,6 +1873,8 @@ send_session_params_:
 					}
 					slot->slot_state = SLOT_STATE_QUERY_PARAMS_SESSION;
 					COPY_PARAMS_MAGIC(slot->session_magic, agent->session_magic);
+					set_slot_params(slot, agent);
+					PoolStatParamsReplay(slot->parent->stat, false);
 					Assert(slot->current_list != NULL_SLOT);
 					if (slot->current_list != BUSY_SLOT)
 					{
@@ -1558,15 +1888,42 @@ send_session_params_:
 			case SLOT_STATE_LOCKED:
 				continue;
 			case SLOT_STATE_RELEASED:
-				if (slot->last_user_pid != agent->pid)
+				if (slot->last_user_pid != agent->pid &&
+					PoolMatchSessionParams &&
+					slot_params_match(slot, agent))
 				{
+					/*
+					 * released without reset, discard what former owner
+					 * left and keep the session params
+					 */
+					count_params_match(agent, slot, true);
 					slot->last_agtm_port = 0;
+					COPY_PARAMS_MAGIC(slot->session_magic, agent->session_magic);
+					if(!send_discard_session(slot))
+					{
+						save_slot_error(slot);
+						break;
+					}
+					Assert(slot->current_list != NULL_SLOT);
+					if (slot->current_list != BUSY_SLOT)
+					{
+						dlist_delete(&slot->dnode);
+						dlist_push_head(&slot->parent->busy_slot, &slot->dnode);
+						SET_SLOT_LIST(slot, BUSY_SLOT);
+					}
+				}else if (slot->last_user_pid != agent->pid)
+				{
+					count_params_match(agent, slot, false);
+send_reset_all_:
+					slot->last_agtm_port = 0;
+					reset_slot_params(slot);
 					if(!PQsendQuery(slot->conn, "reset all"))
 					{
 						save_slot_error(slot);
 						break;
 					}
 					slot->slot_state = SLOT_STATE_QUERY_RESET_ALL;
+					PoolStatParamsReplay(slot->parent->stat, true);
 					Assert(slot->current_list != NULL_SLOT);
 					if (slot->current_list != BUSY_SLOT)
 					{
@@ -1593,6 +1950,7 @@ send_session_params_:
 				slot->slot_state = SLOT_STATE_LOCKED;
 				break;
 			case SLOT_STATE_END_PARAMS_SESSION:
+			case SLOT_STATE_END_DISCARD:
 send_local_params_:
 				if(agent->local_params)
 				{
@@ -1650,13 +2008,17 @@ send_agtm_port_:
 					{
 						PQfinish(slot->conn);
 						slot->conn = PQconnectStart(node_pool->connstr);
+						PoolStatConnect(node_pool->stat, false);
 
 						if(slot->conn == NULL)
 						{
 							ereport(ERROR,
 								(errcode(ERRCODE_OUT_OF_MEMORY)
 								,errmsg("out of memory")));
-						}else if(PQstatus(slot->conn) != CONNECTION_BAD)
+						}else if(PQstatus(slot->conn) == CONNECTION_BAD)
+						{
+							PoolStatConnect(node_pool->stat, true);
+						}else
 						{
 							slot->slot_state = SLOT_STATE_CONNECTING;
 							slot->poll_state = PGRES_POLLING_WRITING;
@@ -1688,9 +2050,15 @@ send_agtm_port_:
 				all_ready = false;
 			}else if(slot->slot_state == SLOT_STATE_LOCKED)
 			{
+				long	secs;
+				int		usecs;
+
 				Assert(slot->current_list != NULL_SLOT);
 				dlist_delete(&slot->dnode);
 				SET_SLOT_LIST(slot, NULL_SLOT);
+
+				TimestampDifference(slot->acquire_time, GetCurrentTimestamp(), &secs, &usecs);
+				PoolStatAcquire(slot->parent->stat, secs * 1000000L + usecs);
 			}
 		}
 	}PG_CATCH();
@@ -1706,6 +2074,7 @@ send_agtm_port_:
 				slot->slot_state != SLOT_STATE_QUERY_PARAMS_SESSION	&&
 				slot->slot_state != SLOT_STATE_QUERY_PARAMS_LOCAL &&
 				slot->slot_state != SLOT_STATE_QUERY_RESET_ALL &&
+				slot->slot_state != SLOT_STATE_QUERY_DISCARD &&
 				slot->current_list != NULL_SLOT)
 			{
 				/*
@@ -1998,7 +2367,7 @@ recheck_slot_status_:
 end_check_slot_status_:
 	if(status_error)
 	{
-		destroy_slot(slot, false);
+		destroy_slot(slot, false, POOL_DESTROY_BROKEN);
 		return false;
 	}
 	return true;
@@ -2039,7 +2408,7 @@ send_local_commands(PoolAgent *agent, StringInfo msg)
 
 /*------------------------------------------------*/
 
-static void destroy_slot(ADBNodePoolSlot *slot, bool send_cancel)
+static void destroy_slot(ADBNodePoolSlot *slot, bool send_cancel, PoolDestroyReason reason)
 {
 	AssertArg(slot);
 
@@ -2064,6 +2433,7 @@ static void destroy_slot(ADBNodePoolSlot *slot, bool send_cancel)
 			PQrequestCancel(slot->conn);
 		PQfinish(slot->conn);
 		slot->conn = NULL;
+		PoolStatDestroy(slot->parent->stat, reason);
 	}
 	SET_SLOT_OWNER(slot, NULL);
 	slot->last_user_pid = 0;
@@ -2082,12 +2452,103 @@ static void destroy_slot(ADBNodePoolSlot *slot, bool send_cancel)
 	check_all_slot_list();
 }
 
+/* move slot to another list, keep slot counts of node pool */
+static void set_slot_list(ADBNodePoolSlot *slot, SlotCurrentList list)
+{
+	ADBNodePool *node_pool = slot->parent;
+
+	if (slot->current_list != NULL_SLOT)
+		--(node_pool->slot_count[slot->current_list]);
+	if (list != NULL_SLOT)
+		++(node_pool->slot_count[list]);
+	slot->current_list = list;
+
+	PoolStatSlots(node_pool->stat,
+				  node_pool->slot_count[UNINIT_SLOT],
+				  node_pool->slot_count[IDLE_SLOT],
+				  node_pool->slot_count[BUSY_SLOT],
+				  node_pool->slot_count[RELEASED_SLOT]);
+}
+
+/* change owner of slot, keep owned slot count and its peak of node pool */
+static void set_slot_owner(ADBNodePoolSlot *slot, PoolAgent *owner)
+{
+	ADBNodePool *node_pool = slot->parent;
+	int *peak;
+
+	if (slot->owner == NULL && owner != NULL)
+	{
+		++(node_pool->owned_slots);
+		peak = warm_peak_of_minute(node_pool, time(NULL));
+		if (*peak < node_pool->owned_slots)
+			*peak = node_pool->owned_slots;
+	}else if (slot->owner != NULL && owner == NULL)
+	{
+		--(node_pool->owned_slots);
+	}
+	slot->owner = owner;
+}
+
+/* alloc a new slot in uninit list of node_pool */
+static ADBNodePoolSlot *alloc_uninit_slot(ADBNodePool *node_pool)
+{
+	ADBNodePoolSlot *slot;
+
+	slot = MemoryContextAllocZero(PoolerMemoryContext, sizeof(*slot));
+	slot->parent = node_pool;
+	slot->current_list = NULL_SLOT;
+	slot->slot_state = SLOT_STATE_UNINIT;
+	INIT_SLOT_PARAMS_MAGIC(slot, session_magic);
+	INIT_SLOT_PARAMS_MAGIC(slot, local_magic);
+	slot->params_fingerprint = 0;
+	dlist_push_head(&node_pool->uninit_slot, &slot->dnode);
+	SET_SLOT_LIST(slot, UNINIT_SLOT);
+	++(node_pool->total_slots);
+
+	return slot;
+}
+
+/*
+ * begin connect uninit slot to remote, return false if failed
+ * immediately, error message is in slot->conn then
+ */
+static bool start_slot_connect(ADBNodePoolSlot *slot)
+{
+	static PGcustumFuns funs = {NULL, NULL, NULL, pq_custom_msg};
+	ADBNodePool *node_pool = slot->parent;
+
+	Assert(slot->slot_state == SLOT_STATE_UNINIT);
+	Assert(node_pool->connstr != NULL);
+	slot->conn = PQconnectStart(node_pool->connstr);
+	PoolStatConnect(node_pool->stat, false);
+	if(slot->conn == NULL)
+	{
+		ereport(ERROR,
+			(errcode(ERRCODE_OUT_OF_MEMORY)
+			,errmsg("out of memory")));
+	}else if(PQstatus(slot->conn) == CONNECTION_BAD)
+	{
+		PoolStatConnect(node_pool->stat, true);
+		return false;
+	}
+	slot->slot_state = SLOT_STATE_CONNECTING;
+	slot->poll_state = PGRES_POLLING_WRITING;
+	slot->conn->funs = &funs;
+	slot->retry = 0;
+	/* new session has no params */
+	INIT_SLOT_PARAMS_MAGIC(slot, session_magic);
+	INIT_SLOT_PARAMS_MAGIC(slot, local_magic);
+	reset_slot_params(slot);
+
+	return true;
+}
+
 static void release_slot(ADBNodePoolSlot *slot, bool force_close)
 {
 	AssertArg(slot);
 	if(force_close)
 	{
-		destroy_slot(slot, false);
+		destroy_slot(slot, false, POOL_DESTROY_CLOSE);
 	}else if(check_slot_status(slot) != false)
 	{
 		if (pool_release_to_idle_timeout == 0)
@@ -2116,11 +2577,17 @@ static void idle_slot(ADBNodePoolSlot *slot, bool reset)
 
 	if(slot->slot_state == SLOT_STATE_CONNECTING)
 	{
+		/* process_slot_event() moves it to idle list when connected */
+		if (slot->current_list == NULL_SLOT)
+		{
+			dlist_push_head(&slot->parent->busy_slot, &slot->dnode);
+			SET_SLOT_LIST(slot, BUSY_SLOT);
+		}
 		return;
 	}
 	else if(slot->has_temp)
 	{
-		destroy_slot(slot, false);
+		destroy_slot(slot, false, POOL_DESTROY_TEMP);
 	}
 	else if(reset)
 	{
@@ -2130,17 +2597,37 @@ static void idle_slot(ADBNodePoolSlot *slot, bool reset)
 			case SLOT_STATE_QUERY_PARAMS_SESSION:
 			case SLOT_STATE_QUERY_PARAMS_LOCAL:
 			case SLOT_STATE_QUERY_RESET_ALL:
+			case SLOT_STATE_QUERY_DISCARD:
 				return;
 			default:
 				break;
 		}
-		/*  SLOT_STATE_ERROR  state will be destory */
-		if(!PQsendQuery(slot->conn, "reset all"))
+		if (PoolMatchSessionParams)
 		{
-			destroy_slot(slot, false);
-			return;
+			/*
+			 * Keep session params of the slot, the next user having the
+			 * same fingerprint can use it directly, others "reset all"
+			 * before using it. Discard other session state now, then
+			 * let remote close agtm.
+			 */
+			slot->last_agtm_port = 0;
+			if(!send_discard_session(slot))
+			{
+				destroy_slot(slot, false, POOL_DESTROY_BROKEN);
+				return;
+			}
+		}else
+		{
+			/*  SLOT_STATE_ERROR  state will be destory */
+			reset_slot_params(slot);
+			if(!PQsendQuery(slot->conn, "reset all"))
+			{
+				destroy_slot(slot, false, POOL_DESTROY_BROKEN);
+				return;
+			}
+			slot->slot_state = SLOT_STATE_QUERY_RESET_ALL;
+			PoolStatParamsReplay(slot->parent->stat, true);
 		}
-		slot->slot_state = SLOT_STATE_QUERY_RESET_ALL;
 		Assert(slot->current_list == NULL_SLOT);
 		dlist_push_head(&slot->parent->busy_slot, &slot->dnode);
 		SET_SLOT_LIST(slot, BUSY_SLOT);
@@ -2175,11 +2662,15 @@ static void destroy_node_pool(ADBNodePool *node_pool, bool bfree)
 		{
 			node = dlist_pop_head_node(dheads[i]);
 			slot = dlist_container(ADBNodePoolSlot, dnode, node);
+			SET_SLOT_OWNER(slot, NULL);
+			--(node_pool->total_slots);
+			SET_SLOT_LIST(slot, NULL_SLOT);
 			if(slot->last_error)
 			{
 				pfree(slot->last_error);
 				slot->last_error = NULL;
 			}
+			reset_slot_params(slot);
 			PQfinish(slot->conn);
 			pfree(slot);
 			slot = NULL;
@@ -2194,6 +2685,8 @@ static void destroy_node_pool(ADBNodePool *node_pool, bool bfree)
 			pfree(node_pool->connstr);
 			node_pool->connstr = NULL;
 		}
+		PoolStatFree(node_pool->stat);
+		node_pool->stat = NULL;
 		hash_search(node_pool->parent->htab_nodes, &node_pool->hostinfo, HASH_REMOVE, NULL);
 	}
 }
@@ -2245,6 +2738,8 @@ static time_t close_timeout_idle_slots(time_t cur_time)
 	dlist_mutable_iter miter;
 	time_t earliest_time = cur_time;
 	time_t need_close_time = cur_time - pool_time_out;
+	time_t now = time(NULL);
+	int target,connected;
 
 	hash_seq_init(&hash_database_stats, htab_database);
 	while((db_pool = hash_seq_search(&hash_database_stats)) != NULL)
@@ -2252,16 +2747,23 @@ static time_t close_timeout_idle_slots(time_t cur_time)
 		hash_seq_init(&hash_nodepool_status, db_pool->htab_nodes);
 		while((node_pool = hash_seq_search(&hash_nodepool_status)) != NULL)
 		{
+			/* don't close slots warm_up_node_pools() would connect again */
+			target = warm_target(node_pool, now);
+			connected = node_pool->total_slots - node_pool->slot_count[UNINIT_SLOT];
 			dlist_foreach_modify(miter, &node_pool->idle_slot)
 			{
 				slot = dlist_container(ADBNodePoolSlot, dnode, miter.cur);
 				Assert(slot->slot_state == SLOT_STATE_IDLE);
-				if(slot->released_time <= need_close_time)
+				if(slot->released_time <= need_close_time && connected <= target)
+				{
+					slot->released_time = now;
+				}else if(slot->released_time <= need_close_time)
 				{
 					Assert(slot->current_list != NULL_SLOT);
 					dlist_delete(miter.cur);
 					SET_SLOT_LIST(slot, NULL_SLOT);
-					destroy_slot(slot, false);
+					destroy_slot(slot, false, POOL_DESTROY_TIMEOUT);
+					--connected;
 				}else if(earliest_time > slot->released_time)
 				{
 					earliest_time = slot->released_time;
@@ -2313,6 +2815,297 @@ static time_t idle_timeout_released_slots(time_t cur_time)
 	return earliest_time+pool_release_to_idle_timeout;
 }
 
+/*
+ * Return peak entry of owned slots for minute of cur_time, entries of
+ * minutes passed since last call are initialized by current owned slots.
+ */
+static int *warm_peak_of_minute(ADBNodePool *node_pool, time_t cur_time)
+{
+	time_t minute = cur_time / 60;
+	time_t m;
+
+	if (minute != node_pool->warm_minute)
+	{
+		if (minute < node_pool->warm_minute ||
+			minute - node_pool->warm_minute >= POOL_WARMUP_MAX_WINDOW)
+		{
+			for (m = 0; m < POOL_WARMUP_MAX_WINDOW; ++m)
+				node_pool->warm_peak[m] = 0;
+		}else
+		{
+			for (m = node_pool->warm_minute + 1; m < minute; ++m)
+				node_pool->warm_peak[m % POOL_WARMUP_MAX_WINDOW] = node_pool->owned_slots;
+		}
+		node_pool->warm_minute = minute;
+		node_pool->warm_peak[minute % POOL_WARMUP_MAX_WINDOW] = node_pool->owned_slots;
+	}
+
+	return &node_pool->warm_peak[minute % POOL_WARMUP_MAX_WINDOW];
+}
+
+/*
+ * Learned low-water mark of connected slots: the most slots agents owned
+ * at once in last pool_warmup_window minutes, 0 for not used pool.
+ */
+static int warm_target(ADBNodePool *node_pool, time_t cur_time)
+{
+	time_t minute;
+	int i,window,peak;
+
+	if (PoolWarmupWindow <= 0)
+		return 0;
+
+	(void)warm_peak_of_minute(node_pool, cur_time);
+	minute = node_pool->warm_minute;
+	window = Min(PoolWarmupWindow, POOL_WARMUP_MAX_WINDOW);
+	peak = 0;
+	for (i = 0; i < window; ++i)
+		peak = Max(peak, node_pool->warm_peak[(minute - i) % POOL_WARMUP_MAX_WINDOW]);
+
+	if (peak == 0)
+		return 0;
+	return Min(Max(peak, MinPoolSize), MaxPoolSize);
+}
+
+/*
+ * Begin connect slots of node pools having less connected slots than
+ * warm_target(), so agents find idle slots instead of connecting remote.
+ * return best next call time
+ */
+static time_t warm_up_node_pools(time_t cur_time)
+{
+	HASH_SEQ_STATUS hash_database_stats;
+	HASH_SEQ_STATUS hash_nodepool_status;
+	DatabasePool *db_pool;
+	ADBNodePool *node_pool;
+	ADBNodePoolSlot *slot;
+	dlist_iter iter;
+	int target,connected,n;
+
+	hash_seq_init(&hash_database_stats, htab_database);
+	while((db_pool = hash_seq_search(&hash_database_stats)) != NULL)
+	{
+		hash_seq_init(&hash_nodepool_status, db_pool->htab_nodes);
+		while((node_pool = hash_seq_search(&hash_nodepool_status)) != NULL)
+		{
+			if (cur_time < node_pool->warm_retry_time)
+				continue;
+
+			target = warm_target(node_pool, cur_time);
+			connected = node_pool->total_slots - node_pool->slot_count[UNINIT_SLOT];
+			for (n = 0; connected < target && n < POOL_WARMUP_CONNECT_STEP; ++n, ++connected)
+			{
+				slot = NULL;
+				dlist_foreach(iter, &node_pool->uninit_slot)
+				{
+					slot = dlist_container(ADBNodePoolSlot, dnode, iter.cur);
+					AssertState(slot->slot_state == SLOT_STATE_UNINIT);
+					if (slot->owner == NULL)
+						break;
+					slot = NULL;
+				}
+				if (slot == NULL)
+					slot = alloc_uninit_slot(node_pool);
+
+				if (!start_slot_connect(slot))
+				{
+					ereport(LOG,
+							(errmsg("pool manager could not warm up connection to %s:%d: %s",
+									node_pool->hostinfo.hostname,
+									node_pool->hostinfo.port,
+									PQerrorMessage(slot->conn))));
+					PQfinish(slot->conn);
+					slot->conn = NULL;
+					node_pool->warm_retry_time = cur_time + POOL_WARMUP_RETRY_INTERVAL;
+					break;
+				}
+
+				/* nobody owns it, process_slot_event() moves it to idle list */
+				Assert(slot->current_list != NULL_SLOT);
+				dlist_delete(&slot->dnode);
+				dlist_push_head(&node_pool->busy_slot, &slot->dnode);
+				SET_SLOT_LIST(slot, BUSY_SLOT);
+			}
+		}
+	}
+
+	return cur_time + 1;
+}
+
+static void write_warm_up_string(FILE *fp, const char *str)
+{
+	int32 len = strlen(str);
+
+	fwrite(&len, sizeof(len), 1, fp);
+	fwrite(str, 1, len, fp);
+}
+
+/* return NULL if file is broken */
+static char *read_warm_up_string(FILE *fp)
+{
+	int32 len;
+	char *str;
+
+	if (fread(&len, sizeof(len), 1, fp) != 1 ||
+		len < 0 || len >= MAXPGPATH * 4)
+		return NULL;
+
+	str = palloc(len + 1);
+	if (fread(str, 1, len, fp) != (size_t) len)
+	{
+		pfree(str);
+		return NULL;
+	}
+	str[len] = '\0';
+
+	return str;
+}
+
+/*
+ * Save node pools having low-water mark, the pool manager of next start
+ * connects them at once, see load_warm_up_file().
+ */
+static void save_warm_up_file(void)
+{
+	HASH_SEQ_STATUS hash_database_stats;
+	HASH_SEQ_STATUS hash_nodepool_status;
+	DatabasePool *db_pool;
+	ADBNodePool *node_pool;
+	FILE *fp;
+	char path[MAXPGPATH];
+	char tmppath[MAXPGPATH];
+	time_t cur_time;
+	int32 ival;
+
+	if (htab_database == NULL)
+		return;
+
+	snprintf(path, sizeof(path), "%s.%d", POOL_WARMUP_FILE, pool_shard);
+	snprintf(tmppath, sizeof(tmppath), "%s.%d.tmp", POOL_WARMUP_FILE, pool_shard);
+	fp = AllocateFile(tmppath, PG_BINARY_W);
+	if (fp == NULL)
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m", tmppath)));
+		return;
+	}
+
+	ival = POOL_WARMUP_FILE_MAGIC;
+	fwrite(&ival, sizeof(ival), 1, fp);
+
+	cur_time = time(NULL);
+	hash_seq_init(&hash_database_stats, htab_database);
+	while((db_pool = hash_seq_search(&hash_database_stats)) != NULL)
+	{
+		hash_seq_init(&hash_nodepool_status, db_pool->htab_nodes);
+		while((node_pool = hash_seq_search(&hash_nodepool_status)) != NULL)
+		{
+			ival = warm_target(node_pool, cur_time);
+			if (ival == 0)
+				continue;
+			fwrite(&ival, sizeof(ival), 1, fp);
+			ival = node_pool->hostinfo.port;
+			fwrite(&ival, sizeof(ival), 1, fp);
+			write_warm_up_string(fp, db_pool->db_info.database);
+			write_warm_up_string(fp, db_pool->db_info.user_name);
+			write_warm_up_string(fp, db_pool->db_info.pgoptions);
+			write_warm_up_string(fp, node_pool->hostinfo.hostname);
+		}
+	}
+
+	if (ferror(fp))
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not write file \"%s\": %m", tmppath)));
+		FreeFile(fp);
+		unlink(tmppath);
+	}else if (FreeFile(fp))
+	{
+		ereport(LOG,
+				(errcode_for_file_access(),
+				 errmsg("could not close file \"%s\": %m", tmppath)));
+		unlink(tmppath);
+	}else
+	{
+		(void)durable_rename(tmppath, path, LOG);
+	}
+}
+
+/*
+ * Create node pools saved by last pool manager with their low-water mark,
+ * warm_up_node_pools() connects them. Pools of other shards are ignored,
+ * they show up only when pool_manager_shards changed.
+ */
+static void load_warm_up_file(void)
+{
+	DatabasePool *db_pool;
+	ADBNodePool *node_pool;
+	HostInfo info;
+	FILE *fp;
+	char path[MAXPGPATH];
+	char *database,*user_name,*pgoptions;
+	time_t cur_time;
+	int32 target,port;
+	int *peak;
+
+	snprintf(path, sizeof(path), "%s.%d", POOL_WARMUP_FILE, pool_shard);
+	fp = AllocateFile(path, PG_BINARY_R);
+	if (fp == NULL)
+	{
+		if (errno != ENOENT)
+			ereport(LOG,
+					(errcode_for_file_access(),
+					 errmsg("could not open file \"%s\": %m", path)));
+		return;
+	}
+
+	if (fread(&target, sizeof(target), 1, fp) != 1 ||
+		target != POOL_WARMUP_FILE_MAGIC)
+	{
+		ereport(LOG,
+				(errmsg("ignore invalid pool warm-up file \"%s\"", path)));
+		FreeFile(fp);
+		return;
+	}
+
+	cur_time = time(NULL);
+	while (fread(&target, sizeof(target), 1, fp) == 1)
+	{
+		database = user_name = pgoptions = info.hostname = NULL;
+		if (fread(&port, sizeof(port), 1, fp) != 1 ||
+			(database = read_warm_up_string(fp)) == NULL ||
+			(user_name = read_warm_up_string(fp)) == NULL ||
+			(pgoptions = read_warm_up_string(fp)) == NULL ||
+			(info.hostname = read_warm_up_string(fp)) == NULL)
+		{
+			ereport(LOG,
+					(errmsg("pool warm-up file \"%s\" is truncated", path)));
+			PFREE_SAFE(database);
+			PFREE_SAFE(user_name);
+			PFREE_SAFE(pgoptions);
+			break;
+		}
+		info.port = (uint16)port;
+
+		if (target > 0 && pool_shard_of(database, user_name) == pool_shard)
+		{
+			db_pool = get_database_pool(database, user_name, pgoptions);
+			node_pool = get_node_pool(db_pool, &info);
+			peak = warm_peak_of_minute(node_pool, cur_time);
+			*peak = Max(*peak, target);
+		}
+
+		pfree(database);
+		pfree(user_name);
+		pfree(pgoptions);
+		pfree(info.hostname);
+	}
+
+	FreeFile(fp);
+}
+
 /* find pool, if not exist create a new */
 static DatabasePool *get_database_pool(const char *database, const char *user_name, const char *pgoptions)
 {
@@ -2364,6 +3157,63 @@ static DatabasePool *get_database_pool(const char *database, const char *user_na
 	return dbpool;
 }
 
+/* find node pool of db_pool, if not exist create a new */
+static ADBNodePool *get_node_pool(DatabasePool *db_pool, const HostInfo *info)
+{
+	ADBNodePool *node_pool;
+	MemoryContext old_context;
+	bool found;
+
+	node_pool = hash_search(db_pool->htab_nodes, info, HASH_ENTER, &found);
+	if (!found)
+	{
+		PG_TRY();
+		{
+			node_pool->parent = db_pool;
+			old_context = MemoryContextSwitchTo(TopMemoryContext);
+			node_pool->hostinfo.hostname = pstrdup(info->hostname);
+			node_pool->hostinfo.port = info->port;
+			node_pool->connstr = PGXCNodeConnStr(info->hostname,
+												 info->port,
+												 db_pool->db_info.database,
+												 db_pool->db_info.user_name,
+												 db_pool->db_info.pgoptions,
+												 "coordinator");
+			MemoryContextSwitchTo(old_context);
+		}PG_CATCH();
+		{
+			node_pool = hash_search(db_pool->htab_nodes, info, HASH_REMOVE, NULL);
+			if (node_pool)
+			{
+				if (node_pool->connstr)
+					pfree(node_pool->connstr);
+				if (node_pool->hostinfo.hostname != info->hostname)
+					pfree(node_pool->hostinfo.hostname);
+			}
+			PG_RE_THROW();
+		}PG_END_TRY();
+		node_pool->last_idle = 0;
+		dlist_init(&node_pool->uninit_slot);
+		dlist_init(&node_pool->released_slot);
+		dlist_init(&node_pool->idle_slot);
+		dlist_init(&node_pool->busy_slot);
+		MemSet(node_pool->slot_count, 0, sizeof(node_pool->slot_count));
+		node_pool->total_slots = 0;
+		node_pool->owned_slots = 0;
+		MemSet(node_pool->warm_peak, 0, sizeof(node_pool->warm_peak));
+		node_pool->warm_minute = 0;
+		node_pool->warm_retry_time = 0;
+		node_pool->stat = PoolStatAlloc(pool_shard,
+										db_pool->db_info.database,
+										db_pool->db_info.user_name,
+										info->hostname,
+										info->port);
+	}
+	Assert(match_host_info(info, &node_pool->hostinfo, sizeof(*info)) == 0);
+
+	return node_pool;
+}
+
 static void destroy_database_pool(DatabasePool *db_pool, bool bfree)
 {
 	DatabaseInfo info;
@@ -2422,6 +3272,45 @@ static void agent_release_connections(PoolAgent *agent, bool force_destroy)
 	}
 }
 
+/*
+ * Transaction pooling, give agent's slots to idle list at once so
+ * other sessions can use them. Session params are replayed next time
+ * we get a slot. Temporary objects are only in the slots they were
+ * created, keep them for us.
+ */
+static void agent_idle_released_connections(PoolAgent *agent)
+{
+	ADBNodePoolSlot *slot;
+	ConnectedInfo *info;
+	HASH_SEQ_STATUS hseq;
+	AssertArg(agent);
+
+	if (agent->is_temp || cluster_ex_lock_held)
+	{
+		agent_release_connections(agent, false);
+		return;
+	}
+
+	hash_seq_init(&hseq, agent->connected_node);
+	while ((info=hash_seq_search(&hseq)) != NULL)
+	{
+		slot = info->slot;
+		if (list_member_ptr(agent->list_wait, slot))
+			continue;
+		Assert(slot->slot_state == SLOT_STATE_LOCKED
+			&& slot->owner == agent
+			&& slot->last_user_pid == agent->pid);
+
+		hash_search(agent->connected_node, &info->info, HASH_REMOVE, NULL);
+		pfree(info->info.hostname);
+		info->info.hostname = NULL;
+		if (check_slot_status(slot))
+			idle_slot(slot, true);
+	}
+
+	check_all_slot_list();
+}
+
 /* set agent's all slots to idle, include reset */
 static void agent_idle_connections(PoolAgent *agent, bool force_destroy)
 {
@@ -2466,19 +3355,39 @@ static void process_slot_event(ADBNodePoolSlot *slot)
 	case SLOT_STATE_END_PARAMS_SESSION:
 	case SLOT_STATE_END_PARAMS_LOCAL:
 	case SLOT_STATE_END_RESET_ALL:
+	case SLOT_STATE_END_DISCARD:
 		break;
 	case SLOT_STATE_CONNECTING:
 		slot->poll_state = PQconnectPoll(slot->conn);
 		switch(slot->poll_state)
 		{
 		case PGRES_POLLING_FAILED:
+			PoolStatConnect(slot->parent->stat, true);
 			save_slot_error(slot);
+			if(slot->owner == NULL)
+			{
+				/* warm-up slot or agent gone, nobody waits for it */
+				Assert(slot->current_list != NULL_SLOT);
+				dlist_delete(&slot->dnode);
+				SET_SLOT_LIST(slot, NULL_SLOT);
+				destroy_slot(slot, false, POOL_DESTROY_BROKEN);
+				slot->parent->warm_retry_time = time(NULL) + POOL_WARMUP_RETRY_INTERVAL;
+			}
 			break;
 		case PGRES_POLLING_READING:
 		case PGRES_POLLING_WRITING:
 			break;
 		case PGRES_POLLING_OK:
 			slot->slot_state = SLOT_STATE_IDLE;
+			if(slot->owner == NULL)
+			{
+				Assert(slot->current_list != NULL_SLOT);
+				slot->last_agtm_port = 0;
+				slot->released_time = time(NULL);
+				dlist_delete(&slot->dnode);
+				dlist_push_head(&slot->parent->idle_slot, &slot->dnode);
+				SET_SLOT_LIST(slot, IDLE_SLOT);
+			}
 			break;
 		default:
 			break;
@@ -2492,13 +3401,14 @@ static void process_slot_event(ADBNodePoolSlot *slot)
 				Assert(slot->current_list != NULL_SLOT);
 				dlist_delete(&slot->dnode);
 				SET_SLOT_LIST(slot, NULL_SLOT);
-				destroy_slot(slot, false);
+				destroy_slot(slot, false, POOL_DESTROY_ERROR);
 			}
 		break;
 	case SLOT_STATE_QUERY_AGTM_PORT:
 	case SLOT_STATE_QUERY_PARAMS_SESSION:
 	case SLOT_STATE_QUERY_PARAMS_LOCAL:
 	case SLOT_STATE_QUERY_RESET_ALL:
+	case SLOT_STATE_QUERY_DISCARD:
 		if(get_slot_result(slot) == false)
 		{
 			if(slot->slot_state == SLOT_STATE_ERROR)
@@ -2508,7 +3418,7 @@ static void process_slot_event(ADBNodePoolSlot *slot)
 					Assert(slot->current_list != NULL_SLOT);
 					dlist_delete(&slot->dnode);
 					SET_SLOT_LIST(slot, NULL_SLOT);
-					destroy_slot(slot, false);
+					destroy_slot(slot, false, POOL_DESTROY_ERROR);
 				}
 				break;
 			}
@@ -2518,11 +3428,13 @@ static void process_slot_event(ADBNodePoolSlot *slot)
 			{
 				INIT_SLOT_PARAMS_MAGIC(slot, session_magic);
 				INIT_SLOT_PARAMS_MAGIC(slot, local_magic);
+				reset_slot_params(slot);
 			}
 
 			if(slot->owner == NULL)
 			{
-				if(slot->slot_state == SLOT_STATE_END_RESET_ALL)
+				if(slot->slot_state == SLOT_STATE_END_RESET_ALL ||
+				   slot->slot_state == SLOT_STATE_END_DISCARD)
 				{
 					/* let remote close agtm */
 					slot->last_agtm_port = 0;
@@ -2624,7 +3536,6 @@ static void agent_acquire_connections(PoolAgent *agent, StringInfo msg)
 	count = pool_getint(msg);
 	PG_TRY();
 	{
-		bool found;
 		if (agent->db_pool == NULL)
 			ereport(ERROR, (errmsg("no database info")));
 
@@ -2635,41 +3546,7 @@ static void agent_acquire_connections(PoolAgent *agent, StringInfo msg)
 			if (hash_search(agent->connected_node, &info, HASH_FIND, NULL) != NULL)
 				ereport(ERROR, (errmsg("double get node connect for %s:%d", info.hostname, info.port)));
 
-			node_pool = hash_search(agent->db_pool->htab_nodes, &info, HASH_ENTER, &found);
-			if (!found)
-			{
-				PG_TRY();
-				{
-					node_pool->parent = agent->db_pool;
-					old_context = MemoryContextSwitchTo(TopMemoryContext);
-					node_pool->hostinfo.hostname = pstrdup(info.hostname);
-					node_pool->hostinfo.port = info.port;
-					node_pool->connstr = PGXCNodeConnStr(info.hostname,
-														 info.port,
-														 node_pool->parent->db_info.database,
-														 node_pool->parent->db_info.user_name,
-														 node_pool->parent->db_info.pgoptions,
-														 "coordinator");
-					MemoryContextSwitchTo(old_context);
-				}PG_CATCH();
-				{
-					node_pool = hash_search(agent->db_pool->htab_nodes, &info, HASH_REMOVE, NULL);
-					if (node_pool)
-					{
-						if (node_pool->connstr)
-							pfree(node_pool->connstr);
-						if (node_pool->hostinfo.hostname != info.hostname)
-							pfree(node_pool->hostinfo.hostname);
-					}
-					PG_RE_THROW();
-				}PG_END_TRY();
-				node_pool->last_idle = 0;
-				dlist_init(&node_pool->uninit_slot);
-				dlist_init(&node_pool->released_slot);
-				dlist_init(&node_pool->idle_slot);
-				dlist_init(&node_pool->busy_slot);
-			}
-			Assert(match_host_info(&info, &node_pool->hostinfo, sizeof(info)) == 0);
+			node_pool = get_node_pool(agent->db_pool, &info);
 
 			/*
 			* we append NULL value to list_wait first
@@ -2695,22 +3572,28 @@ static void agent_acquire_connections(PoolAgent *agent, StringInfo msg)
 				}
 			}
 
-			/* second find idle slot */
+			/*
+			 * second find idle slot, prefer the one already has
+			 * same session params
+			 */
 			if(slot == NULL)
 			{
 				dlist_foreach(iter, &node_pool->idle_slot)
 				{
 					tmp_slot = dlist_container(ADBNodePoolSlot, dnode, iter.cur);
 					AssertState(tmp_slot->slot_state == SLOT_STATE_IDLE);
-					if(tmp_slot->owner == NULL)
-					{
+					if(tmp_slot->owner != NULL)
+						continue;
+					if(slot == NULL ||
+					   slot_params_match(tmp_slot, agent))
 						slot = tmp_slot;
-						ereport(DEBUG1,
-						(errmsg("[pool] get slot from idle_slot, backend pid : %d,",
-						agent->pid)));
+					if(slot_params_match(slot, agent))
 						break;
-					}
 				}
+				if(slot != NULL)
+					ereport(DEBUG1,
+						(errmsg("[pool] get slot from idle_slot, backend pid : %d,",
+						agent->pid)));
 			}
 
 			/* not found, we use a uninit slot */
@@ -2734,13 +3617,7 @@ static void agent_acquire_connections(PoolAgent *agent, StringInfo msg)
 			/* not got any slot, we alloc a new slot */
 			if(slot == NULL)
 			{
-				slot = MemoryContextAllocZero(PoolerMemoryContext, sizeof(*slot));
-				slot->parent = node_pool;
-				slot->slot_state = SLOT_STATE_UNINIT;
-				INIT_SLOT_PARAMS_MAGIC(slot, session_magic);
-				INIT_SLOT_PARAMS_MAGIC(slot, local_magic);
-				dlist_push_head(&node_pool->uninit_slot, &slot->dnode);
-				SET_SLOT_LIST(slot, UNINIT_SLOT);
+				slot = alloc_uninit_slot(node_pool);
 				ereport(DEBUG1,
 						(errmsg("[pool] Alloc new slot, slot state SLOT_STATE_UNINIT")));
 			}
@@ -2751,29 +3628,18 @@ static void agent_acquire_connections(PoolAgent *agent, StringInfo msg)
 
 			if(slot->slot_state == SLOT_STATE_UNINIT)
 			{
-				static PGcustumFuns funs = {NULL, NULL, NULL, pq_custom_msg};
-				Assert(node_pool->connstr != NULL);
-				slot->conn = PQconnectStart(node_pool->connstr);
-				if(slot->conn == NULL)
-				{
-					ereport(ERROR,
-						(errcode(ERRCODE_OUT_OF_MEMORY)
-						,errmsg("out of memory")));
-				}else if(PQstatus(slot->conn) == CONNECTION_BAD)
+				if(!start_slot_connect(slot))
 				{
 					ereport(ERROR,
 						(errmsg("%s", PQerrorMessage(slot->conn))));
 				}
-				slot->slot_state = SLOT_STATE_CONNECTING;
-				slot->poll_state = PGRES_POLLING_WRITING;
-				slot->conn->funs = &funs;
-				slot->retry = 0;
 				ereport(DEBUG1,
 						(errmsg("[pool] begin connect, connstr : %s,backend pid :%d slot state SLOT_STATE_CONNECTING",
 						node_pool->connstr, agent->pid)));
 			}
 
 			SET_SLOT_OWNER(slot, agent);
+			slot->acquire_time = GetCurrentTimestamp();
 			Assert(slot->current_list != NULL_SLOT);
 			dlist_delete(&slot->dnode);
 			dlist_push_head(&(node_pool->busy_slot), &(slot->dnode));
@@ -2862,9 +3728,13 @@ static int agent_session_command(PoolAgent *agent, const char *set_command, Pool
 		strcat(*ppstr, set_command);
 	}
 	if(command_type == POOL_CMD_LOCAL_SET)
+	{
 		UPDATE_PARAMS_MAGIC(agent, local_magic);
-	else
+	}else
+	{
 		UPDATE_PARAMS_MAGIC(agent, session_magic);
+		agent->session_fingerprint = session_params_fingerprint(agent->session_params);
+	}
 
 	/*
 	 * Launch the new command to all the connections already hold by the agent
@@ -2879,10 +3749,110 @@ static int agent_session_command(PoolAgent *agent, const char *set_command, Pool
 	{
 		if (pool_exec_set_query(info->slot->conn, set_command, errMsg) == false)
 			res = 1;
+		else if (command_type == POOL_CMD_GLOBAL_SET)
+			set_slot_params(info->slot, agent);
 	}
 	return res;
 }
 
+/*
+ * Fingerprint of session params, 0 is kept for no params
+ */
+static uint32 session_params_fingerprint(const char *params)
+{
+	uint32 hash;
+
+	if (params == NULL)
+		return 0;
+
+	hash = DatumGetUInt32(hash_any((const unsigned char *) params, strlen(params)));
+	return hash == 0 ? 1 : hash;
+}
+
+/*
+ * Remember session params of agent are applied on slot
+ */
+static void set_slot_params(ADBNodePoolSlot *slot, PoolAgent *agent)
+{
+	reset_slot_params(slot);
+	slot->params_fingerprint = agent->session_fingerprint;
+	if (agent->session_params)
+		slot->session_params = MemoryContextStrdup(PoolerMemoryContext,
+												   agent->session_params);
+}
+
+/*
+ * Slot has no session params, after "reset all" or on a new connection
+ */
+static void reset_slot_params(ADBNodePoolSlot *slot)
+{
+	slot->params_fingerprint = 0;
+	if (slot->session_params)
+	{
+		pfree(slot->session_params);
+		slot->session_params = NULL;
+	}
+}
+
+/*
+ * Are session params applied on slot the same as those of agent? The
+ * fingerprint only rules out quickly, two different params may collide.
+ */
+static bool slot_params_match(ADBNodePoolSlot *slot, PoolAgent *agent)
+{
+	if (slot->params_fingerprint != agent->session_fingerprint)
+		return false;
+
+	if (slot->session_params == NULL || agent->session_params == NULL)
+		return slot->session_params == agent->session_params;
+
+	return strcmp(slot->session_params, agent->session_params) == 0;
+}
+
+/*
+ * Discard session state not covered by session params of slot: cursors,
+ * LISTEN, advisory locks, cached plans and sequences, and role or params
+ * set on remote without pool manager. It is "discard all" keeping session
+ * params, which can't be run with other commands. Slot having temp objects
+ * is destroyed instead, and remote deallocates prepared statements when it
+ * gets agtm port of next owner.
+ */
+static bool send_discard_session(ADBNodePoolSlot *slot)
+{
+	StringInfoData buf;
+	bool res;
+
+	initStringInfo(&buf);
+	appendStringInfoString(&buf,
+						   "close all;"
+						   "unlisten *;"
+						   "select pg_advisory_unlock_all();"
+						   "discard plans;"
+						   "discard sequences;"
+						   "set session authorization default;"
+						   "reset all");
+	if (slot->session_params)
+		appendStringInfo(&buf, ";%s", slot->session_params);
+
+	res = PQsendQuery(slot->conn, buf.data) ? true:false;
+	pfree(buf.data);
+	if (res)
+		slot->slot_state = SLOT_STATE_QUERY_DISCARD;
+	return res;
+}
+
+static void count_params_match(PoolAgent *agent, ADBNodePoolSlot *slot, bool match)
+{
+	/* nothing to replay on both side, don't count it */
+	if (agent->session_fingerprint == 0 && slot->params_fingerprint == 0)
+		return;
+
+	if (match)
+		++params_match_hits;
+	else
+		++params_match_misses;
+}
+
 static uint32 hash_any_v(const void *key, int keysize, ...)
 {
 	uint32 h;
@@ -3070,6 +4040,8 @@ static void on_exit_pooler(int code, Datum arg)
 	}
 	while(agentCount)
 		agent_destroy(poolAgents[--agentCount]);
+	if (PoolWarmupWindow > 0)
+		save_warm_up_file();
 	/* destroy agents and MemoryContext*/
 	destroy_htab_database();
 }
@@ -3167,7 +4139,21 @@ static int pq_custom_msg(PGconn *conn, char id, int msgLength)
 
 static void close_idle_connection(void)
 {
+	HASH_SEQ_STATUS hash_database_stats;
+	HASH_SEQ_STATUS hash_nodepool_status;
+	DatabasePool *db_pool;
+	ADBNodePool *node_pool;
 	time_t cur_time;
+
+	/* forget learned low-water marks, or idle slots are kept and connected again */
+	hash_seq_init(&hash_database_stats, htab_database);
+	while((db_pool = hash_seq_search(&hash_database_stats)) != NULL)
+	{
+		hash_seq_init(&hash_nodepool_status, db_pool->htab_nodes);
+		while((node_pool = hash_seq_search(&hash_nodepool_status)) != NULL)
+			MemSet(node_pool->warm_peak, 0, sizeof(node_pool->warm_peak));
+	}
+
 	cur_time = time(NULL);
 	close_timeout_idle_slots(cur_time + pool_time_out);
 
@@ -3201,7 +4187,7 @@ static void check_idle_slot(void)
 				Assert(slot->current_list != NULL_SLOT);
 				dlist_delete(miter.cur);
 				SET_SLOT_LIST(slot, NULL_SLOT);
-				destroy_slot(slot, false);
+				destroy_slot(slot, false, POOL_DESTROY_CLOSE);
 			}
 		}
 	}
@@ -3210,6 +4196,9 @@ static void check_idle_slot(void)
 Datum pool_close_idle_conn(PG_FUNCTION_ARGS)
 {
 	StringInfoData buf;
+	PoolHandle *handle;
+	List	   *handles;
+	ListCell   *lc;
 
 	if (!(IS_PGXC_COORDINATOR || IsConnFromCoord()))
 		PG_RETURN_BOOL(true);
@@ -3222,6 +4211,97 @@ Datum pool_close_idle_conn(PG_FUNCTION_ARGS)
 	pool_putmessage(&poolHandle->port, (char)(buf.cursor), buf.data, buf.len);
 	pool_flush(&poolHandle->port);
 
+	/* and to the other shards */
+	handles = connect_other_shards();
+	foreach (lc, handles)
+	{
+		handle = lfirst(lc);
+		pool_putmessage(&handle->port, (char)(buf.cursor), buf.data, buf.len);
+		pool_flush(&handle->port);
+	}
+	close_shard_handles(handles);
+
 	pfree(buf.data);
 	PG_RETURN_BOOL(true);
 }
+
+/*
+ * Read a reply message of type msgtype, report error if pool manager
+ * send us an error message.
+ */
+static void pool_recv_reply(PoolHandle *handle, char msgtype, StringInfo buf)
+{
+	int qtype;
+
+	qtype = pool_getbyte(&handle->port);
+	if (qtype == EOF)
+		ereport(ERROR,
+				(errcode(ERRCODE_CONNECTION_FAILURE),
+				 errmsg("unexpected EOF on pool manager connection")));
+	pool_getmessage(&handle->port, buf, 0);
+	if (qtype == PM_MSG_ERROR)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("%s", buf->data)));
+	else if (qtype != msgtype)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("unexpected message type %d from pool manager", qtype)));
+}
+
+/*
+ * Return how many times pool manager(s) reused a connection which already
+ * had the session params of the backend, and how many times it had to
+ * replay them.
+ */
+Datum pool_params_stats(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	StringInfoData buf;
+	PoolHandle *handle;
+	List	   *handles;
+	ListCell   *lc;
+	Datum		values[2];
+	bool		nulls[2];
+	int64		hits = 0;
+	int64		misses = 0;
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	if (IS_PGXC_COORDINATOR)
+	{
+		if (!poolHandle)
+			PoolManagerReconnect();
+		Assert(poolHandle != NULL);
+
+		handles = connect_other_shards();
+		handles = lcons(poolHandle, handles);
+		initStringInfo(&buf);
+		PG_TRY();
+		{
+			foreach (lc, handles)
+			{
+				handle = lfirst(lc);
+				pool_putmessage(&handle->port, PM_MSG_PARAMS_STATS, NULL, 0);
+				pool_flush(&handle->port);
+				pool_recv_reply(handle, PM_MSG_PARAMS_STATS, &buf);
+				hits += pq_getmsgint64(&buf);
+				misses += pq_getmsgint64(&buf);
+				pq_getmsgend(&buf);
+			}
+		}PG_CATCH();
+		{
+			close_shard_handles(list_delete_first(handles));
+			PG_RE_THROW();
+		}PG_END_TRY();
+		close_shard_handles(list_delete_first(handles));
+		pfree(buf.data);
+	}
+
+	values[0] = Int64GetDatum(hits);
+	values[1] = Int64GetDatum(misses);
+	nulls[0] = nulls[1] = false;
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(BlessTupleDesc(tupdesc), values, nulls)));
+}
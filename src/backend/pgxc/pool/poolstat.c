@@ -0,0 +1,378 @@
+/*-------------------------------------------------------------------------
+ *
+ * poolstat.c
+ *
+ *	  Shared memory statistics of pool manager
+ *
+ * Every pool manager process owns a fixed region of entries, one entry for
+ * each ADBNodePool it has.  Only the owner writes an entry, so no lock is
+ * needed; like PgBackendStatus, the writer bumps changecount before and
+ * after changing an entry and readers retry until they got a stable copy.
+ * The change is done in a critical section, an error between the two bumps
+ * would leave changecount odd and readers would retry forever.
+ *
+ * Portions Copyright (c) 2016, ASIAINFO BDX ADB Group
+ *
+ * src/backend/pgxc/pool/poolstat.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgxc/poolmgr.h"
+#include "pgxc/poolstat.h"
+#include "port/atomics.h"
+#include "storage/shmem.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/tuplestore.h"
+
+/* entries of each pool manager process */
+#define POOL_STAT_ENTRIES_PER_SHARD		512
+
+/* upper bounds of acquire wait histogram buckets, in microseconds */
+static const long acquire_wait_bounds[] = {100, 1000, 10000, 100000, 1000000};
+#define POOL_STAT_WAIT_BUCKETS	(lengthof(acquire_wait_bounds) + 1)
+
+struct PoolStatEntry
+{
+	int			changecount;
+	bool		in_use;
+	int			shard;
+	int			port;
+	NameData	database;
+	NameData	user_name;
+	char		hostname[NAMEDATALEN];
+
+	int			uninit_slots;
+	int			idle_slots;
+	int			busy_slots;
+	int			released_slots;
+
+	int64		connects;
+	int64		connect_failures;
+	int64		acquires;
+	int64		acquire_wait_usec;
+	int64		acquire_wait[POOL_STAT_WAIT_BUCKETS];
+	int64		params_replays;
+	int64		reset_alls;
+	int64		destroys[POOL_DESTROY_REASONS];
+};
+
+typedef struct PoolStatCtlData
+{
+	int				num_entries;
+	PoolStatEntry	entries[FLEXIBLE_ARRAY_MEMBER];
+} PoolStatCtlData;
+
+static PoolStatCtlData *PoolStatCtl = NULL;
+
+#define POOL_STAT_BEGIN_WRITE(entry)	\
+	do {								\
+		START_CRIT_SECTION();			\
+		(entry)->changecount++;			\
+		pg_write_barrier();				\
+	} while (0)
+
+#define POOL_STAT_END_WRITE(entry)						\
+	do {												\
+		pg_write_barrier();								\
+		(entry)->changecount++;							\
+		Assert(((entry)->changecount & 1) == 0);		\
+		END_CRIT_SECTION();								\
+	} while (0)
+
+Size
+PoolStatShmemSize(void)
+{
+	return add_size(offsetof(PoolStatCtlData, entries),
+					mul_size(mul_size(PoolManagerShards, POOL_STAT_ENTRIES_PER_SHARD),
+							 sizeof(PoolStatEntry)));
+}
+
+void
+PoolStatShmemInit(void)
+{
+	Size		size;
+	bool		found;
+
+	size = PoolStatShmemSize();
+	PoolStatCtl = (PoolStatCtlData *)
+		ShmemInitStruct("Pool Manager Statistics", size, &found);
+
+	if (!found)
+	{
+		MemSet(PoolStatCtl, 0, size);
+		PoolStatCtl->num_entries = PoolManagerShards * POOL_STAT_ENTRIES_PER_SHARD;
+	}
+}
+
+/*
+ * Forget entries left by last pool manager process of shard
+ */
+void
+PoolStatResetShard(int shard)
+{
+	PoolStatEntry  *entry;
+	int				i;
+
+	if (PoolStatCtl == NULL)
+		return;
+
+	Assert(shard >= 0 && shard < PoolManagerShards);
+	entry = &PoolStatCtl->entries[shard * POOL_STAT_ENTRIES_PER_SHARD];
+	for (i = 0; i < POOL_STAT_ENTRIES_PER_SHARD; i++, entry++)
+	{
+		if (!entry->in_use)
+			continue;
+		POOL_STAT_BEGIN_WRITE(entry);
+		entry->in_use = false;
+		POOL_STAT_END_WRITE(entry);
+	}
+}
+
+/*
+ * Get a free entry of shard, return NULL if all of them are in use,
+ * the node pool has no statistics then.
+ */
+PoolStatEntry *
+PoolStatAlloc(int shard, const char *database, const char *user_name,
+			  const char *hostname, int port)
+{
+	PoolStatEntry  *entry;
+	int				i;
+
+	if (PoolStatCtl == NULL)
+		return NULL;
+
+	Assert(shard >= 0 && shard < PoolManagerShards);
+	entry = &PoolStatCtl->entries[shard * POOL_STAT_ENTRIES_PER_SHARD];
+	for (i = 0; i < POOL_STAT_ENTRIES_PER_SHARD; i++, entry++)
+	{
+		if (entry->in_use)
+			continue;
+
+		POOL_STAT_BEGIN_WRITE(entry);
+		/* keep changecount, clear all others */
+		MemSet(((char *) entry) + sizeof(entry->changecount), 0,
+			   sizeof(*entry) - sizeof(entry->changecount));
+		entry->in_use = true;
+		entry->shard = shard;
+		entry->port = port;
+		namestrcpy(&entry->database, database);
+		namestrcpy(&entry->user_name, user_name);
+		strlcpy(entry->hostname, hostname, sizeof(entry->hostname));
+		POOL_STAT_END_WRITE(entry);
+
+		return entry;
+	}
+
+	ereport(LOG,
+			(errmsg("no free pool statistics entry for \"%s\" of database \"%s\" user \"%s\"",
+					hostname, database, user_name)));
+	return NULL;
+}
+
+void
+PoolStatFree(PoolStatEntry *entry)
+{
+	if (entry == NULL)
+		return;
+
+	POOL_STAT_BEGIN_WRITE(entry);
+	entry->in_use = false;
+	POOL_STAT_END_WRITE(entry);
+}
+
+void
+PoolStatSlots(PoolStatEntry *entry, int uninit, int idle, int busy, int released)
+{
+	if (entry == NULL)
+		return;
+
+	POOL_STAT_BEGIN_WRITE(entry);
+	entry->uninit_slots = uninit;
+	entry->idle_slots = idle;
+	entry->busy_slots = busy;
+	entry->released_slots = released;
+	POOL_STAT_END_WRITE(entry);
+}
+
+void
+PoolStatConnect(PoolStatEntry *entry, bool failed)
+{
+	if (entry == NULL)
+		return;
+
+	POOL_STAT_BEGIN_WRITE(entry);
+	if (failed)
+		entry->connect_failures++;
+	else
+		entry->connects++;
+	POOL_STAT_END_WRITE(entry);
+}
+
+void
+PoolStatAcquire(PoolStatEntry *entry, long wait_usec)
+{
+	int			i;
+
+	if (entry == NULL)
+		return;
+
+	for (i = 0; i < lengthof(acquire_wait_bounds); i++)
+	{
+		if (wait_usec < acquire_wait_bounds[i])
+			break;
+	}
+
+	POOL_STAT_BEGIN_WRITE(entry);
+	entry->acquires++;
+	entry->acquire_wait_usec += wait_usec;
+	entry->acquire_wait[i]++;
+	POOL_STAT_END_WRITE(entry);
+}
+
+void
+PoolStatParamsReplay(PoolStatEntry *entry, bool reset_all)
+{
+	if (entry == NULL)
+		return;
+
+	POOL_STAT_BEGIN_WRITE(entry);
+	if (reset_all)
+		entry->reset_alls++;
+	else
+		entry->params_replays++;
+	POOL_STAT_END_WRITE(entry);
+}
+
+void
+PoolStatDestroy(PoolStatEntry *entry, PoolDestroyReason reason)
+{
+	if (entry == NULL)
+		return;
+
+	AssertArg(reason >= 0 && reason < POOL_DESTROY_REASONS);
+	POOL_STAT_BEGIN_WRITE(entry);
+	entry->destroys[reason]++;
+	POOL_STAT_END_WRITE(entry);
+}
+
+/*
+ * Copy a stable image of entry, return false if it is not in use
+ */
+static bool
+pool_stat_read_entry(volatile PoolStatEntry *entry, PoolStatEntry *local)
+{
+	int			before;
+	int			after;
+
+	for (;;)
+	{
+		before = entry->changecount;
+		pg_read_barrier();
+
+		memcpy(local, (PoolStatEntry *) entry, sizeof(*local));
+
+		pg_read_barrier();
+		after = entry->changecount;
+		if (before == after && (before & 1) == 0)
+			break;
+
+		/* writer is changing it, try again */
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	return local->in_use;
+}
+
+#define PG_STAT_GET_POOL_COLS	21
+
+/*
+ * Return statistics of every pooled node of all pool manager processes
+ */
+Datum
+pg_stat_get_pool(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo  *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc		tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext	per_query_ctx;
+	MemoryContext	oldcontext;
+	PoolStatEntry	local;
+	Datum			values[PG_STAT_GET_POOL_COLS];
+	bool			nulls[PG_STAT_GET_POOL_COLS];
+	Datum			buckets[POOL_STAT_WAIT_BUCKETS];
+	int				i,j,n;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	/* only coordinator has pool manager */
+	for (i = 0; PoolStatCtl != NULL && i < PoolStatCtl->num_entries; i++)
+	{
+		if (!pool_stat_read_entry(&PoolStatCtl->entries[i], &local))
+			continue;
+
+		MemSet(nulls, 0, sizeof(nulls));
+		n = 0;
+		values[n++] = Int32GetDatum(local.shard);
+		values[n++] = NameGetDatum(&local.database);
+		values[n++] = NameGetDatum(&local.user_name);
+		values[n++] = CStringGetTextDatum(local.hostname);
+		values[n++] = Int32GetDatum(local.port);
+		values[n++] = Int32GetDatum(local.uninit_slots);
+		values[n++] = Int32GetDatum(local.idle_slots);
+		values[n++] = Int32GetDatum(local.busy_slots);
+		values[n++] = Int32GetDatum(local.released_slots);
+		values[n++] = Int64GetDatum(local.connects);
+		values[n++] = Int64GetDatum(local.connect_failures);
+		values[n++] = Int64GetDatum(local.acquires);
+		/* in milliseconds */
+		values[n++] = Float8GetDatum((double) local.acquire_wait_usec / 1000.0);
+		for (j = 0; j < POOL_STAT_WAIT_BUCKETS; j++)
+			buckets[j] = Int64GetDatum(local.acquire_wait[j]);
+		values[n++] = PointerGetDatum(construct_array(buckets, POOL_STAT_WAIT_BUCKETS,
+													  INT8OID, sizeof(int64),
+													  FLOAT8PASSBYVAL, 'd'));
+		values[n++] = Int64GetDatum(local.params_replays);
+		values[n++] = Int64GetDatum(local.reset_alls);
+		values[n++] = Int64GetDatum(local.destroys[POOL_DESTROY_CLOSE]);
+		values[n++] = Int64GetDatum(local.destroys[POOL_DESTROY_TIMEOUT]);
+		values[n++] = Int64GetDatum(local.destroys[POOL_DESTROY_BROKEN]);
+		values[n++] = Int64GetDatum(local.destroys[POOL_DESTROY_ERROR]);
+		values[n++] = Int64GetDatum(local.destroys[POOL_DESTROY_TEMP]);
+		Assert(n == PG_STAT_GET_POOL_COLS);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
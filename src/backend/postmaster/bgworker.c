@@ -17,6 +17,9 @@
 #include "miscadmin.h"
 #include "libpq/pqsignal.h"
 #include "access/parallel.h"
+#ifdef ADB
+#include "pgxc/poolmgr.h"
+#endif
 #include "postmaster/bgworker_internals.h"
 #include "postmaster/postmaster.h"
 #include "storage/barrier.h"
@@ -108,6 +111,11 @@ static const struct
 	{
 		"ParallelWorkerMain", ParallelWorkerMain
 	}
+#ifdef ADB
+	,{
+		"PoolerShardMain", PoolerShardMain
+	}
+#endif
 };
 
 /* Private functions. */
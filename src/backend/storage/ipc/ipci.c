@@ -45,9 +45,11 @@
 #include "storage/spin.h"
 #include "utils/snapmgr.h"
 #ifdef ADB
+#include "commands/sequence.h"
 #include "pgxc/nodemgr.h"
 #include "pgxc/pause.h"
 #include "pgxc/pgxc.h"
+#include "pgxc/poolstat.h"
 #endif
 #if defined(ADBMGRD)
 #include "postmaster/adbmonitor.h"
@@ -150,7 +152,11 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		size = add_size(size, AsyncShmemSize());
 #ifdef ADB
 		if (IS_PGXC_COORDINATOR)
+		{
 			size = add_size(size, ClusterLockShmemSize());
+			size = add_size(size, SequenceCacheShmemSize());
+			size = add_size(size, PoolStatShmemSize());
+		}
 #endif
 
 #if defined(ADBMGRD)
@@ -264,7 +270,11 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 
 #ifdef ADB
 	if (IS_PGXC_COORDINATOR)
+	{
 		ClusterLockShmemInit();
+		SequenceCacheShmemInit();
+		PoolStatShmemInit();
+	}
 #endif
 
 	/*
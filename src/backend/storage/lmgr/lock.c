@@ -2383,6 +2383,46 @@ LockReleaseSession(LOCKMETHODID lockmethodid)
 	}
 }
 
+#ifdef ADB
+/*
+ * LockHeldSession -- Check if the current process holds any session lock
+ *		of the specified lock method
+ */
+bool
+LockHeldSession(LOCKMETHODID lockmethodid)
+{
+	HASH_SEQ_STATUS status;
+	LOCALLOCK  *locallock;
+	LOCALLOCKOWNER *lockOwners;
+	int			i;
+
+	if (lockmethodid <= 0 || lockmethodid >= lengthof(LockMethods))
+		elog(ERROR, "unrecognized lock method: %d", lockmethodid);
+
+	hash_seq_init(&status, LockMethodLocalHash);
+
+	while ((locallock = (LOCALLOCK *) hash_seq_search(&status)) != NULL)
+	{
+		if (LOCALLOCK_LOCKMETHOD(*locallock) != lockmethodid ||
+			locallock->nLocks <= 0)
+			continue;
+
+		/* session locks have no owner */
+		lockOwners = locallock->lockOwners;
+		for (i = locallock->numLockOwners - 1; i >= 0; i--)
+		{
+			if (lockOwners[i].owner == NULL && lockOwners[i].nLocks > 0)
+			{
+				hash_seq_term(&status);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+#endif /* ADB */
+
 /*
  * LockReleaseCurrentOwner
  *		Release all locks belonging to CurrentResourceOwner
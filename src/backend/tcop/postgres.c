@@ -200,6 +200,15 @@ static ProcSignalReason RecoveryConflictReason;
 #ifdef ADB
 int parse_grammar = PARSE_GRAM_POSTGRES;
 int current_grammar = PARSE_GRAM_POSTGRES;
+
+/*
+ * AGTM listen port pool manager sent last, it changes only when the pooled
+ * session is given to another coordinator backend. Pool manager sends 0
+ * when it resets the session released by its owner. session_epoch counts
+ * the changes, so the new owner knows former prepared statements are gone.
+ */
+static int pooled_owner_port = 0;
+static uint32 pooled_session_epoch = 0;
 #endif
 #ifdef ADBMGRD
 int mgr_cmd_mode = CMD_MODE_MGR;
@@ -233,6 +242,7 @@ static int check_adb_log_duration(char * msec_str, bool was_logged);
 static List *segment_query_string(const char *query_string,
 								  List *parsetree_list);
 static CommandDest PortalSetCommandDest(Portal portal, CommandDest dest);
+static bool QueryStringNeedsSnapshot(const char *query_string);
 #endif
 #ifdef AGTM
 #include "agtm.c"
@@ -1253,6 +1263,15 @@ exec_simple_query(const char *query_string)
 	 */
 	start_xact_command();
 
+#ifdef ADB
+	/*
+	 * Ask AGTM for the snapshot now, the reply travels while we parse.
+	 * Transaction control and utility statements never use it.
+	 */
+	if (QueryStringNeedsSnapshot(query_string))
+		agtm_PrefetchGlobalSnapShot();
+#endif
+
 	/*
 	 * Zap any pre-existing unnamed statement.  (While not strictly necessary,
 	 * it seems best to define simple-Query mode as if it used the unnamed
@@ -1567,6 +1586,11 @@ exec_simple_query(const char *query_string)
 			CommandCounterIncrement();
 		}
 
+#ifdef ADB
+		/* a prefetched snapshot is too old for the next parsetree */
+		agtm_ReleasePrefetchedSnapShot();
+#endif
+
 		/*
 		 * Tell client that we're done with this query.  Note we emit exactly
 		 * one EndCommand report for each raw parsetree, thus one for each SQL
@@ -1576,6 +1600,11 @@ exec_simple_query(const char *query_string)
 		EndCommand(completionTag, dest);
 	}							/* end loop over parsetrees */
 
+#ifdef ADB
+	/* no parsetree used it */
+	agtm_ReleasePrefetchedSnapShot();
+#endif
+
 	/*
 	 * Close down transaction statement, if one is open.
 	 */
@@ -2011,6 +2040,16 @@ exec_bind_message(StringInfo input_message)
 	 */
 	start_xact_command();
 
+#ifdef ADB
+	/*
+	 * Ask AGTM for the snapshot taken below for parameter I/O and planning,
+	 * the reply travels while we read the parameters and set up the portal.
+	 */
+	if (psrc->raw_parse_tree &&
+		analyze_requires_snapshot(psrc->raw_parse_tree))
+		agtm_PrefetchGlobalSnapShot();
+#endif
+
 	/* Switch back to message context */
 	MemoryContextSwitchTo(MessageContext);
 
@@ -2297,6 +2336,11 @@ exec_bind_message(StringInfo input_message)
 	if (snapshot_set)
 		PopActiveSnapshot();
 
+#ifdef ADB
+	/* a prefetched snapshot is too old for the execute message */
+	agtm_ReleasePrefetchedSnapShot();
+#endif
+
 	/*
 	 * And we're ready to start portal execution.
 	 */
@@ -3131,6 +3175,64 @@ IsTransactionStmtList(List *parseTrees)
 	return false;
 }
 
+#ifdef ADB
+/*
+ * Does the first statement of query_string take a snapshot for parse
+ * analysis? Only the leading keyword is looked at, anything we are not
+ * sure about (transaction control, SET, other utility) says no, so that
+ * no snapshot is prefetched from AGTM for it.
+ */
+static bool
+QueryStringNeedsSnapshot(const char *query_string)
+{
+	static const char *const keywords[] =
+	{
+		"select", "insert", "update", "delete", "with", "values",
+		"table", "declare", "explain", "execute"
+	};
+	const char *p = query_string;
+	int			len;
+	int			i;
+
+	/* skip white space and comments */
+	for (;;)
+	{
+		while (isspace((unsigned char) *p))
+			p++;
+		if (p[0] == '-' && p[1] == '-')
+		{
+			while (*p != '\0' && *p != '\n')
+				p++;
+		}else if (p[0] == '/' && p[1] == '*')
+		{
+			p += 2;
+			while (*p != '\0' && !(p[0] == '*' && p[1] == '/'))
+				p++;
+			if (*p != '\0')
+				p += 2;
+		}else
+		{
+			break;
+		}
+	}
+
+	/* parenthesized SELECT */
+	if (*p == '(')
+		return true;
+
+	for (len = 0; isalpha((unsigned char) p[len]); len++)
+		;
+	for (i = 0; i < lengthof(keywords); i++)
+	{
+		if (strlen(keywords[i]) == len &&
+			pg_strncasecmp(p, keywords[i], len) == 0)
+			return true;
+	}
+
+	return false;
+}
+#endif /* ADB */
+
 /* Release any existing unnamed prepared statement */
 static void
 drop_unnamed_stmt(void)
@@ -4503,7 +4605,7 @@ PostgresMain(int argc, char *argv[],
 	{
 		if (!IsConnFromCoord())
 		{
-			pool_handle = GetPoolManagerHandle();
+			pool_handle = GetPoolManagerHandle(dbname, username);
 			if (pool_handle == NULL)
 			{
 				ereport(ERROR,
@@ -4599,6 +4701,9 @@ PostgresMain(int argc, char *argv[],
 
 		/* Mark transaction abort with error */
 		MarkCurrentTransactionErrorAborted();
+
+		/* Statement is gone, so is the snapshot it may have prefetched */
+		agtm_ReleasePrefetchedSnapShot();
 #endif
 
 		/*
@@ -5079,6 +5184,17 @@ PostgresMain(int argc, char *argv[],
 
 					ereport(DEBUG1, (errmsg("Received AGTM listen port: %d", listen_port)));
 
+					if (listen_port == 0 || listen_port != pooled_owner_port)
+					{
+						/*
+						 * Deallocate statements of former owner on pool reset
+						 * or on owner change, they are useless for others.
+						 */
+						DropAllPreparedStatements();
+						pooled_owner_port = listen_port;
+						++pooled_session_epoch;
+					}
+
 					if (IS_PGXC_DATANODE || IsCoordCandidate())
 						agtm_SetPort(listen_port);
 					sprintf(cmd_msg, "%d", listen_port);
@@ -5099,6 +5215,17 @@ PostgresMain(int argc, char *argv[],
 					pq_sendint(&buf, (int32) MyProcPid, sizeof(int32));
 					pq_sendint(&buf, (int32) MyCancelKey, sizeof(int32));
 					pq_endmessage(&buf);
+#ifdef ADB
+					{
+						char epoch[16];
+
+						snprintf(epoch, sizeof(epoch), "%u", pooled_session_epoch);
+						pq_beginmessage(&buf, 'S');
+						pq_sendstring(&buf, "session_epoch");
+						pq_sendstring(&buf, epoch);
+						pq_endmessage(&buf);
+					}
+#endif /* ADB */
 				}
 				send_ready_for_query = true;
 				break;
@@ -2131,9 +2131,19 @@ cmp_numerics(Numeric num1, Numeric num2)
 Datum
 hash_numeric(PG_FUNCTION_ARGS)
 {
-	Numeric		key = PG_GETARG_NUMERIC(0);
+	PG_RETURN_UINT32(numeric_hash_value(PG_GETARG_NUMERIC(0)));
+}
+
+/*
+ * numeric_hash_value() -
+ *
+ *	Hash value of hash_numeric, for callers hashing many values without fmgr
+ */
+uint32
+numeric_hash_value(Numeric key)
+{
 	Datum		digit_hash;
-	Datum		result;
+	uint32		result;
 	int			weight;
 	int			start_offset;
 	int			end_offset;
@@ -2143,7 +2153,7 @@ hash_numeric(PG_FUNCTION_ARGS)
 
 	/* If it's NaN, don't try to hash the rest of the fields */
 	if (NUMERIC_IS_NAN(key))
-		PG_RETURN_UINT32(0);
+		return 0;
 
 	weight = NUMERIC_WEIGHT(key);
 	start_offset = 0;
@@ -2175,7 +2185,7 @@ hash_numeric(PG_FUNCTION_ARGS)
 	 * regardless of any other fields.
 	 */
 	if (NUMERIC_NDIGITS(key) == start_offset)
-		PG_RETURN_UINT32(-1);
+		return (uint32) -1;
 
 	for (i = NUMERIC_NDIGITS(key) - 1; i >= 0; i--)
 	{
@@ -2199,9 +2209,9 @@ hash_numeric(PG_FUNCTION_ARGS)
 						  hash_len * sizeof(NumericDigit));
 
 	/* Mix in the weight, via XOR */
-	result = digit_hash ^ weight;
+	result = DatumGetUInt32(digit_hash) ^ (uint32) weight;
 
-	PG_RETURN_DATUM(result);
+	return result;
 }
 
 
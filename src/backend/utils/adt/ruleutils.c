@@ -6612,6 +6612,15 @@ get_utility_query_def(Query *query, deparse_context *context)
 					appendStringInfo(buf, " DISTRIBUTE BY MODULO(%s)", stmt->distributeby->colname);
 					break;
 
+				case DISTTYPE_HASHMAP:
+					appendStringInfo(buf, " DISTRIBUTE BY HASHMAP(%s)", stmt->distributeby->colname);
+					break;
+
+				case DISTTYPE_RANGE:
+					/* datanodes keep no bounds, the column is enough */
+					appendStringInfo(buf, " DISTRIBUTE BY RANGE(%s)", stmt->distributeby->colname);
+					break;
+
 				default:
 					ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR),
 								errmsg("Invalid distribution type")));
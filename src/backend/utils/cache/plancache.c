@@ -77,6 +77,8 @@
 
 
 static void drop_datanode_statements(Plan *plannode);
+static bool is_single_node_candidate(CachedPlanSource *plansource);
+static bool is_single_node_plan(CachedPlan *plan);
 #endif
 
 /*
@@ -219,6 +221,9 @@ CreateCachedPlan(Node *raw_parse_tree,
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
 	plansource->num_custom_plans = 0;
+#ifdef ADB
+	plansource->single_node_gplan = false;
+#endif
 
 	MemoryContextSwitchTo(oldcxt);
 
@@ -287,6 +292,9 @@ CreateOneShotCachedPlan(Node *raw_parse_tree,
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
 	plansource->num_custom_plans = 0;
+#ifdef ADB
+	plansource->single_node_gplan = false;
+#endif
 
 	return plansource;
 }
@@ -1147,6 +1155,19 @@ choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams)
 	if (plansource->cursor_options & CURSOR_OPT_CUSTOM_PLAN)
 		return true;
 
+#ifdef ADB
+	/*
+	 * A generic plan shipping the statement to the only Datanode chosen by
+	 * the bound parameters is as good as any custom plan, so don't plan it
+	 * again for every execution. Try the generic plan first if we don't know
+	 * yet whether the statement can have such a plan.
+	 */
+	if (plansource->single_node_gplan)
+		return false;
+	if (plansource->generic_cost < 0 && is_single_node_candidate(plansource))
+		return false;
+#endif /* ADB */
+
 	/* Generate custom plans until we have done at least 5 (arbitrary) */
 	if (plansource->num_custom_plans < 5)
 		return true;
@@ -1311,6 +1332,11 @@ CachedPlan *GetCachedPlanADB(CachedPlanSource *plansource,
 			}
 			/* Update generic_cost whenever we make a new generic plan */
 			plansource->generic_cost = cached_plan_cost(plan, false);
+#ifdef ADB
+			/* decide again, the new plan may ship to all Datanodes now */
+			plansource->single_node_gplan = !cluster_safe &&
+											is_single_node_plan(plan);
+#endif /* ADB */
 
 			/*
 			 * If, based on the now-known value of generic_cost, we'd not have
@@ -1369,6 +1395,60 @@ CachedPlan *GetCachedPlanADB(CachedPlanSource *plansource,
 }
 
 #ifdef ADB
+/*
+ * Could the statement of plansource be shipped to a single Datanode chosen
+ * by its parameters? Only a statement on one relation may be.
+ */
+static bool
+is_single_node_candidate(CachedPlanSource *plansource)
+{
+	Query	   *query;
+
+	if (!IsCoordMaster() || plansource->num_params == 0 ||
+		list_length(plansource->query_list) != 1)
+		return false;
+
+	query = (Query *) linitial(plansource->query_list);
+	if (!IsA(query, Query) || query->utilityStmt != NULL)
+		return false;
+
+	switch (query->commandType)
+	{
+		case CMD_SELECT:
+		case CMD_INSERT:
+		case CMD_UPDATE:
+		case CMD_DELETE:
+			return list_length(query->rtable) == 1;
+		default:
+			break;
+	}
+
+	return false;
+}
+
+/*
+ * Is the plan a fast query shipping of a single relation, which executor
+ * sends to the Datanodes chosen by the parameters?
+ */
+static bool
+is_single_node_plan(CachedPlan *plan)
+{
+	PlannedStmt *ps;
+	RemoteQuery *step;
+
+	if (list_length(plan->stmt_list) != 1)
+		return false;
+
+	ps = (PlannedStmt *) linitial(plan->stmt_list);
+	if (!IsA(ps, PlannedStmt) || !IsA(ps->planTree, RemoteQuery))
+		return false;
+
+	step = (RemoteQuery *) ps->planTree;
+	return step->exec_nodes != NULL &&
+		   step->exec_nodes->en_expr != NIL &&
+		   OidIsValid(step->exec_nodes->en_relid);
+}
+
 /*
  * Find and release all Datanode statements referenced by the plan node and subnodes
  */
@@ -1544,6 +1624,9 @@ CopyCachedPlan(CachedPlanSource *plansource)
 	newsource->generic_cost = plansource->generic_cost;
 	newsource->total_custom_cost = plansource->total_custom_cost;
 	newsource->num_custom_plans = plansource->num_custom_plans;
+#ifdef ADB
+	newsource->single_node_gplan = plansource->single_node_gplan;
+#endif
 
 	MemoryContextSwitchTo(oldcxt);
 
@@ -36,6 +36,10 @@
 #include "libpq/libpq.h"
 #include "mb/pg_wchar.h"
 #include "miscadmin.h"
+#ifdef ADB
+#include "pgxc/pgxc.h"
+#include "pgxc/poolmgr.h"
+#endif
 #if defined(ADBMGRD)
 #include "postmaster/adbmonitor.h"
 #endif
@@ -1477,6 +1481,10 @@ process_shared_preload_libraries(void)
 	load_libraries(shared_preload_libraries_string,
 				   "shared_preload_libraries",
 				   false);
+#ifdef ADB
+	if (IS_PGXC_COORDINATOR)
+		RegisterPoolerShards();
+#endif
 	process_shared_preload_libraries_in_progress = false;
 }
 
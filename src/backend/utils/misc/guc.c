@@ -88,7 +88,11 @@
 #include "utils/xml.h"
 
 #ifdef ADB
+#include "access/rxact_mgr.h"
+#include "agtm/agtm.h"
+#include "commands/sequence.h"
 #include "commands/tablecmds.h"
+#include "intercomm/inter-comm.h"
 #include "nodes/nodes.h"
 #include "optimizer/pgxcship.h"
 #include "optimizer/plancat.h"
@@ -452,6 +456,19 @@ static const struct config_enum_entry adb_aux_types[] = {
 	{"key", USE_AUX_KEY, false},
 	{NULL, 0, false}
 };
+
+static const struct config_enum_entry sequence_cache_mode_options[] = {
+	{"local", SEQ_CACHE_LOCAL, false},
+	{"shared", SEQ_CACHE_SHARED, false},
+	{"ordered", SEQ_CACHE_ORDERED, false},
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry pool_mode_options[] = {
+	{"session", POOL_MODE_SESSION, false},
+	{"transaction", POOL_MODE_TRANSACTION, false},
+	{NULL, 0, false}
+};
 #endif /* ADB */
 
 #ifdef ADBMGRD
@@ -1947,6 +1964,24 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 #endif
+	{
+		{"agtm_prefetch_snapshot", PGC_USERSET, GTM,
+			gettext_noop("Requests the snapshot from AGTM while the query is parsed."),
+			NULL
+		},
+		&AGtmPrefetchSnapshot,
+		true,
+		NULL, NULL, NULL
+	},
+	{
+		{"async_commit_prepared", PGC_USERSET, WAL_SETTINGS,
+			gettext_noop("Returns from commit before the second phase of implicit two-phase commit is finished."),
+			gettext_noop("The remote xact manager commits the prepared transaction on remote nodes in background.")
+		},
+		&AsyncCommitPrepared,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"persistent_datanode_connections", PGC_BACKEND, DEVELOPER_OPTIONS,
 			gettext_noop("Session never releases acquired connections."),
@@ -1958,6 +1993,18 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"pool_match_session_params", PGC_SIGHUP, DATA_NODES,
+			gettext_noop("Keep session parameters of released pooled connections."),
+			gettext_noop("A pooled connection is reused without replaying "
+						 "session parameters when they match the ones of the "
+						 "new session, instead of issuing \"reset all\" on release.")
+		},
+		&PoolMatchSessionParams,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"xc_maintenance_mode", PGC_SUSET, XC_HOUSEKEEPING_OPTIONS,
 			gettext_noop("Turn on XC maintenance mode."),
@@ -3268,6 +3315,43 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"pool_manager_shards", PGC_POSTMASTER, DATA_NODES,
+			gettext_noop("Number of pool manager processes."),
+			gettext_noop("Sessions are spread over the pool manager processes "
+						 "by database and user name. Each process but the first "
+						 "one uses a slot of max_worker_processes.")
+		},
+		&PoolManagerShards,
+		1, 1, 16,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"pool_warmup_window", PGC_SIGHUP, DATA_NODES,
+			gettext_noop("Minutes of pool usage to learn pooled connections to keep."),
+			gettext_noop("Pool manager keeps as many connections of each pool as "
+						 "were used at once in this many minutes, and connects "
+						 "recently used pools at startup. Zero disables it."),
+			GUC_UNIT_MIN
+		},
+		&PoolWarmupWindow,
+		10, 0, 60,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"remote_statement_cache_size", PGC_USERSET, DATA_NODES,
+			gettext_noop("Sets the number of shipped statements kept prepared on each remote node."),
+			gettext_noop("Queries with parameters shipped to remote nodes are "
+						 "prepared once per remote session and executed by "
+						 "name later. Zero disables it.")
+		},
+		&RemoteStatementCacheSize,
+		64, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"agtm_port", PGC_SIGHUP, GTM,
 			gettext_noop("Port of GTM."),
@@ -3320,6 +3404,37 @@ static struct config_int ConfigureNamesInt[] =
 		10, 0, INT_MAX,
 		NULL, NULL, NULL
 	},
+
+	{
+		{"shared_sequence_cache_size", PGC_POSTMASTER, GTM,
+			gettext_noop("Sets the maximum number of sequences whose AGTM leases are shared by all backends."),
+			gettext_noop("A value of 0 disables the node-wide sequence cache.")
+		},
+		&shared_sequence_cache_size,
+		1024, 0, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"sequence_lease_size", PGC_USERSET, GTM,
+			gettext_noop("Sets the minimum number of sequence values leased from AGTM at once for the node-wide sequence cache."),
+			gettext_noop("The sequence's CACHE is used when it is larger.")
+		},
+		&sequence_lease_size,
+		64, 1, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"rxact_group_commit_delay", PGC_SIGHUP, WAL_SETTINGS,
+			gettext_noop("Sets the delay in milliseconds before the remote xact manager flushes its log."),
+			gettext_noop("Records of concurrent transactions arriving within the delay share one flush."),
+			GUC_UNIT_MS
+		},
+		&RxactGroupCommitDelay,
+		0, 0, 1000,
+		NULL, NULL, NULL
+	},
 #endif /* ADB */
 
 #ifdef AGTM
@@ -4494,6 +4609,29 @@ static struct config_enum ConfigureNamesEnum[] =
 		USE_AUX_NODE, adb_aux_types,
 		NULL, NULL, NULL
 	},
+
+	{
+		{"sequence_cache_mode", PGC_USERSET, GTM,
+			gettext_noop("Sets how nextval() caches sequence values leased from AGTM."),
+			gettext_noop("\"local\" caches per backend, \"shared\" shares the leases of all backends "
+						 "of this node, \"ordered\" gets every value from AGTM.")
+		},
+		&sequence_cache_mode,
+		SEQ_CACHE_SHARED, sequence_cache_mode_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"pool_mode", PGC_USERSET, DATA_NODES,
+			gettext_noop("Sets when remote connections are given back to the pool."),
+			gettext_noop("\"transaction\" gives them to other sessions at transaction end, "
+						 "unless the session has temporary objects, remote prepared "
+						 "statements or session advisory locks.")
+		},
+		&PoolMode,
+		POOL_MODE_SESSION, pool_mode_options,
+		NULL, NULL, NULL
+	},
 #endif /* ADB */
 
 #ifdef ADBMGRD
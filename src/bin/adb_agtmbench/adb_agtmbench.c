@@ -0,0 +1,730 @@
+/*-------------------------------------------------------------------------
+ *
+ * adb_agtmbench.c - load generator and latency benchmark for AGTM
+ *
+ * Speaks the AGTM message protocol (see agtm/agtm_msg.h) directly, the
+ * same way the libagtm client in coordinators and datanodes does, so the
+ * capacity of AGTM can be measured in isolation from the rest of the
+ * cluster.  Each client connection keeps one request in flight, all of
+ * them are driven from a single event loop.
+ *
+ * Copyright (c) 2014-2017, ADB Global Development Group
+ *
+ * IDENTIFICATION
+ *		  src/bin/adb_agtmbench/adb_agtmbench.c
+ *-------------------------------------------------------------------------
+ */
+#include "postgres_fe.h"
+
+#include <math.h>
+#include <sys/time.h>
+#ifdef HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif
+
+#include "access/transam.h"
+#include "agtm/agtm_msg.h"
+#include "catalog/pg_type.h"
+#include "getopt_long.h"
+#include "libpq-fe.h"
+#include "libpq-int.h"
+#include "portability/instr_time.h"
+
+typedef enum BenchOp
+{
+	OP_GXID,
+	OP_SNAPSHOT,
+	OP_TIMESTAMP,
+	OP_NEXTVAL,
+	OP_STATUS,
+	NUM_BENCH_OPS
+} BenchOp;
+
+typedef struct BenchOpInfo
+{
+	const char		   *name;
+	AGTM_MessageType	msg;
+	AGTM_ResultType		result;
+	int					weight;		/* share in the mix */
+} BenchOpInfo;
+
+static BenchOpInfo bench_ops[NUM_BENCH_OPS] =
+{
+	{"gxid", AGTM_MSG_GET_GXID, AGTM_GET_GXID_RESULT, 1},
+	{"snapshot", AGTM_MSG_SNAPSHOT_GET, AGTM_SNAPSHOT_GET_RESULT, 4},
+	{"timestamp", AGTM_MSG_GET_TIMESTAMP, AGTM_GET_TIMESTAMP_RESULT, 1},
+	{"nextval", AGTM_MSG_SEQUENCE_GET_NEXT, AGTM_SEQUENCE_GET_NEXT_RESULT, 0},
+	{"status", AGTM_MSG_GET_XACT_STATUS, AGTM_GET_XACT_STATUS_RESULT, 1}
+};
+
+/* latencies in microseconds of one kind of request */
+typedef struct LatencyLog
+{
+	int64	   *values;
+	int64		count;
+	int64		size;
+} LatencyLog;
+
+typedef struct BenchClient
+{
+	PGconn		   *conn;
+	bool			busy;			/* request in flight */
+	BenchOp			op;				/* of the request in flight */
+	instr_time		start;			/* when it was sent */
+	TransactionId	last_xid;		/* for xact status requests */
+} BenchClient;
+
+static const char  *progname;
+
+static char		   *pghost = NULL;
+static char		   *pgport = NULL;
+static char		   *username = NULL;
+static char		   *dbname = AGTM_DBNAME;
+static int			nclients = 1;
+static int			nopen_xacts = 0;
+static int			duration = 10;
+static bool			mix_given = false;
+
+/* sequence used by nextval requests */
+static char		   *seq_database = NULL;
+static char		   *seq_schema = NULL;
+static char		   *seq_name = NULL;
+
+static LatencyLog	latencies[NUM_BENCH_OPS];
+
+static void usage(void);
+static void parse_mix(const char *mix);
+static void parse_sequence(const char *seq);
+static PGconn *connect_agtm(void);
+static void prepare_result(PGconn *conn);
+static bool put_string(PGconn *conn, const char *str);
+static void send_request(BenchClient *client, BenchOp op);
+static bool read_result(BenchClient *client);
+static void wait_result(BenchClient *client);
+static BenchOp choose_op(int total_weight);
+static void log_latency(BenchOp op, int64 usec);
+static int	compare_int64(const void *a, const void *b);
+static double percentile(LatencyLog *log, double p);
+static void print_report(double elapsed);
+
+static void
+usage(void)
+{
+	printf("%s drives AGTM with a mix of requests and reports throughput and latency.\n\n", progname);
+	printf("Usage:\n");
+	printf("  %s [OPTION]...\n", progname);
+	printf("\nOptions:\n");
+	printf("  -c, --client=NUM         number of concurrent client connections (default: 1)\n");
+	printf("  -T, --time=NUM           duration of the benchmark in seconds (default: 10)\n");
+	printf("  -m, --mix=OP=WEIGHT,...  request mix, OP is one of gxid, snapshot,\n");
+	printf("                           timestamp, nextval, status\n");
+	printf("                           (default: gxid=1,snapshot=4,timestamp=1,status=1)\n");
+	printf("  -S, --sequence=DB.SCHEMA.NAME\n");
+	printf("                           AGTM sequence used by nextval requests\n");
+	printf("  -o, --open-xacts=NUM     transactions kept open on AGTM during the run,\n");
+	printf("                           to grow the snapshot xip list (default: 0)\n");
+	printf("  -V, --version            output version information, then exit\n");
+	printf("  -?, --help               show this help, then exit\n");
+	printf("\nConnection options:\n");
+	printf("  -h, --host=HOSTNAME      AGTM host or socket directory\n");
+	printf("  -p, --port=PORT          AGTM port number\n");
+	printf("  -U, --username=USERNAME  connect as specified user (default: \"%s\")\n", AGTM_USER);
+	printf("  -d, --dbname=DBNAME      database to connect to (default: \"%s\")\n", AGTM_DBNAME);
+}
+
+static void
+parse_mix(const char *mix)
+{
+	char	   *buf = pg_strdup(mix);
+	char	   *item;
+	int			i;
+
+	for (i = 0; i < NUM_BENCH_OPS; i++)
+		bench_ops[i].weight = 0;
+
+	for (item = strtok(buf, ","); item != NULL; item = strtok(NULL, ","))
+	{
+		char	   *eq = strchr(item, '=');
+		int			weight = 1;
+
+		if (eq != NULL)
+		{
+			*eq = '\0';
+			weight = atoi(eq + 1);
+			if (weight < 0)
+			{
+				fprintf(stderr, "%s: invalid weight for \"%s\"\n", progname, item);
+				exit(1);
+			}
+		}
+
+		for (i = 0; i < NUM_BENCH_OPS; i++)
+		{
+			if (strcmp(item, bench_ops[i].name) == 0)
+				break;
+		}
+		if (i == NUM_BENCH_OPS)
+		{
+			fprintf(stderr, "%s: unknown request \"%s\" in mix\n", progname, item);
+			exit(1);
+		}
+		bench_ops[i].weight = weight;
+	}
+
+	pg_free(buf);
+	mix_given = true;
+}
+
+static void
+parse_sequence(const char *seq)
+{
+	char	   *buf = pg_strdup(seq);
+	char	   *dot1;
+	char	   *dot2;
+
+	dot1 = strchr(buf, '.');
+	dot2 = dot1 ? strchr(dot1 + 1, '.') : NULL;
+	if (dot1 == NULL || dot2 == NULL || dot1 == buf ||
+		dot2 == dot1 + 1 || dot2[1] == '\0')
+	{
+		fprintf(stderr, "%s: sequence must be given as DATABASE.SCHEMA.NAME\n",
+				progname);
+		exit(1);
+	}
+
+	*dot1 = '\0';
+	*dot2 = '\0';
+	seq_database = buf;
+	seq_schema = dot1 + 1;
+	seq_name = dot2 + 1;
+}
+
+static PGconn *
+connect_agtm(void)
+{
+	PGconn	   *conn;
+
+	conn = PQsetdbLogin(pghost, pgport, NULL, NULL, dbname,
+						username ? username : AGTM_USER, NULL);
+	if (PQstatus(conn) != CONNECTION_OK)
+	{
+		fprintf(stderr, "%s: could not connect to AGTM: %s",
+				progname, PQerrorMessage(conn));
+		exit(1);
+	}
+
+	return conn;
+}
+
+/*
+ * AGTM does not send a row description, the result receiving its single
+ * bytea column has to be set up beforehand (see agtm_PrepareResult).
+ */
+static void
+prepare_result(PGconn *conn)
+{
+	PGresult   *result;
+
+	result = PQmakeEmptyPGresult(conn, PGRES_TUPLES_OK);
+	if (result == NULL)
+	{
+		fprintf(stderr, "%s: out of memory\n", progname);
+		exit(1);
+	}
+	result->numAttributes = 1;
+	result->attDescs = (PGresAttDesc *) PQresultAlloc(result, sizeof(PGresAttDesc));
+	if (result->attDescs == NULL)
+	{
+		fprintf(stderr, "%s: out of memory\n", progname);
+		exit(1);
+	}
+	MemSet(result->attDescs, 0, sizeof(PGresAttDesc));
+	result->binary = 1;
+	result->attDescs[0].name = pqResultStrdup(result, "result");
+	result->attDescs[0].format = 1;
+	result->attDescs[0].typid = BYTEAOID;
+	result->attDescs[0].typlen = -1;
+	result->attDescs[0].atttypmod = -1;
+
+	conn->result = result;
+}
+
+/* same as "%d%d %p%d" of agtm_send_message */
+static bool
+put_string(PGconn *conn, const char *str)
+{
+	int			len = strlen(str);
+
+	return pqPutInt(len, 4, conn) == 0 &&
+		pqPutnchar(str, len, conn) == 0;
+}
+
+static void
+send_request(BenchClient *client, BenchOp op)
+{
+	PGconn	   *conn = client->conn;
+	bool		ok;
+
+	INSTR_TIME_SET_CURRENT(client->start);
+
+	ok = PQsendQueryStart(conn) &&
+		pqPutMsgStart('A', true, conn) == 0 &&
+		pqPutInt(bench_ops[op].msg, 4, conn) == 0;
+
+	switch (op)
+	{
+		case OP_GXID:
+			/* not a subtransaction */
+			ok = ok && pqPutc(0, conn) == 0;
+			break;
+		case OP_NEXTVAL:
+			ok = ok && put_string(conn, seq_name) &&
+				put_string(conn, seq_database) &&
+				put_string(conn, seq_schema);
+			break;
+		case OP_STATUS:
+			ok = ok && pqPutInt((int) client->last_xid, 4, conn) == 0;
+			break;
+		default:
+			break;
+	}
+
+	if (!ok || pqPutMsgEnd(conn) < 0)
+	{
+		fprintf(stderr, "%s: could not send %s request: %s",
+				progname, bench_ops[op].name, PQerrorMessage(conn));
+		exit(1);
+	}
+
+	conn->asyncStatus = PGASYNC_BUSY;
+	prepare_result(conn);
+
+	if (pqFlush(conn) != 0)
+	{
+		fprintf(stderr, "%s: could not send %s request: %s",
+				progname, bench_ops[op].name, PQerrorMessage(conn));
+		exit(1);
+	}
+
+	client->op = op;
+	client->busy = true;
+}
+
+/*
+ * Consume whatever the client's request got so far, returns true once the
+ * request is complete.
+ */
+static bool
+read_result(BenchClient *client)
+{
+	PGconn	   *conn = client->conn;
+	PGresult   *res;
+
+	if (PQconsumeInput(conn) == 0)
+	{
+		fprintf(stderr, "%s: could not read from AGTM: %s",
+				progname, PQerrorMessage(conn));
+		exit(1);
+	}
+
+	while (!PQisBusy(conn))
+	{
+		const char *data;
+		uint32		rtype;
+
+		res = PQgetResult(conn);
+		if (res == NULL)
+		{
+			client->busy = false;
+			return true;
+		}
+
+		if (PQresultStatus(res) != PGRES_TUPLES_OK)
+		{
+			fprintf(stderr, "%s: %s request failed: %s",
+					progname, bench_ops[client->op].name,
+					PQresultErrorMessage(res));
+			exit(1);
+		}
+
+		data = PQgetvalue(res, 0, 0);
+		if (PQgetlength(res, 0, 0) < (int) sizeof(rtype))
+		{
+			fprintf(stderr, "%s: invalid message format from AGTM\n", progname);
+			exit(1);
+		}
+		memcpy(&rtype, data, sizeof(rtype));
+		rtype = ntohl(rtype);
+		if (rtype != (uint32) bench_ops[client->op].result)
+		{
+			fprintf(stderr, "%s: unexpected result type %u for %s request\n",
+					progname, rtype, bench_ops[client->op].name);
+			exit(1);
+		}
+
+		/* remember the xid for the following status requests */
+		if (client->op == OP_GXID &&
+			PQgetlength(res, 0, 0) >= (int) (sizeof(rtype) + sizeof(TransactionId)))
+			memcpy(&client->last_xid, data + sizeof(rtype), sizeof(TransactionId));
+
+		PQclear(res);
+	}
+
+	return false;
+}
+
+static void
+wait_result(BenchClient *client)
+{
+	int			sock = PQsocket(client->conn);
+
+	while (!read_result(client))
+	{
+		fd_set		input_mask;
+
+		FD_ZERO(&input_mask);
+		FD_SET(sock, &input_mask);
+		if (select(sock + 1, &input_mask, NULL, NULL, NULL) < 0 && errno != EINTR)
+		{
+			fprintf(stderr, "%s: select() failed: %s\n", progname, strerror(errno));
+			exit(1);
+		}
+	}
+}
+
+static BenchOp
+choose_op(int total_weight)
+{
+	int			r = random() % total_weight;
+	int			i;
+
+	for (i = 0; i < NUM_BENCH_OPS; i++)
+	{
+		if (r < bench_ops[i].weight)
+			return (BenchOp) i;
+		r -= bench_ops[i].weight;
+	}
+
+	Assert(false);
+	return OP_SNAPSHOT;
+}
+
+static void
+log_latency(BenchOp op, int64 usec)
+{
+	LatencyLog *log = &latencies[op];
+
+	if (log->count == log->size)
+	{
+		log->size = log->size ? log->size * 2 : 1024;
+		log->values = pg_realloc(log->values, log->size * sizeof(int64));
+	}
+	log->values[log->count++] = usec;
+}
+
+static int
+compare_int64(const void *a, const void *b)
+{
+	int64		va = *(const int64 *) a;
+	int64		vb = *(const int64 *) b;
+
+	if (va < vb)
+		return -1;
+	return va > vb ? 1 : 0;
+}
+
+/* latency in milliseconds below which fraction p of the requests are */
+static double
+percentile(LatencyLog *log, double p)
+{
+	int64		idx;
+
+	if (log->count == 0)
+		return 0.0;
+
+	idx = (int64) ceil(p * log->count) - 1;
+	if (idx < 0)
+		idx = 0;
+	if (idx >= log->count)
+		idx = log->count - 1;
+
+	return log->values[idx] / 1000.0;
+}
+
+static void
+print_report(double elapsed)
+{
+	int64		total = 0;
+	int			i;
+
+	for (i = 0; i < NUM_BENCH_OPS; i++)
+		total += latencies[i].count;
+
+	printf("number of clients: %d\n", nclients);
+	printf("number of open transactions: %d\n", nopen_xacts);
+	printf("duration: %.3f s\n", elapsed);
+	printf("requests processed: " INT64_FORMAT "\n", total);
+	printf("requests per second: %.2f\n", total / elapsed);
+	printf("\n%-10s %12s %12s %10s %10s %10s %10s\n",
+		   "request", "count", "per second",
+		   "avg (ms)", "p50 (ms)", "p99 (ms)", "p999 (ms)");
+
+	for (i = 0; i < NUM_BENCH_OPS; i++)
+	{
+		LatencyLog *log = &latencies[i];
+		double		sum = 0.0;
+		int64		j;
+
+		if (log->count == 0)
+			continue;
+
+		qsort(log->values, log->count, sizeof(int64), compare_int64);
+		for (j = 0; j < log->count; j++)
+			sum += log->values[j];
+
+		printf("%-10s %12" INT64_MODIFIER "d %12.2f %10.3f %10.3f %10.3f %10.3f\n",
+			   bench_ops[i].name,
+			   log->count,
+			   log->count / elapsed,
+			   sum / log->count / 1000.0,
+			   percentile(log, 0.50),
+			   percentile(log, 0.99),
+			   percentile(log, 0.999));
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	static struct option long_options[] = {
+		{"client", required_argument, NULL, 'c'},
+		{"dbname", required_argument, NULL, 'd'},
+		{"host", required_argument, NULL, 'h'},
+		{"mix", required_argument, NULL, 'm'},
+		{"open-xacts", required_argument, NULL, 'o'},
+		{"port", required_argument, NULL, 'p'},
+		{"sequence", required_argument, NULL, 'S'},
+		{"time", required_argument, NULL, 'T'},
+		{"username", required_argument, NULL, 'U'},
+		{NULL, 0, NULL, 0}
+	};
+
+	BenchClient *clients;
+	BenchClient *open_xacts;
+	instr_time	start_time;
+	instr_time	now;
+	double		elapsed;
+	int			total_weight;
+	int			option;
+	int			i;
+
+	progname = get_progname(argv[0]);
+
+	if (argc > 1)
+	{
+		if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-?") == 0)
+		{
+			usage();
+			exit(0);
+		}
+		if (strcmp(argv[1], "--version") == 0 || strcmp(argv[1], "-V") == 0)
+		{
+			puts("adb_agtmbench (PostgreSQL) " PG_VERSION);
+			exit(0);
+		}
+	}
+
+	while ((option = getopt_long(argc, argv, "c:d:h:m:o:p:S:T:U:",
+								 long_options, NULL)) != -1)
+	{
+		switch (option)
+		{
+			case 'c':
+				nclients = atoi(optarg);
+				if (nclients <= 0 || nclients >= FD_SETSIZE)
+				{
+					fprintf(stderr, "%s: invalid number of clients: \"%s\"\n",
+							progname, optarg);
+					exit(1);
+				}
+				break;
+			case 'd':
+				dbname = pg_strdup(optarg);
+				break;
+			case 'h':
+				pghost = pg_strdup(optarg);
+				break;
+			case 'm':
+				parse_mix(optarg);
+				break;
+			case 'o':
+				nopen_xacts = atoi(optarg);
+				if (nopen_xacts < 0)
+				{
+					fprintf(stderr, "%s: invalid number of open transactions: \"%s\"\n",
+							progname, optarg);
+					exit(1);
+				}
+				break;
+			case 'p':
+				pgport = pg_strdup(optarg);
+				break;
+			case 'S':
+				parse_sequence(optarg);
+				break;
+			case 'T':
+				duration = atoi(optarg);
+				if (duration <= 0)
+				{
+					fprintf(stderr, "%s: invalid duration: \"%s\"\n",
+							progname, optarg);
+					exit(1);
+				}
+				break;
+			case 'U':
+				username = pg_strdup(optarg);
+				break;
+			default:
+				fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
+				exit(1);
+		}
+	}
+
+	if (optind < argc)
+	{
+		fprintf(stderr, "%s: too many command-line arguments (first is \"%s\")\n",
+				progname, argv[optind]);
+		fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
+		exit(1);
+	}
+
+	if (seq_name != NULL && !mix_given)
+		bench_ops[OP_NEXTVAL].weight = 1;
+	if (bench_ops[OP_NEXTVAL].weight > 0 && seq_name == NULL)
+	{
+		fprintf(stderr, "%s: nextval requests need a sequence, use --sequence\n",
+				progname);
+		exit(1);
+	}
+
+	total_weight = 0;
+	for (i = 0; i < NUM_BENCH_OPS; i++)
+		total_weight += bench_ops[i].weight;
+	if (total_weight <= 0)
+	{
+		fprintf(stderr, "%s: request mix is empty\n", progname);
+		exit(1);
+	}
+
+	/*
+	 * Keep some transactions open with an xid assigned, every snapshot
+	 * taken during the run has to list them.
+	 */
+	open_xacts = pg_malloc0(sizeof(BenchClient) * (nopen_xacts + 1));
+	for (i = 0; i < nopen_xacts; i++)
+	{
+		BenchClient *xact = &open_xacts[i];
+		PGresult   *res;
+
+		xact->conn = connect_agtm();
+		res = PQexec(xact->conn, "BEGIN");
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		{
+			fprintf(stderr, "%s: could not begin transaction: %s",
+					progname, PQerrorMessage(xact->conn));
+			exit(1);
+		}
+		PQclear(res);
+
+		send_request(xact, OP_GXID);
+		wait_result(xact);
+	}
+
+	clients = pg_malloc0(sizeof(BenchClient) * nclients);
+	for (i = 0; i < nclients; i++)
+	{
+		clients[i].conn = connect_agtm();
+		clients[i].last_xid = FirstNormalTransactionId;
+	}
+
+	srandom((unsigned int) getpid());
+	INSTR_TIME_SET_CURRENT(start_time);
+
+	for (;;)
+	{
+		fd_set		input_mask;
+		struct timeval timeout;
+		int			maxsock = -1;
+		bool		running;
+
+		INSTR_TIME_SET_CURRENT(now);
+		INSTR_TIME_SUBTRACT(now, start_time);
+		running = INSTR_TIME_GET_DOUBLE(now) < duration;
+
+		FD_ZERO(&input_mask);
+		for (i = 0; i < nclients; i++)
+		{
+			BenchClient *client = &clients[i];
+			int			sock;
+
+			if (!client->busy)
+			{
+				if (!running)
+					continue;
+				send_request(client, choose_op(total_weight));
+			}
+
+			sock = PQsocket(client->conn);
+			FD_SET(sock, &input_mask);
+			if (sock > maxsock)
+				maxsock = sock;
+		}
+
+		/* time is up and every request got its answer */
+		if (maxsock < 0)
+			break;
+
+		timeout.tv_sec = 1;
+		timeout.tv_usec = 0;
+		if (select(maxsock + 1, &input_mask, NULL, NULL, &timeout) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "%s: select() failed: %s\n", progname, strerror(errno));
+			exit(1);
+		}
+
+		for (i = 0; i < nclients; i++)
+		{
+			BenchClient *client = &clients[i];
+
+			if (!client->busy ||
+				!FD_ISSET(PQsocket(client->conn), &input_mask))
+				continue;
+
+			if (read_result(client))
+			{
+				INSTR_TIME_SET_CURRENT(now);
+				INSTR_TIME_SUBTRACT(now, client->start);
+				log_latency(client->op, INSTR_TIME_GET_MICROSEC(now));
+			}
+		}
+	}
+
+	INSTR_TIME_SET_CURRENT(now);
+	INSTR_TIME_SUBTRACT(now, start_time);
+	elapsed = INSTR_TIME_GET_DOUBLE(now);
+
+	for (i = 0; i < nclients; i++)
+		PQfinish(clients[i].conn);
+
+	for (i = 0; i < nopen_xacts; i++)
+	{
+		PQclear(PQexec(open_xacts[i].conn, "ROLLBACK"));
+		PQfinish(open_xacts[i].conn);
+	}
+
+	print_report(elapsed);
+
+	return 0;
+}
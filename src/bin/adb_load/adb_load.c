@@ -0,0 +1,1139 @@
+/*-------------------------------------------------------------------------
+ *
+ * adb_load.c - load a table by COPY straight to its datanodes
+ *
+ * COPY FROM through a coordinator parses and routes every row in the one
+ * coordinator backend.  adb_load moves that work to the client: it reads
+ * the distribution of the table from pgxc_class, routes each input row
+ * with the same hash and modulo rules the coordinator uses (compute_hash
+ * and execModuloValue), and streams the rows to all datanodes at once.
+ *
+ * Each datanode loads its part in a transaction of its own, they are
+ * finished together by two-phase commit under one gid.  If adb_load fails
+ * between PREPARE and COMMIT PREPARED the gid is reported, the prepared
+ * transactions left on the datanodes have to be finished by hand.
+ *
+ * Input is COPY text format in the server encoding.  Tables with auxiliary
+ * tables, or distributed by other than the supported types, have to be
+ * loaded through a coordinator.
+ *
+ * Copyright (c) 2014-2017, ADB Global Development Group
+ *
+ * IDENTIFICATION
+ *		  src/bin/adb_load/adb_load.c
+ *-------------------------------------------------------------------------
+ */
+#include "postgres_fe.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#ifdef HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif
+
+#include "catalog/pg_type.h"
+#include "getopt_long.h"
+#include "libpq-fe.h"
+#include "pqexpbuffer.h"
+
+/* see pgxc/locator.h */
+#define LOCATOR_TYPE_REPLICATED		'R'
+#define LOCATOR_TYPE_HASH			'H'
+#define LOCATOR_TYPE_RROBIN			'N'
+#define LOCATOR_TYPE_MODULO			'M'
+#define LOCATOR_TYPE_HASHMAP		'B'
+
+/* rows of a datanode are sent in CopyData messages of about this size */
+#define COPY_BATCH_SIZE				(64 * 1024)
+
+typedef struct LoadNode
+{
+	char		   *name;
+	char		   *host;
+	char		   *port;
+	PGconn		   *conn;
+	PQExpBufferData	batch;			/* rows not given to libpq yet */
+	bool			pending;		/* libpq has data not sent yet */
+	int64			rows;
+	bool			prepared;
+} LoadNode;
+
+static const char  *progname;
+
+static char		   *pghost = NULL;
+static char		   *pgport = NULL;
+static char		   *username = NULL;
+static char		   *dbname = NULL;
+static char		   *table_name = NULL;
+static char		   *copy_table = NULL;	/* quoted qualified name of table */
+static char		   *input_file = NULL;
+static char			delimiter = '\t';
+static char		   *null_print = "\\N";
+
+/* distribution of the table */
+static char			locator_type;
+static Oid			dist_type = InvalidOid;
+static int			dist_field = -1;	/* of the distribution column in input */
+static LoadNode	   *nodes = NULL;
+static int			nnodes = 0;
+static int		   *bucket_map = NULL;	/* index in nodes of each bucket */
+static int			nbuckets = 0;
+
+static void usage(void);
+static PGconn *connect_node(const char *host, const char *port,
+							const char *user, const char *password,
+							const char *db, const char *encoding);
+static void read_distribution(PGconn *coord);
+static void start_load(PGconn *coord);
+static bool read_line(FILE *fp, PQExpBuffer line);
+static bool get_dist_value(const char *line, int len, PQExpBuffer value);
+static int64 parse_integer(const char *value, int64 lineno);
+static uint32 hash_any(const unsigned char *k, int keylen);
+static uint32 hash_uint32(uint32 k);
+static int	route_row(const char *line, int len, int64 lineno);
+static void add_row(LoadNode *node, const char *line, int len);
+static void send_batch(LoadNode *node);
+static void wait_pending(LoadNode *wait_for);
+static bool end_copy(void);
+static bool exec_command(LoadNode *node, const char *sql);
+static bool finish_load(PGconn *coord);
+
+static void
+usage(void)
+{
+	printf("%s loads a distributed table by COPY straight to its datanodes.\n\n", progname);
+	printf("Usage:\n");
+	printf("  %s [OPTION]... -t TABLE [FILE]\n", progname);
+	printf("\nOptions:\n");
+	printf("  -t, --table=TABLE        table to load\n");
+	printf("  -D, --delimiter=CHAR     column delimiter of input (default: tab)\n");
+	printf("  -N, --null=STRING        null string of input (default: \"\\N\")\n");
+	printf("  -V, --version            output version information, then exit\n");
+	printf("  -?, --help               show this help, then exit\n");
+	printf("\nInput is read from FILE or standard input, in COPY text format and\n");
+	printf("in the server encoding.\n");
+	printf("\nConnection options:\n");
+	printf("  -h, --host=HOSTNAME      coordinator host or socket directory\n");
+	printf("  -p, --port=PORT          coordinator port number\n");
+	printf("  -U, --username=USERNAME  connect as specified user\n");
+	printf("  -d, --dbname=DBNAME      database to connect to\n");
+}
+
+static PGconn *
+connect_node(const char *host, const char *port, const char *user,
+			 const char *password, const char *db, const char *encoding)
+{
+	const char *keywords[8];
+	const char *values[8];
+	PGconn	   *conn;
+	int			n = 0;
+
+	keywords[n] = "host";
+	values[n++] = host;
+	keywords[n] = "port";
+	values[n++] = port;
+	keywords[n] = "user";
+	values[n++] = user;
+	keywords[n] = "password";
+	values[n++] = password;
+	keywords[n] = "dbname";
+	values[n++] = db;
+	keywords[n] = "client_encoding";
+	values[n++] = encoding;
+	keywords[n] = "fallback_application_name";
+	values[n++] = progname;
+	keywords[n] = NULL;
+	values[n] = NULL;
+
+	conn = PQconnectdbParams(keywords, values, true);
+	if (PQstatus(conn) != CONNECTION_OK)
+	{
+		fprintf(stderr, "%s: could not connect to \"%s\" port %s: %s",
+				progname, host ? host : "(default)", port ? port : "(default)",
+				PQerrorMessage(conn));
+		exit(1);
+	}
+
+	return conn;
+}
+
+/*
+ * Get the distribution of the table and the datanodes storing it, nodes
+ * are in the order of pgxc_class.nodeoids, which a modulo refers to.
+ */
+static void
+read_distribution(PGconn *coord)
+{
+	PQExpBufferData	sql;
+	PGresult	   *res;
+	char		   *literal;
+	char		   *relid;
+	int				i;
+
+	literal = PQescapeLiteral(coord, table_name, strlen(table_name));
+	if (literal == NULL)
+	{
+		fprintf(stderr, "%s: %s", progname, PQerrorMessage(coord));
+		exit(1);
+	}
+
+	initPQExpBuffer(&sql);
+	appendPQExpBuffer(&sql,
+					  "SELECT c.pcrelid, c.pclocatortype,\n"
+					  "  CASE t.typtype WHEN 'd' THEN t.typbasetype ELSE t.oid END,\n"
+					  "  (SELECT count(*) FROM pg_catalog.pg_attribute b\n"
+					  "   WHERE b.attrelid = c.pcrelid AND b.attnum > 0\n"
+					  "     AND b.attnum < c.pcattnum AND NOT b.attisdropped),\n"
+					  "  EXISTS (SELECT 1 FROM pg_catalog.pg_aux_class x\n"
+					  "          WHERE x.relid = c.pcrelid),\n"
+					  "  (SELECT pg_catalog.quote_ident(n.nspname) || '.' ||\n"
+					  "          pg_catalog.quote_ident(r.relname)\n"
+					  "   FROM pg_catalog.pg_class r\n"
+					  "     JOIN pg_catalog.pg_namespace n ON n.oid = r.relnamespace\n"
+					  "   WHERE r.oid = c.pcrelid)\n"
+					  "FROM pg_catalog.pgxc_class c\n"
+					  "  LEFT JOIN pg_catalog.pg_attribute a\n"
+					  "    ON a.attrelid = c.pcrelid AND a.attnum = c.pcattnum\n"
+					  "  LEFT JOIN pg_catalog.pg_type t ON t.oid = a.atttypid\n"
+					  "WHERE c.pcrelid = %s::pg_catalog.regclass",
+					  literal);
+	PQfreemem(literal);
+
+	res = PQexec(coord, sql.data);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+	{
+		fprintf(stderr, "%s: could not get distribution of table \"%s\": %s",
+				progname, table_name, PQerrorMessage(coord));
+		exit(1);
+	}
+	if (PQntuples(res) != 1)
+	{
+		fprintf(stderr, "%s: table \"%s\" is not distributed\n",
+				progname, table_name);
+		exit(1);
+	}
+
+	relid = pg_strdup(PQgetvalue(res, 0, 0));
+	copy_table = pg_strdup(PQgetvalue(res, 0, 5));
+	locator_type = PQgetvalue(res, 0, 1)[0];
+	if (strcmp(PQgetvalue(res, 0, 4), "t") == 0)
+	{
+		fprintf(stderr, "%s: table \"%s\" has auxiliary tables, load it through a coordinator\n",
+				progname, table_name);
+		exit(1);
+	}
+
+	switch (locator_type)
+	{
+		case LOCATOR_TYPE_REPLICATED:
+		case LOCATOR_TYPE_RROBIN:
+			break;
+		case LOCATOR_TYPE_HASH:
+		case LOCATOR_TYPE_HASHMAP:
+		case LOCATOR_TYPE_MODULO:
+			dist_type = (Oid) strtoul(PQgetvalue(res, 0, 2), NULL, 10);
+			dist_field = atoi(PQgetvalue(res, 0, 3));
+			switch (dist_type)
+			{
+				case INT2OID:
+				case INT4OID:
+				case INT8OID:
+					break;
+				case OIDOID:
+				case TEXTOID:
+				case VARCHAROID:
+				case VARCHAR2OID:
+				case NVARCHAR2OID:
+				case BPCHAROID:
+					if (locator_type != LOCATOR_TYPE_MODULO)
+						break;
+					/* fall through */
+				default:
+					fprintf(stderr, "%s: distribution column type of table \"%s\" is not supported, load it through a coordinator\n",
+							progname, table_name);
+					exit(1);
+			}
+			break;
+		default:
+			fprintf(stderr, "%s: distribution type '%c' of table \"%s\" is not supported, load it through a coordinator\n",
+					progname, locator_type, table_name);
+			exit(1);
+	}
+	PQclear(res);
+
+	resetPQExpBuffer(&sql);
+	appendPQExpBuffer(&sql,
+					  "SELECT n.node_name, n.node_host, n.node_port\n"
+					  "FROM pg_catalog.pgxc_class c,\n"
+					  "  unnest(c.nodeoids::pg_catalog.oid[]) WITH ORDINALITY AS u(nodeoid, ord),\n"
+					  "  pg_catalog.pgxc_node n\n"
+					  "WHERE c.pcrelid = %s AND n.oid = u.nodeoid\n"
+					  "ORDER BY u.ord",
+					  relid);
+	res = PQexec(coord, sql.data);
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+	{
+		fprintf(stderr, "%s: could not get datanodes of table \"%s\": %s",
+				progname, table_name, PQerrorMessage(coord));
+		exit(1);
+	}
+	nnodes = PQntuples(res);
+	if (nnodes == 0)
+	{
+		fprintf(stderr, "%s: table \"%s\" has no datanode\n",
+				progname, table_name);
+		exit(1);
+	}
+
+	nodes = pg_malloc0(sizeof(LoadNode) * nnodes);
+	for (i = 0; i < nnodes; i++)
+	{
+		nodes[i].name = pg_strdup(PQgetvalue(res, i, 0));
+		nodes[i].host = pg_strdup(PQgetvalue(res, i, 1));
+		nodes[i].port = pg_strdup(PQgetvalue(res, i, 2));
+		initPQExpBuffer(&nodes[i].batch);
+	}
+
+	PQclear(res);
+
+	if (locator_type == LOCATOR_TYPE_HASHMAP)
+	{
+		resetPQExpBuffer(&sql);
+		appendPQExpBuffer(&sql,
+						  "SELECT u.idx\n"
+						  "FROM pg_catalog.pgxc_class c,\n"
+						  "  unnest(c.pcbucketmap::pg_catalog.int2[]) WITH ORDINALITY AS u(idx, ord)\n"
+						  "WHERE c.pcrelid = %s\n"
+						  "ORDER BY u.ord",
+						  relid);
+		res = PQexec(coord, sql.data);
+		if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) == 0)
+		{
+			fprintf(stderr, "%s: could not get bucket map of table \"%s\": %s",
+					progname, table_name, PQerrorMessage(coord));
+			exit(1);
+		}
+		nbuckets = PQntuples(res);
+		bucket_map = pg_malloc(sizeof(int) * nbuckets);
+		for (i = 0; i < nbuckets; i++)
+		{
+			bucket_map[i] = atoi(PQgetvalue(res, i, 0));
+			if (bucket_map[i] < 0 || bucket_map[i] >= nnodes)
+			{
+				fprintf(stderr, "%s: invalid bucket map of table \"%s\"\n",
+						progname, table_name);
+				exit(1);
+			}
+		}
+		PQclear(res);
+	}
+
+	termPQExpBuffer(&sql);
+	free(relid);
+}
+
+/*
+ * Connect to all datanodes and start COPY on each of them
+ */
+static void
+start_load(PGconn *coord)
+{
+	PQExpBufferData	sql;
+	const char	   *encoding;
+	char		   *delim_literal;
+	char		   *null_literal;
+	int				i;
+
+	/* rows are routed by their bytes, they must not be converted */
+	encoding = PQparameterStatus(coord, "server_encoding");
+
+	delim_literal = PQescapeLiteral(coord, &delimiter, 1);
+	null_literal = PQescapeLiteral(coord, null_print, strlen(null_print));
+	if (delim_literal == NULL || null_literal == NULL)
+	{
+		fprintf(stderr, "%s: %s", progname, PQerrorMessage(coord));
+		exit(1);
+	}
+
+	initPQExpBuffer(&sql);
+	appendPQExpBuffer(&sql, "COPY %s FROM STDIN WITH (DELIMITER %s, NULL %s)",
+					  copy_table, delim_literal, null_literal);
+	PQfreemem(delim_literal);
+	PQfreemem(null_literal);
+
+	for (i = 0; i < nnodes; i++)
+	{
+		LoadNode   *node = &nodes[i];
+		PGresult   *res;
+
+		node->conn = connect_node(node->host, node->port, PQuser(coord),
+								  PQpass(coord), PQdb(coord), encoding);
+		if (!exec_command(node, "BEGIN"))
+			exit(1);
+
+		res = PQexec(node->conn, sql.data);
+		if (PQresultStatus(res) != PGRES_COPY_IN)
+		{
+			fprintf(stderr, "%s: could not start COPY on datanode \"%s\": %s",
+					progname, node->name, PQerrorMessage(node->conn));
+			exit(1);
+		}
+		PQclear(res);
+
+		/* so that all datanodes are fed at once */
+		if (PQsetnonblocking(node->conn, 1) != 0)
+		{
+			fprintf(stderr, "%s: could not set nonblocking mode on datanode \"%s\": %s",
+					progname, node->name, PQerrorMessage(node->conn));
+			exit(1);
+		}
+	}
+
+	termPQExpBuffer(&sql);
+}
+
+/*
+ * Read a line of input including its newline, return false at the end
+ * of input or at the "\." end marker.
+ */
+static bool
+read_line(FILE *fp, PQExpBuffer line)
+{
+	char		buf[8192];
+
+	resetPQExpBuffer(line);
+	while (fgets(buf, sizeof(buf), fp) != NULL)
+	{
+		appendPQExpBufferStr(line, buf);
+		if (line->len > 0 && line->data[line->len - 1] == '\n')
+			break;
+	}
+	if (ferror(fp))
+	{
+		fprintf(stderr, "%s: could not read input: %s\n",
+				progname, strerror(errno));
+		exit(1);
+	}
+	if (PQExpBufferBroken(line))
+	{
+		fprintf(stderr, "%s: out of memory\n", progname);
+		exit(1);
+	}
+
+	if (line->len == 0)
+		return false;
+	if (line->data[line->len - 1] != '\n')
+		appendPQExpBufferChar(line, '\n');
+	if (strcmp(line->data, "\\.\n") == 0 ||
+		strcmp(line->data, "\\.\r\n") == 0)
+		return false;
+
+	return true;
+}
+
+/*
+ * Get the de-escaped value of the distribution column, the same way as
+ * CopyReadAttributesText.  Return false if it is null.
+ */
+static bool
+get_dist_value(const char *line, int len, PQExpBuffer value)
+{
+	const char *end = line + len;
+	const char *start;
+	const char *p;
+	int			field;
+
+	/* line has its newline */
+	while (end > line && (end[-1] == '\n' || end[-1] == '\r'))
+		end--;
+
+	p = line;
+	for (field = 0; field < dist_field && p < end; p++)
+	{
+		if (*p == '\\')
+			p++;
+		else if (*p == delimiter)
+			field++;
+	}
+	/* missing data, let COPY on the datanode complain */
+	if (field < dist_field)
+		return false;
+
+	start = p;
+	while (p < end && *p != delimiter)
+		p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+
+	if (p - start == strlen(null_print) &&
+		strncmp(start, null_print, p - start) == 0)
+		return false;
+
+	resetPQExpBuffer(value);
+	for (end = p, p = start; p < end; p++)
+	{
+		char		c = *p;
+
+		if (c == '\\' && p + 1 < end)
+		{
+			c = *++p;
+			if (c >= '0' && c <= '7')
+			{
+				int			val = c - '0';
+
+				if (p + 1 < end && p[1] >= '0' && p[1] <= '7')
+				{
+					val = (val << 3) + (*++p - '0');
+					if (p + 1 < end && p[1] >= '0' && p[1] <= '7')
+						val = (val << 3) + (*++p - '0');
+				}
+				c = val & 0377;
+			}
+			else if (c == 'x' && p + 1 < end && isxdigit((unsigned char) p[1]))
+			{
+				int			val = 0;
+				int			i;
+
+				for (i = 0; i < 2 && p + 1 < end && isxdigit((unsigned char) p[1]); i++)
+				{
+					c = *++p;
+					val = (val << 4) + (isdigit((unsigned char) c) ? c - '0' :
+										(pg_tolower((unsigned char) c) - 'a' + 10));
+				}
+				c = val & 0xff;
+			}
+			else
+			{
+				switch (c)
+				{
+					case 'b':
+						c = '\b';
+						break;
+					case 'f':
+						c = '\f';
+						break;
+					case 'n':
+						c = '\n';
+						break;
+					case 'r':
+						c = '\r';
+						break;
+					case 't':
+						c = '\t';
+						break;
+					case 'v':
+						c = '\v';
+						break;
+				}
+			}
+		}
+		appendPQExpBufferChar(value, c);
+	}
+
+	return true;
+}
+
+static int64
+parse_integer(const char *value, int64 lineno)
+{
+	char	   *endptr;
+	int64		result;
+
+	errno = 0;
+	result = strtoll(value, &endptr, 10);
+	while (*endptr != '\0' && isspace((unsigned char) *endptr))
+		endptr++;
+	if (errno != 0 || endptr == value || *endptr != '\0')
+	{
+		fprintf(stderr, "%s: invalid distribution column value \"%s\" at line " INT64_FORMAT "\n",
+				progname, value, lineno);
+		exit(1);
+	}
+
+	return result;
+}
+
+/*
+ * hash_any and hash_uint32 are copies of the ones in hashfunc.c, which
+ * route rows on coordinators, only the path for unaligned data is kept
+ * since both paths have the same result.
+ */
+#define rot(x,k) (((x)<<(k)) | ((x)>>(32-(k))))
+
+#define mix(a,b,c) \
+{ \
+  a -= c;  a ^= rot(c, 4);	c += b; \
+  b -= a;  b ^= rot(a, 6);	a += c; \
+  c -= b;  c ^= rot(b, 8);	b += a; \
+  a -= c;  a ^= rot(c,16);	c += b; \
+  b -= a;  b ^= rot(a,19);	a += c; \
+  c -= b;  c ^= rot(b, 4);	b += a; \
+}
+
+#define final(a,b,c) \
+{ \
+  c ^= b; c -= rot(b,14); \
+  a ^= c; a -= rot(c,11); \
+  b ^= a; b -= rot(a,25); \
+  c ^= b; c -= rot(b,16); \
+  a ^= c; a -= rot(c, 4); \
+  b ^= a; b -= rot(a,14); \
+  c ^= b; c -= rot(b,24); \
+}
+
+static uint32
+hash_any(const unsigned char *k, int keylen)
+{
+	uint32		a,
+				b,
+				c,
+				len;
+
+	len = keylen;
+	a = b = c = 0x9e3779b9 + len + 3923095;
+
+	while (len >= 12)
+	{
+#ifdef WORDS_BIGENDIAN
+		a += (k[3] + ((uint32) k[2] << 8) + ((uint32) k[1] << 16) + ((uint32) k[0] << 24));
+		b += (k[7] + ((uint32) k[6] << 8) + ((uint32) k[5] << 16) + ((uint32) k[4] << 24));
+		c += (k[11] + ((uint32) k[10] << 8) + ((uint32) k[9] << 16) + ((uint32) k[8] << 24));
+#else							/* !WORDS_BIGENDIAN */
+		a += (k[0] + ((uint32) k[1] << 8) + ((uint32) k[2] << 16) + ((uint32) k[3] << 24));
+		b += (k[4] + ((uint32) k[5] << 8) + ((uint32) k[6] << 16) + ((uint32) k[7] << 24));
+		c += (k[8] + ((uint32) k[9] << 8) + ((uint32) k[10] << 16) + ((uint32) k[11] << 24));
+#endif   /* WORDS_BIGENDIAN */
+		mix(a, b, c);
+		k += 12;
+		len -= 12;
+	}
+
+#ifdef WORDS_BIGENDIAN
+	switch (len)			/* all the case statements fall through */
+	{
+		case 11:
+			c += ((uint32) k[10] << 8);
+		case 10:
+			c += ((uint32) k[9] << 16);
+		case 9:
+			c += ((uint32) k[8] << 24);
+		case 8:
+			b += k[7];
+		case 7:
+			b += ((uint32) k[6] << 8);
+		case 6:
+			b += ((uint32) k[5] << 16);
+		case 5:
+			b += ((uint32) k[4] << 24);
+		case 4:
+			a += k[3];
+		case 3:
+			a += ((uint32) k[2] << 8);
+		case 2:
+			a += ((uint32) k[1] << 16);
+		case 1:
+			a += ((uint32) k[0] << 24);
+	}
+#else							/* !WORDS_BIGENDIAN */
+	switch (len)			/* all the case statements fall through */
+	{
+		case 11:
+			c += ((uint32) k[10] << 24);
+		case 10:
+			c += ((uint32) k[9] << 16);
+		case 9:
+			c += ((uint32) k[8] << 8);
+		case 8:
+			b += ((uint32) k[7] << 24);
+		case 7:
+			b += ((uint32) k[6] << 16);
+		case 6:
+			b += ((uint32) k[5] << 8);
+		case 5:
+			b += k[4];
+		case 4:
+			a += ((uint32) k[3] << 24);
+		case 3:
+			a += ((uint32) k[2] << 16);
+		case 2:
+			a += ((uint32) k[1] << 8);
+		case 1:
+			a += k[0];
+	}
+#endif   /* WORDS_BIGENDIAN */
+
+	final(a, b, c);
+
+	return c;
+}
+
+static uint32
+hash_uint32(uint32 k)
+{
+	uint32		a,
+				b,
+				c;
+
+	a = b = c = 0x9e3779b9 + (uint32) sizeof(uint32) + 3923095;
+	a += k;
+
+	final(a, b, c);
+
+	return c;
+}
+
+/*
+ * Get index in nodes of the datanode storing the row, -1 means all of
+ * them.  Same as GetInvolvedNodes for INSERT: a null goes to the first
+ * node, others to abs(hash % nnodes) or abs(value % nnodes). A hashmap
+ * table sends a row to the node of bucket abs(hash % nbuckets) instead,
+ * a null to the node of the first bucket.
+ */
+static int
+route_row(const char *line, int len, int64 lineno)
+{
+	static int		rrobin_node = -1;
+	static PQExpBuffer value = NULL;
+	int64			modulo;
+
+	if (locator_type == LOCATOR_TYPE_REPLICATED)
+		return -1;
+	if (locator_type == LOCATOR_TYPE_RROBIN)
+	{
+		rrobin_node = (rrobin_node + 1) % nnodes;
+		return rrobin_node;
+	}
+
+	if (value == NULL)
+		value = createPQExpBuffer();
+	if (!get_dist_value(line, len, value))
+		return locator_type == LOCATOR_TYPE_HASHMAP ? bucket_map[0] : 0;
+
+	if (locator_type == LOCATOR_TYPE_MODULO)
+	{
+		modulo = parse_integer(value->data, lineno) % nnodes;
+	}else
+	{
+		uint32		hash;
+
+		switch (dist_type)
+		{
+			case INT8OID:
+				{
+					/* as hashint8 */
+					int64		val = parse_integer(value->data, lineno);
+					uint32		lohalf = (uint32) val;
+					uint32		hihalf = (uint32) (val >> 32);
+
+					lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+					hash = hash_uint32(lohalf);
+				}
+				break;
+			case INT2OID:
+			case INT4OID:
+				hash = hash_uint32((uint32) (int32) parse_integer(value->data, lineno));
+				break;
+			case OIDOID:
+				hash = hash_uint32((uint32) parse_integer(value->data, lineno));
+				break;
+			case BPCHAROID:
+				{
+					/* as hashbpchar, trailing spaces are not significant */
+					int			keylen = value->len;
+
+					while (keylen > 0 && value->data[keylen - 1] == ' ')
+						keylen--;
+					hash = hash_any((unsigned char *) value->data, keylen);
+				}
+				break;
+			default:
+				hash = hash_any((unsigned char *) value->data, value->len);
+				break;
+		}
+		if (locator_type == LOCATOR_TYPE_HASHMAP)
+		{
+			modulo = ((int32) hash) % nbuckets;
+			return bucket_map[modulo < 0 ? -modulo : modulo];
+		}
+		modulo = ((int32) hash) % nnodes;
+	}
+
+	return (int) (modulo < 0 ? -modulo : modulo);
+}
+
+static void
+add_row(LoadNode *node, const char *line, int len)
+{
+	appendBinaryPQExpBuffer(&node->batch, line, len);
+	if (PQExpBufferBroken(&node->batch))
+	{
+		fprintf(stderr, "%s: out of memory\n", progname);
+		exit(1);
+	}
+	node->rows++;
+
+	if (node->batch.len >= COPY_BATCH_SIZE)
+	{
+		/* stop reading input until the datanode took the batch before */
+		if (node->pending)
+			wait_pending(node);
+		send_batch(node);
+	}
+}
+
+/*
+ * Give rows of node to libpq as one CopyData message, libpq sends as much
+ * as the datanode takes without blocking.
+ */
+static void
+send_batch(LoadNode *node)
+{
+	int			ret;
+
+	if (node->batch.len == 0)
+		return;
+
+	if (PQputCopyData(node->conn, node->batch.data, node->batch.len) != 1 ||
+		(ret = PQflush(node->conn)) < 0)
+	{
+		fprintf(stderr, "%s: could not send data to datanode \"%s\": %s",
+				progname, node->name, PQerrorMessage(node->conn));
+		exit(1);
+	}
+	node->pending = (ret == 1);
+	resetPQExpBuffer(&node->batch);
+}
+
+/*
+ * Send data pending in libpq of all datanodes, until wait_for has none
+ * left, or all of them if wait_for is NULL.
+ */
+static void
+wait_pending(LoadNode *wait_for)
+{
+	fd_set		output_mask;
+	int			maxsock;
+	int			ret;
+	int			i;
+
+	for (;;)
+	{
+		FD_ZERO(&output_mask);
+		maxsock = -1;
+		for (i = 0; i < nnodes; i++)
+		{
+			LoadNode   *node = &nodes[i];
+			int			sock;
+
+			if (!node->pending)
+				continue;
+			if ((ret = PQflush(node->conn)) < 0)
+			{
+				fprintf(stderr, "%s: could not send data to datanode \"%s\": %s",
+						progname, node->name, PQerrorMessage(node->conn));
+				exit(1);
+			}
+			node->pending = (ret == 1);
+			if (!node->pending)
+				continue;
+
+			sock = PQsocket(node->conn);
+			FD_SET(sock, &output_mask);
+			if (sock > maxsock)
+				maxsock = sock;
+		}
+		if (wait_for != NULL ? !wait_for->pending : maxsock < 0)
+			break;
+
+		if (select(maxsock + 1, NULL, &output_mask, NULL, NULL) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "%s: select() failed: %s\n", progname, strerror(errno));
+			exit(1);
+		}
+	}
+}
+
+/*
+ * End COPY on all datanodes, return false if any of them failed
+ */
+static bool
+end_copy(void)
+{
+	bool		ok = true;
+	int			i;
+
+	for (i = 0; i < nnodes; i++)
+	{
+		send_batch(&nodes[i]);
+		if (PQputCopyEnd(nodes[i].conn, NULL) != 1)
+		{
+			fprintf(stderr, "%s: could not end COPY on datanode \"%s\": %s",
+					progname, nodes[i].name, PQerrorMessage(nodes[i].conn));
+			exit(1);
+		}
+		/* CopyDone may be left in libpq */
+		nodes[i].pending = true;
+	}
+	wait_pending(NULL);
+
+	for (i = 0; i < nnodes; i++)
+	{
+		LoadNode   *node = &nodes[i];
+		PGresult   *res;
+
+		PQsetnonblocking(node->conn, 0);
+		while ((res = PQgetResult(node->conn)) != NULL)
+		{
+			if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			{
+				fprintf(stderr, "%s: COPY failed on datanode \"%s\": %s",
+						progname, node->name, PQresultErrorMessage(res));
+				ok = false;
+			}
+			PQclear(res);
+		}
+	}
+
+	return ok;
+}
+
+static bool
+exec_command(LoadNode *node, const char *sql)
+{
+	PGresult   *res;
+
+	res = PQexec(node->conn, sql);
+	if (PQresultStatus(res) != PGRES_COMMAND_OK)
+	{
+		fprintf(stderr, "%s: \"%s\" failed on datanode \"%s\": %s",
+				progname, sql, node->name, PQerrorMessage(node->conn));
+		PQclear(res);
+		return false;
+	}
+	PQclear(res);
+
+	return true;
+}
+
+/*
+ * Commit on all datanodes having rows, by two-phase commit if more than
+ * one of them has.  Return false if nothing is committed.
+ */
+static bool
+finish_load(PGconn *coord)
+{
+	char		gid[NAMEDATALEN];
+	char		sql[NAMEDATALEN + 32];
+	int			nloaded = 0;
+	bool		ok = true;
+	int			i;
+
+	/* a datanode without rows has nothing to commit */
+	for (i = 0; i < nnodes; i++)
+	{
+		if (nodes[i].rows == 0)
+			exec_command(&nodes[i], "ROLLBACK");
+		else
+			nloaded++;
+	}
+
+	if (nloaded <= 1)
+	{
+		for (i = 0; i < nnodes; i++)
+		{
+			if (nodes[i].rows > 0 && !exec_command(&nodes[i], "COMMIT"))
+				return false;
+		}
+		return true;
+	}
+
+	snprintf(gid, sizeof(gid), "adb_load_%d_%ld_%d",
+			 (int) getpid(), (long) time(NULL), PQbackendPID(coord));
+
+	snprintf(sql, sizeof(sql), "PREPARE TRANSACTION '%s'", gid);
+	for (i = 0; i < nnodes && ok; i++)
+	{
+		if (nodes[i].rows == 0)
+			continue;
+		ok = exec_command(&nodes[i], sql);
+		nodes[i].prepared = ok;
+	}
+
+	if (!ok)
+	{
+		snprintf(sql, sizeof(sql), "ROLLBACK PREPARED '%s'", gid);
+		for (i = 0; i < nnodes; i++)
+		{
+			if (nodes[i].prepared && !exec_command(&nodes[i], sql))
+				fprintf(stderr, "%s: transaction \"%s\" is left prepared on datanode \"%s\"\n",
+						progname, gid, nodes[i].name);
+		}
+		return false;
+	}
+
+	snprintf(sql, sizeof(sql), "COMMIT PREPARED '%s'", gid);
+	for (i = 0; i < nnodes; i++)
+	{
+		if (nodes[i].prepared && !exec_command(&nodes[i], sql))
+		{
+			fprintf(stderr, "%s: transaction \"%s\" is left prepared on datanode \"%s\", commit it by \"%s\"\n",
+					progname, gid, nodes[i].name, sql);
+			ok = false;
+		}
+	}
+	if (!ok)
+		exit(1);
+
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	static struct option long_options[] = {
+		{"dbname", required_argument, NULL, 'd'},
+		{"delimiter", required_argument, NULL, 'D'},
+		{"host", required_argument, NULL, 'h'},
+		{"null", required_argument, NULL, 'N'},
+		{"port", required_argument, NULL, 'p'},
+		{"table", required_argument, NULL, 't'},
+		{"username", required_argument, NULL, 'U'},
+		{NULL, 0, NULL, 0}
+	};
+
+	PGconn		   *coord;
+	FILE		   *fp;
+	PQExpBufferData	line;
+	int64			lineno;
+	int64			total;
+	int				option;
+	int				i;
+
+	progname = get_progname(argv[0]);
+
+	if (argc > 1)
+	{
+		if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-?") == 0)
+		{
+			usage();
+			exit(0);
+		}
+		if (strcmp(argv[1], "--version") == 0 || strcmp(argv[1], "-V") == 0)
+		{
+			puts("adb_load (PostgreSQL) " PG_VERSION);
+			exit(0);
+		}
+	}
+
+	while ((option = getopt_long(argc, argv, "d:D:h:N:p:t:U:",
+								 long_options, NULL)) != -1)
+	{
+		switch (option)
+		{
+			case 'd':
+				dbname = pg_strdup(optarg);
+				break;
+			case 'D':
+				if (strlen(optarg) != 1 || optarg[0] == '\\' ||
+					optarg[0] == '\n' || optarg[0] == '\r')
+				{
+					fprintf(stderr, "%s: invalid delimiter: \"%s\"\n",
+							progname, optarg);
+					exit(1);
+				}
+				delimiter = optarg[0];
+				break;
+			case 'h':
+				pghost = pg_strdup(optarg);
+				break;
+			case 'N':
+				null_print = pg_strdup(optarg);
+				break;
+			case 'p':
+				pgport = pg_strdup(optarg);
+				break;
+			case 't':
+				table_name = pg_strdup(optarg);
+				break;
+			case 'U':
+				username = pg_strdup(optarg);
+				break;
+			default:
+				fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
+				exit(1);
+		}
+	}
+
+	if (optind < argc)
+		input_file = argv[optind++];
+	if (optind < argc)
+	{
+		fprintf(stderr, "%s: too many command-line arguments (first is \"%s\")\n",
+				progname, argv[optind]);
+		fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
+		exit(1);
+	}
+	if (table_name == NULL)
+	{
+		fprintf(stderr, "%s: no table specified, use --table\n", progname);
+		fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
+		exit(1);
+	}
+
+	if (input_file == NULL)
+	{
+		fp = stdin;
+	}else
+	{
+		fp = fopen(input_file, "r");
+		if (fp == NULL)
+		{
+			fprintf(stderr, "%s: could not open file \"%s\": %s\n",
+					progname, input_file, strerror(errno));
+			exit(1);
+		}
+	}
+
+	coord = connect_node(pghost, pgport, username, NULL, dbname, NULL);
+	read_distribution(coord);
+	start_load(coord);
+
+	initPQExpBuffer(&line);
+	for (lineno = 1; read_line(fp, &line); lineno++)
+	{
+		int			node = route_row(line.data, line.len, lineno);
+
+		if (node >= 0)
+		{
+			add_row(&nodes[node], line.data, line.len);
+			continue;
+		}
+		for (i = 0; i < nnodes; i++)
+			add_row(&nodes[i], line.data, line.len);
+	}
+	termPQExpBuffer(&line);
+	if (fp != stdin)
+		fclose(fp);
+
+	if (!end_copy() || !finish_load(coord))
+	{
+		fprintf(stderr, "%s: nothing is loaded\n", progname);
+		exit(1);
+	}
+
+	total = 0;
+	for (i = 0; i < nnodes; i++)
+	{
+		printf("%-20s " INT64_FORMAT "\n", nodes[i].name, nodes[i].rows);
+		total += nodes[i].rows;
+		PQfinish(nodes[i].conn);
+	}
+	if (locator_type == LOCATOR_TYPE_REPLICATED && nnodes > 0)
+		total /= nnodes;
+	printf("rows loaded: " INT64_FORMAT "\n", total);
+
+	PQfinish(coord);
+
+	return 0;
+}
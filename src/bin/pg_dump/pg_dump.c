@@ -5376,6 +5376,7 @@ getTables(Archive *fout, int *numTables)
 #ifdef ADB
 	int 		i_pgxclocatortype;
 	int 		i_pgxcattnum;
+	int 		i_pgxcrangebounds;
 	int 		i_pgxc_node_names;
 #endif
 	int			i_reltablespace;
@@ -5456,6 +5457,7 @@ getTables(Archive *fout, int *numTables)
 #ifdef ADB
 						  "(SELECT pclocatortype from pgxc_class v where v.pcrelid = c.oid) AS pgxclocatortype,"
 						  "(SELECT pcattnum from pgxc_class v where v.pcrelid = c.oid) AS pgxcattnum,"
+						  "(SELECT array_to_string(ARRAY(SELECT quote_literal(b) FROM unnest(v.pcrangebounds::text::text[]) b), ', ') from pgxc_class v where v.pcrelid = c.oid) AS pgxcrangebounds,"
 						  "(SELECT '\"' || string_agg(node_name,'\",\"') || '\"' AS pgxc_node_names from pgxc_node n where n.oid in (select unnest(nodeoids) from pgxc_class v where v.pcrelid=c.oid) ) , "
 #endif
 						  "array_remove(array_remove(c.reloptions,'check_option=local'),'check_option=cascaded') AS reloptions, "
@@ -5538,6 +5540,7 @@ getTables(Archive *fout, int *numTables)
 #ifdef ADB
 						  "(SELECT pclocatortype from pgxc_class v where v.pcrelid = c.oid) AS pgxclocatortype,"
 						  "(SELECT pcattnum from pgxc_class v where v.pcrelid = c.oid) AS pgxcattnum,"
+						  "(SELECT array_to_string(ARRAY(SELECT quote_literal(b) FROM unnest(v.pcrangebounds::text::text[]) b), ', ') from pgxc_class v where v.pcrelid = c.oid) AS pgxcrangebounds,"
 						  "(SELECT '\"' || string_agg(node_name,'\",\"') || '\"' AS pgxc_node_names from pgxc_node n where n.oid in (select unnest(nodeoids) from pgxc_class v where v.pcrelid=c.oid) ) , "
 #endif
 
@@ -5590,6 +5593,7 @@ getTables(Archive *fout, int *numTables)
 #ifdef ADB
 						  "(SELECT pclocatortype from pgxc_class v where v.pcrelid = c.oid) AS pgxclocatortype,"
 						  "(SELECT pcattnum from pgxc_class v where v.pcrelid = c.oid) AS pgxcattnum,"
+						  "(SELECT array_to_string(ARRAY(SELECT quote_literal(b) FROM unnest(v.pcrangebounds::text::text[]) b), ', ') from pgxc_class v where v.pcrelid = c.oid) AS pgxcrangebounds,"
 						  "(SELECT '\"' || string_agg(node_name,'\",\"') || '\"' AS pgxc_node_names from pgxc_node n where n.oid in (select unnest(nodeoids) from pgxc_class v where v.pcrelid=c.oid) ) , "
 #endif
 						  "array_remove(array_remove(c.reloptions,'check_option=local'),'check_option=cascaded') AS reloptions, "
@@ -5642,6 +5646,7 @@ getTables(Archive *fout, int *numTables)
 #ifdef ADB
 						  "(SELECT pclocatortype from pgxc_class v where v.pcrelid = c.oid) AS pgxclocatortype,"
 						  "(SELECT pcattnum from pgxc_class v where v.pcrelid = c.oid) AS pgxcattnum,"
+						  "(SELECT array_to_string(ARRAY(SELECT quote_literal(b) FROM unnest(v.pcrangebounds::text::text[]) b), ', ') from pgxc_class v where v.pcrelid = c.oid) AS pgxcrangebounds,"
 						  "(SELECT '\"' || string_agg(node_name,'\",\"') || '\"' AS pgxc_node_names from pgxc_node n where n.oid in (select unnest(nodeoids) from pgxc_class v where v.pcrelid=c.oid) ) , "
 #endif
 
@@ -6077,6 +6082,7 @@ getTables(Archive *fout, int *numTables)
 #ifdef ADB
 	i_pgxclocatortype = PQfnumber(res, "pgxclocatortype");
 	i_pgxcattnum = PQfnumber(res, "pgxcattnum");
+	i_pgxcrangebounds = PQfnumber(res, "pgxcrangebounds");
 	i_pgxc_node_names = PQfnumber(res, "pgxc_node_names");
 #endif
 
@@ -6155,11 +6161,16 @@ getTables(Archive *fout, int *numTables)
 		{
 			tblinfo[i].pgxclocatortype = 'E';
 			tblinfo[i].pgxcattnum = 0;
+			tblinfo[i].pgxcrangebounds = NULL;
 		}
 		else
 		{
 			tblinfo[i].pgxclocatortype = *(PQgetvalue(res, i, i_pgxclocatortype));
 			tblinfo[i].pgxcattnum = atoi(PQgetvalue(res, i, i_pgxcattnum));
+			if (PQgetisnull(res, i, i_pgxcrangebounds))
+				tblinfo[i].pgxcrangebounds = NULL;
+			else
+				tblinfo[i].pgxcrangebounds = pg_strdup(PQgetvalue(res, i, i_pgxcrangebounds));
 		}
 		tblinfo[i].pgxc_node_names = pg_strdup(PQgetvalue(res, i, i_pgxc_node_names));
 #endif
@@ -15526,12 +15537,30 @@ dumpTableSchema(Archive *fout, TableInfo *tbinfo)
 				appendPQExpBuffer(q, "\nDISTRIBUTE BY HASH (%s)",
 					fmtId(tbinfo->attnames[hashkey - 1]));
 			}
+			/* B: DISTRIBUTE BY HASHMAP */
+			else if (tbinfo->pgxclocatortype == 'B')
+			{
+				int hashkey = tbinfo->pgxcattnum;
+				appendPQExpBuffer(q, "\nDISTRIBUTE BY HASHMAP (%s)",
+					fmtId(tbinfo->attnames[hashkey - 1]));
+			}
 			else if (tbinfo->pgxclocatortype == 'M')
 			{
 				int hashkey = tbinfo->pgxcattnum;
 				appendPQExpBuffer(q, "\nDISTRIBUTE BY MODULO (%s)",
 				fmtId(tbinfo->attnames[hashkey - 1]));
 			}
+			/* G: DISTRIBUTE BY RANGE */
+			else if (tbinfo->pgxclocatortype == 'G')
+			{
+				int rangekey = tbinfo->pgxcattnum;
+				appendPQExpBuffer(q, "\nDISTRIBUTE BY RANGE (%s",
+					fmtId(tbinfo->attnames[rangekey - 1]));
+				if (tbinfo->pgxcrangebounds != NULL &&
+					tbinfo->pgxcrangebounds[0] != '\0')
+					appendPQExpBuffer(q, ", %s", tbinfo->pgxcrangebounds);
+				appendPQExpBufferChar(q, ')');
+			}
 		}
 		if (include_nodes &&
 			tbinfo->pgxc_node_names != NULL &&
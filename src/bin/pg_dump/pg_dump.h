@@ -292,6 +292,7 @@ typedef struct _tableInfo
 		/* PGXC table locator Data */
 		char		pgxclocatortype;	/* Type of PGXC table locator */
 		int 		pgxcattnum; 	/* Number of the attribute the table is partitioned with */
+		char		*pgxcrangebounds;	/* Quoted upper bounds of nodes for range */
 		char		*pgxc_node_names;	/* List of node names where this table is distributed */
 #endif
 
@@ -27,8 +27,10 @@
 #ifdef ADB
 #define LOCATOR_TYPE_REPLICATED 'R'
 #define LOCATOR_TYPE_HASH 'H'
+#define LOCATOR_TYPE_HASHMAP 'B'
 #define LOCATOR_TYPE_RROBIN 'N'
 #define LOCATOR_TYPE_MODULO 'M'
+#define LOCATOR_TYPE_RANGE 'G'
 #define LOCATOR_TYPE_USER_DEFINED 'U'
 #endif
 
@@ -2695,8 +2697,13 @@ describeOneTableDetails(const char *schemaname,
 						"		  WHEN '%c' THEN \n"
 						"		   'HASH' || '(' || a.attname || ')' \n"
 						"		  WHEN '%c' THEN \n"
+						"		   'HASHMAP' || '(' || a.attname || ')' \n"
+						"		  WHEN '%c' THEN \n"
 						"		   'MODULO' || '(' || a.attname || ')' \n"
 						"		  WHEN '%c' THEN \n"
+						"		   'RANGE' || '(' || a.attname || ', ' || \n"
+						"		   array_to_string(c.pcrangebounds::text::text[], ', ') || ')' \n"
+						"		  WHEN '%c' THEN \n"
 						"		   (SELECT proname FROM pg_catalog.pg_proc WHERE oid = pcfuncid) || '(' || \n"
 						"		   array_to_string(ARRAY \n"
 						"						   (SELECT attname \n"
@@ -2730,7 +2737,9 @@ describeOneTableDetails(const char *schemaname,
 					, LOCATOR_TYPE_RROBIN
 					, LOCATOR_TYPE_REPLICATED
 					, LOCATOR_TYPE_HASH
+					, LOCATOR_TYPE_HASHMAP
 					, LOCATOR_TYPE_MODULO
+					, LOCATOR_TYPE_RANGE
 					, LOCATOR_TYPE_USER_DEFINED
 					, oid
 					, oid
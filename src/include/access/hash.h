@@ -373,6 +373,8 @@ extern const char *hash_identify(uint8 info);
 #ifdef ADB
 extern Datum compute_hash(Oid type, Datum value, char locator);
 extern char *get_compute_hash_function(Oid type, char locator);
+extern bool hash_datum_array(Oid hashfunc, const Datum *values, const bool *nulls,
+				 int nvalues, uint32 *hashes);
 #endif
 
 #endif   /* HASH_H */
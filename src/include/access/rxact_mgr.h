@@ -25,6 +25,8 @@ typedef struct RxactTransactionInfo
 	bool failed;			/* backend do it failed ? */
 }RxactTransactionInfo;
 
+extern int RxactGroupCommitDelay;
+
 extern void RemoteXactMgrMain(void) __attribute__((noreturn));
 
 extern bool RecordRemoteXact(const char *gid, Oid *node_oids, int count, RemoteXactType type, bool no_error);
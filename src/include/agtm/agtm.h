@@ -21,6 +21,8 @@
 #define CLIENT_AGTM_TIMEOUT 20
 #endif
 
+extern bool AGtmPrefetchSnapshot;
+
 #define IsNormalDatabase()	(MyDatabaseId != InvalidOid &&		\
 							 MyDatabaseId != TemplateDbOid)
 
@@ -46,6 +48,13 @@ extern TransactionId agtm_GetGlobalTransactionId(bool isSubXact);
  */
 extern Snapshot agtm_GetGlobalSnapShot(Snapshot snapshot);
 
+/*
+ * send Snapshot request to AGTM ahead of need, and drop it when the
+ * statement is done
+ */
+extern void agtm_PrefetchGlobalSnapShot(void);
+extern void agtm_ReleasePrefetchedSnapShot(void);
+
 /*
  * get transaction status from AGTM by transaction ID.
  */
@@ -110,6 +119,12 @@ extern void agtm_RenameSeuqneceByDataBase(const char * oldDatabase,
  */
 extern AGTM_Sequence agtm_GetSeqNextVal(const char *seqname, const char * database,	const char * schema);
 
+/*
+ * lease a range of Sequence values from AGTM
+ */
+extern AGTM_Sequence agtm_GetSeqNextRange(const char *seqname, const char * database,
+			const char * schema, AGTM_Sequence count, AGTM_Sequence *last);
+
 /*
  * get current Sequence from AGTM
  */
@@ -45,4 +45,10 @@ extern StringInfo agtm_use_result_type(const struct pg_result *res, StringInfo b
 extern void agtm_check_result(StringInfo buf, AGTM_ResultType type);
 extern void agtm_use_result_end(struct pg_result *res, StringInfo buf);
 
+/*
+ * read or forget the reply of a request sent ahead by agtm_PrefetchGlobalSnapShot
+ */
+extern void agtm_CompletePrefetch(void);
+extern void agtm_ForgetPrefetch(void);
+
 #endif
@@ -38,9 +38,10 @@ typedef enum AGTM_MessageType
 	AGTM_MSG_SEQUENCE_GET_LAST,	/* Get the last sequence value of sequence */
 	AGTM_MSG_SEQUENCE_SET_VAL,	/* Set values for sequence */
 	AGTM_MSG_SEQUENCE_RESET_CACHE, /* Reset agtm cache */
-	AGTM_MSG_GET_STATUS			/* Get status of a given transaction */
+	AGTM_MSG_GET_STATUS,		/* Get status of a given transaction */
+	AGTM_MSG_SEQUENCE_GET_RANGE	/* Lease a range of sequence values */
 } AGTM_MessageType;
-#define AGTM_MSG_TYPE_COUNT (AGTM_MSG_GET_STATUS+1)
+#define AGTM_MSG_TYPE_COUNT (AGTM_MSG_SEQUENCE_GET_RANGE+1)
 
 /*
  * Symbols in the following enum are usd in result_name_tab defined in agtm_utils.c.
@@ -66,9 +67,10 @@ typedef enum AGTM_ResultType
 	AGTM_SEQUENCE_GET_LAST_RESULT,
 	AGTM_SEQUENCE_SET_VAL_RESULT,
 	AGTM_MSG_SEQUENCE_RESET_CACHE_RESULT,
-	AGTM_COMPLETE_RESULT			/* for no message result */
+	AGTM_COMPLETE_RESULT,			/* for no message result */
+	AGTM_SEQUENCE_GET_RANGE_RESULT
 } AGTM_ResultType;
-#define AGTM_RESULT_TYPE_COUNT (AGTM_COMPLETE_RESULT+1)
+#define AGTM_RESULT_TYPE_COUNT (AGTM_SEQUENCE_GET_RANGE_RESULT+1)
 
 typedef enum AgtmNodeTag
 {
@@ -20,6 +20,12 @@
 
 StringInfo ProcessNextSeqCommand(StringInfo message, StringInfo output);
 
+/*
+ *  lease a contiguous range of values for a coordinator-wide sequence cache,
+ *  respond the first and the last value of the range
+ */
+StringInfo ProcessNextSeqRangeCommand(StringInfo message, StringInfo output);
+
 /*
  *  select currval('seq1') will call this fucntion.function currval('sequence') called
  *  must after nextval('sequence') called and in the same session .otherwise function
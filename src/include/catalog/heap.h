@@ -152,7 +152,10 @@ extern void GetRelationDistributionItems(Oid relid,
 				AttrNumber *attnum,
 				Oid *funcid,
 				int *numatts,
-				int16 **attnums);
+				int16 **attnums,
+				ArrayType **rangebounds);
+
+extern void CheckRangeDistributionBounds(int numbounds, int numnodes);
 
 extern Oid *GetRelationDistributionNodes(PGXCSubCluster *subcluster, int *numnodes);
 
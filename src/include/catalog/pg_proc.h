@@ -5566,6 +5566,10 @@ DATA(insert OID = 5402 ( ora_date_mi_interval	ORANSP PGUID 12 1 0 0 0 f f f f t
 
 DATA(insert OID = 3372 (  pool_close_idle_conn		PGNSP PGUID 12 1 0 0 0 f f f f f f v s 0 0 16 "" _null_ _null_ _null_ _null_ _null_ pool_close_idle_conn _null_ _null_ _null_ ));
 DESCR("close pool connection in  idle_slot");
+DATA(insert OID = 3377 (  pool_params_stats		PGNSP PGUID 12 1 0 0 0 f f f f t f v s 0 0 2249 "" "{20,20}" "{o,o}" "{hits,misses}" _null_ _null_ pool_params_stats _null_ _null_ _null_ ));
+DESCR("statistics of reusing pooled connections by session params");
+DATA(insert OID = 3378 (  pg_stat_get_pool		PGNSP PGUID 12 1 100 0 0 f f f f f t v r 0 0 2249 "" "{23,19,19,25,23,23,23,23,23,20,20,20,701,1016,20,20,20,20,20,20,20}" "{o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o,o}" "{shard,datname,usename,host,port,uninit_slots,idle_slots,busy_slots,released_slots,connects,connect_failures,acquires,acquire_wait_time,acquire_wait_hist,params_replays,reset_alls,destroy_close,destroy_timeout,destroy_broken,destroy_error,destroy_temp}" _null_ _null_ pg_stat_get_pool _null_ _null_ _null_ ));
+DESCR("statistics: connection pools of pool manager");
 
 DATA(insert OID = 3373 ( sync_cluster_xid	 PGNSP PGUID 12 10 100 0 0 f f f f t t s s 0 0 2249 "" "{19,28,28}" "{o,o,o}" "{node,local,agtm}" _null_ _null_ sync_cluster_xid _null_ _null_ _null_ ));
 DESCR("synchronize the whole cluster next XID with AGTM");
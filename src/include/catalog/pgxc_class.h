@@ -13,6 +13,7 @@
 #else /* BUILD_BKI */
 #include "catalog/genbki.h"
 #include "nodes/parsenodes.h"
+#include "utils/array.h"
 #endif /* BUILD_BKI */
 
 #define PgxcClassRelationId  9001
@@ -29,12 +30,15 @@ CATALOG(pgxc_class,9001) BKI_WITHOUT_OIDS
 	oidvector	nodeoids;			/* List of nodes used by table */
 #ifdef CATALOG_VARLEN
 	int2vector	pcfuncattnums;		/* List of column number of distribution */
+	int2vector	pcbucketmap;		/* Index in nodeoids of each hashmap bucket */
+	anyarray	pcrangebounds;		/* Upper bound of each node but the last
+									 * for range, in the column type */
 #endif
 } FormData_pgxc_class;
 
 typedef FormData_pgxc_class *Form_pgxc_class;
 
-#define Natts_pgxc_class					8
+#define Natts_pgxc_class					10
 
 #define Anum_pgxc_class_pcrelid				1
 #define Anum_pgxc_class_pclocatortype		2
@@ -44,6 +48,8 @@ typedef FormData_pgxc_class *Form_pgxc_class;
 #define Anum_pgxc_class_pcfuncid			6
 #define Anum_pgxc_class_nodes				7
 #define Anum_pgxc_class_pcfuncattnums		8
+#define Anum_pgxc_class_pcbucketmap			9
+#define Anum_pgxc_class_pcrangebounds		10
 
 typedef enum PgxcClassAlterType
 {
@@ -61,7 +67,8 @@ extern void PgxcClassCreate(Oid pcrelid,
 							Oid *nodes,
 							Oid pcfuncid,
 							int numatts,
-							int16 *pcfuncattnums);
+							int16 *pcfuncattnums,
+							ArrayType *pcrangebounds);
 extern void PgxcClassAlter(Oid pcrelid,
 						   char pclocatortype,
 						   int pcattnum,
@@ -72,7 +79,8 @@ extern void PgxcClassAlter(Oid pcrelid,
 						   PgxcClassAlterType type,
 						   Oid pcfuncid,
 						   int numatts,
-						   int16 *pcfuncattnums);
+						   int16 *pcfuncattnums,
+						   ArrayType *pcrangebounds);
 extern void RemovePgxcClass(Oid pcrelid);
 
 extern void CreatePgxcRelationFuncDepend(Oid relid, Oid funcid);
@@ -44,6 +44,9 @@ extern CopyState pgxcMatViewBeginCopyTo(Relation mvrel);
 extern int64 pgxcDoCopyTo(CopyState cstate);
 extern void DoClusterCopy(CopyStmt *stmt, struct StringInfoData *mem_toc);
 extern void ClusterCopyFromReduce(Relation rel, Expr *reduce, List *remote_oids, int id, CustomNextRowFunction fun, void *data);
+extern CopyState BeginClusterInsert(Relation rel);
+extern void ClusterInsertPutSlot(CopyState cstate, TupleTableSlot *slot);
+extern uint64 EndClusterInsert(CopyState cstate);
 extern void ClusterDummyCopyFromReduce(List *target, Expr *reduce, List *remote_oids, int id, CustomNextRowFunction fun, void *data);
 #endif /* ADB */
 
@@ -68,6 +68,7 @@ extern void DropAllPreparedStatements(void);
 #ifdef ADB
 extern DatanodeStatement *FetchDatanodeStatement(const char *stmt_name, bool throwError);
 extern bool ActivateDatanodeStatementOnNode(const char *stmt_name, Oid noid);
+extern void DeactivateDatanodeStatementsOnNode(Oid noid);
 extern bool HaveActiveDatanodeStatements(void);
 extern void DropDatanodeStatement(const char *stmt_name);
 extern int SetRemoteStatementName(Plan *plan, const char *stmt_name, int num_params,
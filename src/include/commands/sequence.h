@@ -87,6 +87,27 @@ extern bool IsTempSequence(Oid relid);
 extern char *GetGlobalSeqName(Relation seqrel, const char *new_seqname, const char *new_schemaname);
 extern void GetSequenceInfoByName(Relation seqrel, char ** dbname, char ** schemaName);
 extern void register_sequence_cb(Relation  rel, AGTM_SequenceKeyType key, AGTM_SequenceDropType type);
+
+/* how nextval() of a global sequence caches values leased from AGTM */
+typedef enum
+{
+	SEQ_CACHE_LOCAL,			/* each backend leases its own CACHE values */
+	SEQ_CACHE_SHARED,			/* backends of a node share one lease */
+	SEQ_CACHE_ORDERED			/* no caching, values are ordered cluster-wide */
+} SequenceCacheMode;
+
+extern int sequence_cache_mode;
+extern int shared_sequence_cache_size;
+extern int sequence_lease_size;
+
+extern Size SequenceCacheShmemSize(void);
+extern void SequenceCacheShmemInit(void);
+extern void SequenceCacheInvalidate(Oid relid);
+extern void SequenceCacheForgetDatabase(Oid dbid);
+#endif
+
+#ifdef AGTM
+extern int64 nextval_range_internal(Oid relid, int64 count, int64 *last);
 #endif
 
 extern ObjectAddress DefineSequence(CreateSeqStmt *stmt);
@@ -39,6 +39,8 @@
 
 typedef struct InterXactStateData *InterXactState;
 
+extern bool AsyncCommitPrepared;
+
 /* src/backend/intercomm/inter-comm.c */
 extern List *OidArraryToList(MemoryContext context, Oid *oids, int noids);
 extern Oid *OidListToArrary(MemoryContext context, List *oid_list, int *noids);
@@ -57,6 +59,11 @@ extern int HandleBegin(InterXactState state,
 					   TimestampTz timestamp,
 					   bool need_xact_block,
 					   bool *already_begin);
+extern NodeHandle *HandleListBegin(InterXactState state,
+								   List *handle_list,
+								   GlobalTransactionId xid,
+								   TimestampTz timestamp,
+								   bool need_xact_block);
 extern int HandleSendCID(NodeHandle *handle, CommandId cid);
 extern int HandleSendGXID(NodeHandle *handle, GlobalTransactionId xid);
 extern int HandleSendTimestamp(NodeHandle *handle, TimestampTz timestamp);
@@ -89,6 +96,15 @@ extern void HandleListClose(List *handle_list, bool isStatement, const char *nam
 extern void HandleResetOwner(NodeHandle *handle);
 extern void HandleListResetOwner(List *handle_list);
 
+/* src/backend/intercomm/inter-stmt.c */
+extern int RemoteStatementCacheSize;
+extern void HandleCheckRemoteSession(NodeHandle *handle);
+extern const char *HandleGetRemoteStatement(NodeHandle *handle,
+											const char *sql,
+											int num_params,
+											const Oid *param_types,
+											bool *prepared);
+
 /* src/backend/intercomm/inter-xact.c */
 typedef struct InterXactStateData
 {
@@ -100,6 +116,9 @@ typedef struct InterXactStateData
 	Oid					   *trans_nodes;		/* array of remote nodes already start transaction */
 	int						trans_count;		/* remote nodes count */
 	int						trans_max;			/* current max malloc count of nodes */
+	Oid					   *write_nodes;		/* array of remote nodes which may write */
+	int						write_count;		/* written nodes count */
+	int						write_max;			/* current max malloc count of written nodes */
 	struct NodeMixHandle   *cur_handle;			/* "cur_handle" is current NodeMixHandle depends
 												 * on oid list input, just for one query in the
 												 * transaction block */
@@ -119,6 +138,10 @@ extern void InterXactSetGID(InterXactState state, const char *gid);
 extern void InterXactSetXID(InterXactState state, TransactionId xid);
 extern void InterXactSaveBeginNodes(InterXactState state, Oid node);
 extern Oid *InterXactBeginNodes(InterXactState state, bool include_self, int *node_num);
+extern void InterXactSaveWriteNodes(InterXactState state, const List *node_list);
+extern bool InterXactCanOnePhaseCommit(InterXactState state);
+extern void InterXactOnePhaseCommit(InterXactState state);
+extern void InterXactCommitReadOnly(InterXactState state);
 extern void InterXactSerializeSnapshot(StringInfo buf, Snapshot snapshot);
 extern void InterXactGCCurrent(InterXactState state);
 extern void InterXactGCAll(InterXactState state);
@@ -134,6 +157,8 @@ extern void RemoteXactCommit(int nnodes, Oid *nodes);
 extern void RemoteXactAbort(int nnodes, Oid *nodes, bool normal);
 extern void StartFinishPreparedRxact(const char *gid, int nnodes, Oid *nodes, bool isCommit);
 extern void EndFinishPreparedRxact(const char *gid, int nnodes, Oid *nodes, bool isMissingOK, bool isCommit);
+extern bool EndFinishPreparedRxactAsync(const char *gid);
+extern void WaitAsyncCommitPrepared(void);
 
 /* src/backend/intercomm/inter-query.c */
 extern struct PGcustumFuns *InterQueryCustomFuncs;
@@ -152,5 +177,6 @@ extern void EndRemoteCopy(RemoteCopyState *node);
 extern void SendCopyFromHeader(RemoteCopyState *node, const StringInfo header);
 extern void DoRemoteCopyFrom(RemoteCopyState *node, const StringInfo line_buf, const List *node_list);
 extern uint64 DoRemoteCopyTo(RemoteCopyState *node);
+extern uint64 DoRemoteCopyToFiles(const List *node_list, const List *query_list);
 
 #endif /* INTER_COMM_H */
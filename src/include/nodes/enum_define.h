@@ -689,6 +689,8 @@ BEGIN_ENUM(DistributionType)
 	ENUM_VALUE(DISTTYPE_ROUNDROBIN)
 	ENUM_VALUE(DISTTYPE_MODULO)
 	ENUM_VALUE(DISTTYPE_USER_DEFINED)
+	ENUM_VALUE(DISTTYPE_HASHMAP)
+	ENUM_VALUE(DISTTYPE_RANGE)
 END_ENUM(DistributionType)
 #endif /* NO_ENUM_DistributionType */
 #endif
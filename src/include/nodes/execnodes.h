@@ -1176,6 +1176,8 @@ typedef struct ModifyTableState
 	PlanState **mt_plans;		/* subplans (one per target rel) */
 #ifdef ADB
 	PlanState **mt_remoterels;	/* per-target remote query node */
+	struct CopyStateData *mt_cluster_insert;	/* INSERT rows gathered for
+												 * a cluster COPY, or NULL */
 #endif
 	int			mt_nplans;		/* number of plans in the array */
 	int			mt_whichplan;	/* which one is being executed (0..n-1) */
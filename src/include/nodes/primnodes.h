@@ -1464,7 +1464,9 @@ typedef enum DistributionType
 	DISTTYPE_HASH,				/* Hash partitioned */
 	DISTTYPE_ROUNDROBIN,		/* Round Robin */
 	DISTTYPE_MODULO,			/* Modulo partitioned */
-	DISTTYPE_USER_DEFINED		/* User-defined function partitioned */
+	DISTTYPE_USER_DEFINED,		/* User-defined function partitioned */
+	DISTTYPE_HASHMAP,			/* Hash partitioned through bucket map */
+	DISTTYPE_RANGE				/* Range partitioned by bounds of nodes */
 } DistributionType;
 
 /*----------
@@ -1478,7 +1480,8 @@ typedef struct DistributeBy
 	DistributionType disttype;	/* Distribution type */
 	char	   	*colname;		/* Distribution column name */
 	List		*funcname;		/* User-defined distribute function name */
-	List		*funcargs;		/* User-defined distribute function arguments */
+	List		*funcargs;		/* User-defined distribute function arguments,
+								 * or column and bounds of RANGE */
 } DistributeBy;
 
 /*----------
@@ -3,8 +3,10 @@
 
 #define REDUCE_TYPE_NONE		'\0'
 #define REDUCE_TYPE_HASH		'H'
+#define REDUCE_TYPE_HASHMAP		'B'
 #define REDUCE_TYPE_CUSTOM		'C'
 #define REDUCE_TYPE_MODULO		'M'
+#define REDUCE_TYPE_RANGE		'A'
 #define REDUCE_TYPE_REPLICATED	'R'
 #define REDUCE_TYPE_ROUND		'L'
 #define REDUCE_TYPE_COORDINATOR	'O'
@@ -31,7 +33,7 @@ typedef struct ReduceInfo
 	List	   *storage_nodes;			/* when not reduce by value, it's sorted */
 	List	   *exclude_exec;
 	List	   *params;
-	Expr	   *expr;					/* for custom only */
+	Expr	   *expr;					/* for custom, bucket map of hashmap and bounds of range */
 	Relids		relids;					/* params include */
 	char		type;					/* REDUCE_TYPE_XXX */
 }ReduceInfo;
@@ -40,6 +42,8 @@ struct RelationLocInfo;
 typedef int(*ReducePathCallback_function)(PlannerInfo *root, Path *path, void *context);
 
 extern ReduceInfo *MakeHashReduceInfo(const List *storage, const List *exclude, const Expr *param);
+extern ReduceInfo *MakeHashmapReduceInfo(const struct RelationLocInfo *loc_info, const List *exclude, const Expr *param);
+extern ReduceInfo *MakeRangeReduceInfo(const struct RelationLocInfo *loc_info, const List *exclude, const Expr *param);
 extern ReduceInfo *MakeCustomReduceInfoByRel(const List *storage, const List *exclude,
 						const List *attnums, Oid funcid, Oid reloid, Index rel_index);
 extern ReduceInfo *MakeCustomReduceInfo(const List *storage, const List *exclude, List *params, Oid funcid, Oid reloid);
@@ -128,6 +132,8 @@ extern List *GetCheapestReducePathList(RelOptInfo *rel, List *pathlist, Path **c
 extern int ReducePathSave2List(PlannerInfo *root, Path *path, void *pplist);
 
 #define IsReduceInfoByValue(r) ((r)->type == REDUCE_TYPE_HASH || \
+								(r)->type == REDUCE_TYPE_HASHMAP || \
+								(r)->type == REDUCE_TYPE_RANGE || \
 								(r)->type == REDUCE_TYPE_CUSTOM || \
 								(r)->type == REDUCE_TYPE_MODULO)
 extern bool IsReduceInfoListByValue(List *list);
@@ -66,6 +66,16 @@ typedef struct RemoteDataRowData
 } 	RemoteDataRowData;
 typedef RemoteDataRowData *RemoteDataRow;
 
+/*
+ * Parameter values for one node only, see SetNodeDataRowForExtParams
+ */
+typedef struct RemoteNodeParamData
+{
+	Oid			node_id;			/* node to send the values to */
+	char	   *paramval_data;		/* parameter data, format is like in BIND */
+	int			paramval_len;		/* length of parameter values data */
+} RemoteNodeParamData;
+
 typedef struct RemoteQueryState
 {
 	ScanState	ss;						/* its first field is NodeTag */
@@ -102,6 +112,8 @@ typedef struct RemoteQueryState
 	int			paramval_len;		/* length of parameter values data */
 	Oid		   *rqs_param_types;	/* Types of the remote params */
 	int			rqs_num_params;
+	List	   *node_paramvals;		/* RemoteNodeParamData of nodes which are
+									 * not sent paramval_data */
 
 	int			eflags;			/* capability flags to pass to tuplestore */
 	bool		eof_underlying; /* reached end of underlying plan? */
@@ -122,6 +134,9 @@ extern void HandleCmdComplete(CmdType commandType, CombineTag *combine, const ch
 extern void ExecRemoteQueryReScan(RemoteQueryState *node, ExprContext *exprCtxt);
 
 extern void SetDataRowForExtParams(ParamListInfo params, RemoteQueryState *rq_state);
+extern void SetNodeDataRowForExtParams(ParamListInfo paraminfo, RemoteQueryState *rq_state,
+									   Oid node_id, int paramid, Datum paramval);
+extern void FreeNodeDataRowForExtParams(RemoteQueryState *rq_state);
 
 /* Flags related to temporary objects included in query */
 extern TupleTableSlot * ExecProcNodeDMLInXC(EState *estate, TupleTableSlot *sourceDataSlot, TupleTableSlot *newDataSlot);
@@ -16,7 +16,8 @@
 
 #define LOCATOR_TYPE_REPLICATED		'R'
 #define LOCATOR_TYPE_HASH			'H'
-#define LOCATOR_TYPE_RANGE			'G'
+#define LOCATOR_TYPE_RANGE			'G'	/* range of values by node, bounded
+										 * by pgxc_class */
 #define LOCATOR_TYPE_RROBIN			'N'
 #define LOCATOR_TYPE_CUSTOM			'C'
 #define LOCATOR_TYPE_MODULO			'M'
@@ -25,6 +26,8 @@
 										 * scheme, e.g. result of JOIN of
 										 * replicated and distributed table */
 #define LOCATOR_TYPE_USER_DEFINED	'U'
+#define LOCATOR_TYPE_HASHMAP		'B'	/* hash into a fixed number of buckets,
+										 * each mapped to a node by pgxc_class */
 
 /* Maximum number of preferred Datanodes that can be defined in cluster */
 #define MAX_PREFERRED_NODES 64
@@ -32,14 +35,23 @@
 #define HASH_SIZE 4096
 #define HASH_MASK 0x00000FFF;
 
+/*
+ * Number of buckets of a hashmap table. The bucket map is an int2vector
+ * stored inline in pgxc_class, so it has to fit in one catalog page.
+ */
+#define HASHMAP_BUCKETS 2048
+
 #define IsLocatorNone(x)						((x) == LOCATOR_TYPE_NONE)
 #define IsLocatorReplicated(x) 					((x) == LOCATOR_TYPE_REPLICATED)
 #define IsLocatorColumnDistributed(x) 			((x) == LOCATOR_TYPE_HASH || \
+												 (x) == LOCATOR_TYPE_HASHMAP || \
 												 (x) == LOCATOR_TYPE_RROBIN || \
 												 (x) == LOCATOR_TYPE_MODULO || \
+												 (x) == LOCATOR_TYPE_RANGE || \
 												 (x) == LOCATOR_TYPE_DISTRIBUTED || \
 												 (x) == LOCATOR_TYPE_USER_DEFINED)
 #define IsLocatorDistributedByValue(x)			((x) == LOCATOR_TYPE_HASH || \
+												 (x) == LOCATOR_TYPE_HASHMAP || \
 												 (x) == LOCATOR_TYPE_MODULO || \
 												 (x) == LOCATOR_TYPE_RANGE)
 #define IsLocatorDistributedByUserDefined(x)	((x) == LOCATOR_TYPE_USER_DEFINED)
@@ -67,6 +79,12 @@ typedef struct RelationLocInfo
 	ListCell   *roundRobinNode;			/* the next node to use */
 	Oid			funcid;					/* Oid of user-defined distribution function */
 	List	   *funcAttrNums;			/* Attributes indices used for user-defined function  */
+	int			numBuckets;				/* Number of buckets for hashmap */
+	int16	   *bucketMap;				/* Index in nodeids of each bucket's node */
+	Oid			rangeType;				/* Type of range bounds */
+	Oid			rangeCollid;			/* Collation comparing with range bounds */
+	int			numRangeBounds;			/* Number of range bounds */
+	Datum	   *rangeBounds;			/* Upper bound of each node but the last */
 } RelationLocInfo;
 
 #define IsRelationReplicated(rel_loc)				IsLocatorReplicated((rel_loc)->locatorType)
@@ -99,6 +117,10 @@ typedef struct ExecNodes
 										 * nodes */
 	List		   *en_dist_vars;		/* See above for details */
 	List		   *nodeids;			/* Node ids list */
+	bool			en_expr_is_array;	/* en_expr is an array of distribution
+										 * values, run on nodes of each element */
+	int				en_array_paramid;	/* en_expr is this parameter, send each
+										 * node only its own elements */
 } ExecNodes;
 
 #define IsExecNodesReplicated(en)				IsLocatorReplicated((en)->baselocatortype)
@@ -119,10 +141,17 @@ extern List *GetPreferredRepNodeIds(List *nodeids);
 extern bool IsTableDistOnPrimary(RelationLocInfo *locInfo);
 extern bool IsLocatorInfoEqual(RelationLocInfo *locInfo1,
 							   RelationLocInfo *locInfo2);
+extern bool IsLocatorBucketMapEqual(RelationLocInfo *locInfo1,
+									RelationLocInfo *locInfo2);
+extern bool IsLocatorRangeBoundsEqual(RelationLocInfo *locInfo1,
+									  RelationLocInfo *locInfo2);
+extern Const *MakeRangeBoundsConst(const RelationLocInfo *locInfo);
 extern Oid GetRoundRobinNodeId(Oid relid);
 extern bool IsTypeDistributable(Oid colType);
 extern bool IsDistribColumn(Oid relid, AttrNumber attNum);
 
+extern bool GetRelationNodeIndexes(RelationLocInfo *rel_loc_info, Oid typid, int nvalues,
+					   const Datum *values, const bool *nulls, int *node_indexes);
 extern ExecNodes *GetRelationNodes(RelationLocInfo *rel_loc_info,
 								   int nelems,
 								   Datum* valueForDistCol,
@@ -133,6 +162,12 @@ extern ExecNodes *GetRelationNodesByQuals(Oid reloid,
 										  Index varno,
 										  Node *quals,
 										  RelationAccessType relaccess);
+extern Expr *GetRelationDistribExprByQuals(RelationLocInfo *rel_loc_info,
+										   Index varno,
+										   Node *quals);
+extern Expr *GetRelationDistribArrayByQuals(RelationLocInfo *rel_loc_info,
+											Index varno,
+											Node *quals);
 extern ExecNodes *MakeExecNodesByOids(RelationLocInfo *loc_info, List *oids, RelationAccessType accesstype);
 extern ExecNodes *GetRelationNodesByMultQuals(RelationLocInfo *rel_loc_info,
 											  Oid reloid,
@@ -33,8 +33,8 @@ typedef struct
 	char		SendBuffer[POOL_BUFFER_SIZE];
 } PoolPort;
 
-extern int	pool_listen(void);
-extern int	pool_connect(void);
+extern int	pool_listen(int shard);
+extern int	pool_connect(int shard);
 extern int	pool_getbyte(PoolPort *port);
 extern int	pool_pollbyte(PoolPort *port);
 extern int	pool_getmessage(PoolPort *port, StringInfo s, int maxlen);
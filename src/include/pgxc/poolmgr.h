@@ -59,11 +59,22 @@ typedef enum
 
 typedef struct PoolHandle PoolHandle;
 
+/* When backend gives its remote connections back to the pool */
+typedef enum
+{
+	POOL_MODE_SESSION,		/* kept for the backend, see pool_release_to_idle_timeout */
+	POOL_MODE_TRANSACTION	/* shared by others at transaction end */
+} PoolModeType;
+
 extern int	MinPoolSize;
 extern int	MaxPoolSize;
 extern int	PoolRemoteCmdTimeout;
+extern int	PoolManagerShards;
+extern int	PoolWarmupWindow;
 
 extern bool PersistentConnections;
+extern bool PoolMatchSessionParams;
+extern int	PoolMode;
 
 /* Status inquiry functions */
 extern void PGXCPoolerProcessIam(void);
@@ -72,6 +83,10 @@ extern bool IsPGXCPoolerProcess(void);
 /* Initialize internal structures */
 extern int	PoolManagerInit(void) __attribute__((noreturn));
 
+/* Additional pool manager shards, run as background workers */
+extern void RegisterPoolerShards(void);
+extern void PoolerShardMain(Datum main_arg) __attribute__((noreturn));
+
 /* Destroy internal structures */
 extern int	PoolManagerDestroy(void);
 
@@ -83,7 +98,7 @@ extern int	PoolManagerDestroy(void);
  * variable. After forking off it can be stored in global memory, so it will
  * only be accessible by the process running the session.
  */
-extern PoolHandle *GetPoolManagerHandle(void);
+extern PoolHandle *GetPoolManagerHandle(const char *database, const char *user_name);
 
 /*
  * Called from Postmaster(Coordinator) after fork. Close one end of the pipe and
@@ -146,5 +161,6 @@ extern bool IsPoolHandle(void);
 extern int PoolManagerSendLocalCommand(int dn_count, int* dn_list, int co_count, int* co_list);
 
 extern Datum pool_close_idle_conn(PG_FUNCTION_ARGS);
+extern Datum pool_params_stats(PG_FUNCTION_ARGS);
 
 #endif
@@ -0,0 +1,50 @@
+/*-------------------------------------------------------------------------
+ *
+ * poolstat.h
+ *
+ *	  Shared memory statistics of pool manager
+ *
+ * Portions Copyright (c) 2016, ASIAINFO BDX ADB Group
+ *
+ * src/include/pgxc/poolstat.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef POOLSTAT_H
+#define POOLSTAT_H
+
+#include "fmgr.h"
+
+/* why pool manager closed a pooled connection */
+typedef enum PoolDestroyReason
+{
+	POOL_DESTROY_CLOSE = 0,		/* close requested by backend or user */
+	POOL_DESTROY_TIMEOUT,		/* idle longer than pool_time_out */
+	POOL_DESTROY_BROKEN,		/* connection found broken */
+	POOL_DESTROY_ERROR,			/* remote reported an error */
+	POOL_DESTROY_TEMP,			/* connection had temporary objects */
+	POOL_DESTROY_REASONS
+} PoolDestroyReason;
+
+/* statistics entry of one ADBNodePool, opaque out of poolstat.c */
+typedef struct PoolStatEntry PoolStatEntry;
+
+extern Size PoolStatShmemSize(void);
+extern void PoolStatShmemInit(void);
+
+/* called by pool manager processes only */
+extern void PoolStatResetShard(int shard);
+extern PoolStatEntry *PoolStatAlloc(int shard, const char *database,
+									const char *user_name,
+									const char *hostname, int port);
+extern void PoolStatFree(PoolStatEntry *entry);
+extern void PoolStatSlots(PoolStatEntry *entry, int uninit, int idle,
+						  int busy, int released);
+extern void PoolStatConnect(PoolStatEntry *entry, bool failed);
+extern void PoolStatAcquire(PoolStatEntry *entry, long wait_usec);
+extern void PoolStatParamsReplay(PoolStatEntry *entry, bool reset_all);
+extern void PoolStatDestroy(PoolStatEntry *entry, PoolDestroyReason reason);
+
+extern Datum pg_stat_get_pool(PG_FUNCTION_ARGS);
+
+#endif /* POOLSTAT_H */
@@ -17,6 +17,13 @@
 
 #include "nodes/parsenodes.h"
 #include "utils/tuplestore.h"
+#ifdef ADB
+#include "lib/stringinfo.h"
+
+/* keys in cluster COPY message of DISTRIB_REDUCE */
+#define REDISTRIB_KEY_REDUCE	0xFFFF0001	/* reduce expr of new distribution */
+#define REDISTRIB_KEY_NODES		0xFFFF0002	/* all Datanodes taking part */
+#endif
 
 /*
  * Type of data redistribution operations.
@@ -29,7 +36,10 @@ typedef enum RedistribOperation {
 	DISTRIB_COPY_TO,	/* Perform a COPY TO */
 	DISTRIB_COPY_FROM,	/* Perform a COPY FROM */
 	DISTRIB_TRUNCATE,	/* Truncate relation */
-	DISTRIB_REINDEX		/* Reindex relation */
+	DISTRIB_REINDEX,	/* Reindex relation */
+#ifdef ADB
+	DISTRIB_REDUCE		/* Move rows between Datanodes by reduce */
+#endif
 } RedistribOperation;
 
 /*
@@ -76,5 +86,8 @@ extern RedistribCommand *makeRedistribCommand(RedistribOperation type,
 extern RedistribState *makeRedistribState(Oid relOid);
 extern void FreeRedistribState(RedistribState *state);
 extern void FreeRedistribCommand(RedistribCommand *command);
+#ifdef ADB
+extern void ClusterRedistribTable(CopyStmt *stmt, StringInfo mem_toc);
+#endif
 
 #endif  /* REDISTRIB_H */
@@ -80,6 +80,12 @@ typedef struct RemoteCopyOptions {
 	char	   *rco_escape;			/* CSV escape char (must be 1 byte) */
 	List	   *rco_force_quote;	/* list of column names */
 	List	   *rco_force_notnull;	/* list of column names */
+#ifdef ADB
+	bool		rco_header;			/* CSV header line? */
+	bool		rco_force_quote_all;	/* FORCE QUOTE *? */
+	char	   *rco_encoding;		/* file encoding name, NULL for default */
+	char	   *rco_filename;		/* COPY TO this file on node, NULL for STDOUT */
+#endif
 } RemoteCopyOptions;
 
 extern void RemoteCopyBuildExtra(RemoteCopyState *rcstate, TupleDesc tupdesc);
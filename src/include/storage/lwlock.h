@@ -234,6 +234,9 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_BUFFER_MAPPING,
 	LWTRANCHE_LOCK_MANAGER,
 	LWTRANCHE_PREDICATE_LOCK_MANAGER,
+#ifdef ADB
+	LWTRANCHE_SEQUENCE_CACHE,
+#endif
 	LWTRANCHE_FIRST_USER_DEFINED
 }	BuiltinTrancheIds;
 
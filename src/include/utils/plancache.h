@@ -118,6 +118,8 @@ typedef struct CachedPlanSource
 	char	   *stmt_name;		/* If set, this is a copy of prepared stmt name */
 	struct CachedPlan *cluster_plan;	/* cluster plan, or NULL if not valid */
 	ParseGrammar grammar;
+	bool		single_node_gplan;	/* last generic plan ships the statement
+									 * to the node chosen by parameters */
 #endif
 } CachedPlanSource;
 
@@ -0,0 +1,130 @@
+--
+-- INSERT ... SELECT into distributed tables
+--
+-- When nothing needs the rows one at a time, Coordinator sends them to
+-- Datanodes by one cluster COPY. Each case is compared with the remote
+-- INSERT of each row, which RETURNING still takes.
+--
+
+-- rows inserted by an INSERT statement
+CREATE FUNCTION insert_count(stmt text) RETURNS bigint
+LANGUAGE plpgsql AS $$
+DECLARE
+	n		bigint;
+BEGIN
+	EXECUTE stmt;
+	GET DIAGNOSTICS n = ROW_COUNT;
+	RETURN n;
+END;
+$$;
+
+-- rows of rel on each Datanode of the table
+CREATE FUNCTION node_rows(rel regclass, OUT node name, OUT rows bigint)
+RETURNS SETOF record
+LANGUAGE plpgsql AS $$
+BEGIN
+	FOR node IN SELECT n.node_name FROM pgxc_class c, pgxc_node n
+				 WHERE c.pcrelid = rel AND n.oid = ANY (c.nodeoids)
+				 ORDER BY n.node_name LOOP
+		EXECUTE format('EXECUTE DIRECT ON (%I) %L', node,
+					   'SELECT count(*) FROM ' || rel)
+		   INTO rows;
+		RETURN NEXT;
+	END LOOP;
+END;
+$$;
+
+-- hash table, NULLs and the characters COPY escapes keep their value
+CREATE TABLE ci_hash (a int, b text, c int) DISTRIBUTE BY HASH(a);
+CREATE TABLE ci_hash_ref (a int, b text, c int) DISTRIBUTE BY HASH(a);
+SELECT insert_count($$INSERT INTO ci_hash
+	SELECT i, CASE WHEN i % 10 = 0 THEN NULL ELSE E'\\N\t\n' || i END, i % 7
+	  FROM generate_series(1, 3000) i$$) AS batched;
+SELECT insert_count($$INSERT INTO ci_hash_ref
+	SELECT i, CASE WHEN i % 10 = 0 THEN NULL ELSE E'\\N\t\n' || i END, i % 7
+	  FROM generate_series(1, 3000) i RETURNING a$$) AS row_at_a_time;
+SELECT (SELECT count(*) FROM (SELECT * FROM ci_hash
+							  EXCEPT ALL SELECT * FROM ci_hash_ref) s) AS extra,
+	   (SELECT count(*) FROM (SELECT * FROM ci_hash_ref
+							  EXCEPT ALL SELECT * FROM ci_hash) s) AS missing;
+SELECT count(*), count(b), count(*) FILTER (WHERE b = E'\\N\t\n' || a) AS escaped
+  FROM ci_hash;
+-- on the same Datanodes
+SELECT count(*) FROM node_rows('ci_hash') h FULL JOIN node_rows('ci_hash_ref') r
+	USING (node) WHERE h.rows IS DISTINCT FROM r.rows;
+
+-- the source reads the table inserted into
+SELECT insert_count('INSERT INTO ci_hash SELECT a + 3000, b, c FROM ci_hash') AS batched;
+SELECT count(*), count(DISTINCT a), max(a) FROM ci_hash;
+
+-- replicated table, every Datanode of the table gets all the rows
+CREATE TABLE ci_rep (a int, b text) DISTRIBUTE BY REPLICATION;
+CREATE TABLE ci_rep_ref (a int, b text) DISTRIBUTE BY REPLICATION;
+SELECT insert_count($$INSERT INTO ci_rep
+	SELECT i, 'r' || i FROM generate_series(1, 2000) i$$) AS batched;
+SELECT insert_count($$INSERT INTO ci_rep_ref
+	SELECT i, 'r' || i FROM generate_series(1, 2000) i RETURNING a$$) AS row_at_a_time;
+SELECT (SELECT count(*) FROM (SELECT * FROM ci_rep
+							  EXCEPT ALL SELECT * FROM ci_rep_ref) s) AS extra,
+	   (SELECT count(*) FROM (SELECT * FROM ci_rep_ref
+							  EXCEPT ALL SELECT * FROM ci_rep) s) AS missing;
+SELECT count(*) > 1 AS nodes, count(*) FILTER (WHERE rows <> 2000) AS short
+  FROM node_rows('ci_rep');
+
+-- table with an auxiliary table, which gets where each row is stored
+CREATE TABLE ci_aux (a int, b int, c text) DISTRIBUTE BY HASH(a);
+CREATE AUXILIARY TABLE ci_aux_b ON ci_aux (b);
+CREATE TABLE ci_aux_ref (a int, b int, c text) DISTRIBUTE BY HASH(a);
+SELECT insert_count($$INSERT INTO ci_aux
+	SELECT i, i % 100, 'x' || i FROM generate_series(1, 2000) i$$) AS batched;
+SELECT insert_count($$INSERT INTO ci_aux_ref
+	SELECT i, i % 100, 'x' || i FROM generate_series(1, 2000) i RETURNING a$$) AS row_at_a_time;
+SELECT (SELECT count(*) FROM (SELECT * FROM ci_aux
+							  EXCEPT ALL SELECT * FROM ci_aux_ref) s) AS extra,
+	   (SELECT count(*) FROM (SELECT * FROM ci_aux_ref
+							  EXCEPT ALL SELECT * FROM ci_aux) s) AS missing;
+SELECT count(*) FROM ci_aux_b;
+SELECT count(*) FROM ci_aux t JOIN ci_aux_b x
+	ON x.b = t.b AND x.a = t.a AND x.auxnodeid = t.xc_node_id AND x.auxctid = t.ctid;
+SELECT count(*) FROM ci_aux WHERE b = 42;
+
+-- a row failing a constraint fails the statement, nothing is inserted
+CREATE TABLE ci_check (a int, b int NOT NULL, c int CHECK (c > 0))
+	DISTRIBUTE BY HASH(a);
+INSERT INTO ci_check SELECT i, i, i FROM generate_series(1, 100) i;
+INSERT INTO ci_check SELECT i, nullif(i, 150), i FROM generate_series(101, 200) i;
+INSERT INTO ci_check SELECT i, i, 150 - i FROM generate_series(101, 200) i;
+SELECT count(*), max(a) FROM ci_check;
+
+-- RETURNING inserts the rows one at a time and returns each of them
+INSERT INTO ci_check SELECT i, i, i FROM generate_series(101, 105) i RETURNING a, b;
+
+-- so does a row trigger, it sees each row
+CREATE FUNCTION ci_check_trig() RETURNS trigger
+LANGUAGE plpgsql AS $$
+BEGIN
+	NEW.c := NEW.a * 10;
+	RETURN NEW;
+END;
+$$;
+CREATE TRIGGER ci_check_trig BEFORE INSERT ON ci_check
+	FOR EACH ROW EXECUTE PROCEDURE ci_check_trig();
+SELECT insert_count($$INSERT INTO ci_check
+	SELECT i, i, 1 FROM generate_series(201, 300) i$$) AS row_at_a_time;
+SELECT count(*) FROM ci_check WHERE a > 200 AND c = a * 10;
+DROP TRIGGER ci_check_trig ON ci_check;
+
+-- and ON CONFLICT, keys repeated by the source are skipped
+CREATE TABLE ci_conflict (a int PRIMARY KEY, b text) DISTRIBUTE BY REPLICATION;
+INSERT INTO ci_conflict SELECT i, 'old' FROM generate_series(1, 5) i;
+SELECT insert_count($$INSERT INTO ci_conflict
+	SELECT i % 10 + 1, 'new' || i FROM generate_series(1, 30) i
+	ON CONFLICT DO NOTHING$$) AS row_at_a_time;
+SELECT * FROM ci_conflict ORDER BY a;
+
+DROP AUXILIARY TABLE ci_aux_b;
+DROP TABLE ci_hash, ci_hash_ref, ci_rep, ci_rep_ref, ci_aux, ci_aux_ref,
+	ci_check, ci_conflict;
+DROP FUNCTION ci_check_trig();
+DROP FUNCTION node_rows(regclass);
+DROP FUNCTION insert_count(text);
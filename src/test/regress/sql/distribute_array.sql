@@ -0,0 +1,235 @@
+--
+-- Statements comparing the distribution column with an array parameter
+--
+-- A generic plan of "WHERE a = ANY($1)" ships the statement to all the
+-- Datanodes of the table when planning, and the executor sends it to the
+-- ones the non-NULL elements of the bound array are on. When $1 is used
+-- nowhere else, each Datanode is bound only its own elements.
+--
+
+CREATE TABLE ap_hash (a int, b text) DISTRIBUTE BY HASH(a);
+CREATE TABLE ap_mod (a int, b text) DISTRIBUTE BY MODULO(a);
+CREATE TABLE ap_map (a int, b text) DISTRIBUTE BY HASHMAP(a);
+-- the first node takes values below 50, the second one the rest
+DO $$
+DECLARE
+	nodes	text;
+BEGIN
+	SELECT string_agg(quote_ident(node_name), ', ' ORDER BY node_name) INTO nodes
+	  FROM (SELECT node_name FROM pgxc_node WHERE node_type = 'D'
+			 ORDER BY node_name LIMIT 2) s;
+	EXECUTE 'CREATE TABLE ap_range (a int, b text) DISTRIBUTE BY RANGE(a, 50) TO NODE ('
+			|| nodes || ')';
+END;
+$$;
+CREATE TABLE ap_text (a text, b int) DISTRIBUTE BY HASH(a);
+CREATE TABLE ap_mark (a int) DISTRIBUTE BY REPLICATION;
+INSERT INTO ap_hash SELECT i, 'h' || i FROM generate_series(1, 100) i;
+INSERT INTO ap_mod SELECT i, 'm' || i FROM generate_series(1, 100) i;
+INSERT INTO ap_map SELECT i, 'p' || i FROM generate_series(1, 100) i;
+INSERT INTO ap_range SELECT i, 'r' || i FROM generate_series(1, 100) i;
+INSERT INTO ap_text SELECT 't' || i, i FROM generate_series(1, 100) i;
+
+-- "one", "all" or the count of the Datanodes flagged in nodes
+CREATE FUNCTION ap_count(nodes bool[]) RETURNS text
+LANGUAGE sql AS $$
+	SELECT CASE n WHEN 1 THEN 'one' WHEN array_length(nodes, 1) THEN 'all'
+				  ELSE n::text END
+	  FROM (SELECT count(*) FILTER (WHERE x) AS n FROM unnest(nodes) x) s;
+$$;
+
+-- Datanodes of rel, each flagged if it has a row satisfying cond
+CREATE FUNCTION ap_holders(rel regclass, cond text) RETURNS bool[]
+LANGUAGE plpgsql AS $$
+DECLARE
+	node	name;
+	found	bool;
+	res		bool[] := '{}';
+BEGIN
+	FOR node IN SELECT n.node_name FROM pgxc_class c, pgxc_node n
+				 WHERE c.pcrelid = rel AND n.oid = ANY (c.nodeoids)
+				 ORDER BY n.node_name LOOP
+		EXECUTE format('EXECUTE DIRECT ON (%I) %L', node,
+					   format('SELECT count(*) > 0 FROM %s WHERE %s', rel, cond))
+		   INTO found;
+		res := res || found;
+	END LOOP;
+	RETURN res;
+END;
+$$;
+
+-- the three lowest keys stored on the first Datanode of rel
+CREATE FUNCTION ap_first_keys(rel regclass) RETURNS text
+LANGUAGE plpgsql AS $$
+DECLARE
+	node	name;
+	res		text;
+BEGIN
+	SELECT n.node_name INTO node FROM pgxc_class c, pgxc_node n
+	 WHERE c.pcrelid = rel AND n.oid = c.nodeoids[0];
+	EXECUTE format('EXECUTE DIRECT ON (%I) %L', node,
+				   format('SELECT array_agg(a ORDER BY a)::text FROM '
+						  '(SELECT a FROM %s ORDER BY a LIMIT 3) s', rel))
+	   INTO res;
+	RETURN res;
+END;
+$$;
+
+-- Datanodes of rel the plan of stmt ships to, listed by EXPLAIN VERBOSE,
+-- and the expression choosing them when executing
+CREATE FUNCTION ap_explain(rel regclass, stmt text, OUT nodes bool[], OUT node_expr text)
+LANGUAGE plpgsql AS $$
+DECLARE
+	names	text[];
+	ln		text;
+	m		text;
+BEGIN
+	FOR ln IN EXECUTE 'EXPLAIN (verbose, costs off) ' || stmt LOOP
+		m := substring(ln from 'Node/s: (.*)$');
+		IF m IS NOT NULL THEN
+			names := string_to_array(m, ', ');
+		END IF;
+		m := substring(ln from 'Node expr: (.*)$');
+		IF m IS NOT NULL THEN
+			node_expr := m;
+		END IF;
+	END LOOP;
+	SELECT array_agg(n.node_name = ANY (names) ORDER BY n.node_name) INTO nodes
+	  FROM pgxc_class c, pgxc_node n
+	 WHERE c.pcrelid = rel AND n.oid = ANY (c.nodeoids);
+END;
+$$;
+
+-- Datanodes of rel executing stmt scanned, and the rows it returned. Run it
+-- after a write to all the Datanodes in a transaction block, their
+-- statistics are not reported until the transaction ends then.
+CREATE FUNCTION ap_run(rel regclass, stmt text, OUT nodes bool[], OUT rows bigint)
+LANGUAGE plpgsql AS $$
+DECLARE
+	query	text := format('SELECT coalesce(sum(seq_scan), 0) FROM pg_stat_xact_user_tables '
+						   'WHERE relname = %L', rel::text);
+	node	name;
+	nodelist name[];
+	scans	bigint;
+	before	bigint[] := '{}';
+BEGIN
+	SELECT array_agg(n.node_name ORDER BY n.node_name) INTO nodelist
+	  FROM pgxc_class c, pgxc_node n
+	 WHERE c.pcrelid = rel AND n.oid = ANY (c.nodeoids);
+	FOREACH node IN ARRAY nodelist LOOP
+		EXECUTE format('EXECUTE DIRECT ON (%I) %L', node, query) INTO scans;
+		before := before || scans;
+	END LOOP;
+	EXECUTE stmt;
+	GET DIAGNOSTICS rows = ROW_COUNT;
+	nodes := '{}';
+	FOR i IN 1 .. array_length(nodelist, 1) LOOP
+		EXECUTE format('EXECUTE DIRECT ON (%I) %L', nodelist[i], query) INTO scans;
+		nodes := nodes || (scans > before[i]);
+	END LOOP;
+END;
+$$;
+
+-- keys of the first Datanode of each table, their values depend on the
+-- cluster and are not shown
+SELECT ap_first_keys('ap_hash') AS hash_keys, ap_first_keys('ap_mod') AS mod_keys,
+	   ap_first_keys('ap_map') AS map_keys, ap_first_keys('ap_range') AS range_keys,
+	   ap_first_keys('ap_text') AS text_keys \gset
+CREATE VIEW ap_keys (rel, keys) AS
+	VALUES ('ap_hash'::regclass, :'hash_keys'::text), ('ap_mod', :'mod_keys'),
+		   ('ap_map', :'map_keys'), ('ap_range', :'range_keys'), ('ap_text', :'text_keys');
+SELECT rel, array_length(keys::text[], 1) AS keys FROM ap_keys ORDER BY rel::text;
+
+-- a custom plan is pruned when planning
+SELECT k.rel, ap_count(e.nodes) AS nodes,
+	   e.nodes = ap_holders(k.rel, format('a = ANY (%L)', k.keys)) AS holders,
+	   e.node_expr
+  FROM ap_keys k,
+	   LATERAL ap_explain(k.rel, format('SELECT * FROM %s WHERE a = ANY (%L)', k.rel, k.keys)) e
+ ORDER BY k.rel::text;
+
+-- a prepared statement on one table tries the generic plan first, and keeps
+-- it while the executor chooses the Datanodes
+PREPARE ap_hash_sel(int[]) AS SELECT * FROM ap_hash WHERE a = ANY ($1);
+PREPARE ap_mod_sel(int[]) AS SELECT * FROM ap_mod WHERE a = ANY ($1);
+PREPARE ap_map_sel(int[]) AS SELECT * FROM ap_map WHERE a = ANY ($1);
+PREPARE ap_range_sel(int[]) AS SELECT * FROM ap_range WHERE a = ANY ($1);
+-- a varchar array is binary-coercible to the text array of the key
+PREPARE ap_text_sel(varchar[]) AS SELECT * FROM ap_text WHERE a = ANY ($1);
+SELECT k.rel, ap_count(e.nodes) AS nodes, e.node_expr
+  FROM ap_keys k,
+	   LATERAL ap_explain(k.rel, format('EXECUTE %s_sel(%L)', k.rel, k.keys)) e
+ ORDER BY k.rel::text;
+
+-- keys of the first Datanode run there only, repeated keys and NULL elements
+-- change nothing. An array of no key, or of NULLs only, matches nothing and
+-- runs on one Datanode.
+BEGIN;
+INSERT INTO ap_mark VALUES (1);
+SELECT k.rel, c.name, ap_count(r.nodes) AS nodes,
+	   r.nodes = ap_holders(k.rel, format('a = ANY (%L)', c.keys)) AS holders,
+	   r.rows
+  FROM ap_keys k,
+	   LATERAL (VALUES (1, 'keys', k.keys),
+					   (2, 'duplicates', array_cat(k.keys::text[], k.keys::text[])::text),
+					   (3, 'nulls', array_append(array_prepend(NULL, k.keys::text[]), NULL)::text),
+					   (4, 'empty', '{}'),
+					   (5, 'null only', '{NULL}')) c(n, name, keys),
+	   LATERAL ap_run(k.rel, format('EXECUTE %s_sel(%L)', k.rel, c.keys)) r
+ ORDER BY k.rel::text, c.n;
+COMMIT;
+
+-- keys of all the Datanodes, each one gets its own ones
+BEGIN;
+INSERT INTO ap_mark VALUES (2);
+SELECT k.rel, r.nodes = ap_holders(k.rel, format('a = ANY (%L)', c.keys)) AS holders,
+	   r.rows
+  FROM ap_keys k,
+	   LATERAL (SELECT CASE k.rel WHEN 'ap_text'::regclass
+							  THEN array_agg('t' || i)::text
+							  ELSE array_agg(i)::text END
+				  FROM generate_series(5, 100, 5) i) c(keys),
+	   LATERAL ap_run(k.rel, format('EXECUTE %s_sel(%L)', k.rel, c.keys)) r
+ ORDER BY k.rel::text;
+COMMIT;
+EXECUTE ap_hash_sel('{10,NULL,10,-1}');
+EXECUTE ap_mod_sel('{}');
+EXECUTE ap_map_sel('{NULL}');
+EXECUTE ap_range_sel('{NULL,90}');
+EXECUTE ap_text_sel('{t10,t10}');
+
+-- the array is used again by the query, so it is not split and every
+-- Datanode is bound all the elements
+PREPARE ap_hash_len(int[]) AS
+	SELECT a, array_length($1, 1) AS n FROM ap_hash
+	 WHERE a = ANY ($1) AND array_length($1, 1) = 20;
+SELECT ap_count(nodes) AS nodes, node_expr
+  FROM ap_explain('ap_hash', 'EXECUTE ap_hash_len(''{1}'')');
+BEGIN;
+INSERT INTO ap_mark VALUES (3);
+SELECT r.nodes = ap_holders('ap_hash', 'a % 5 = 0') AS holders, r.rows
+  FROM ap_run('ap_hash',
+			  format('EXECUTE ap_hash_len(%L)',
+					 (SELECT array_agg(i) FROM generate_series(5, 100, 5) i))) r;
+COMMIT;
+
+-- an IN list of parameters is routed by the array of them
+PREPARE ap_hash_in(int, int, int) AS SELECT * FROM ap_hash WHERE a IN ($1, $2, $3);
+SELECT ap_count(nodes) AS nodes, node_expr
+  FROM ap_explain('ap_hash', 'EXECUTE ap_hash_in(1, 2, 3)');
+EXECUTE ap_hash_in(10, NULL, 10);
+
+DEALLOCATE ap_hash_sel;
+DEALLOCATE ap_mod_sel;
+DEALLOCATE ap_map_sel;
+DEALLOCATE ap_range_sel;
+DEALLOCATE ap_text_sel;
+DEALLOCATE ap_hash_len;
+DEALLOCATE ap_hash_in;
+DROP VIEW ap_keys;
+DROP TABLE ap_hash, ap_mod, ap_map, ap_range, ap_text, ap_mark;
+DROP FUNCTION ap_run(regclass, text);
+DROP FUNCTION ap_explain(regclass, text);
+DROP FUNCTION ap_first_keys(regclass);
+DROP FUNCTION ap_holders(regclass, text);
+DROP FUNCTION ap_count(bool[]);
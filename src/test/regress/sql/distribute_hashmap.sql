@@ -0,0 +1,114 @@
+--
+-- DISTRIBUTE BY HASHMAP
+--
+
+-- node of each bucket of a hashmap table, by the bucket map in pgxc_class
+CREATE FUNCTION hashmap_bucket_nodes(rel regclass) RETURNS oid[]
+LANGUAGE plpgsql AS $$
+DECLARE
+	map			int2vector;
+	nodes		oidvector;
+	buckets		int;
+	result		oid[];
+BEGIN
+	SELECT pcbucketmap, nodeoids, pchashbuckets INTO map, nodes, buckets
+	  FROM pgxc_class WHERE pcrelid = rel AND pclocatortype = 'B';
+	FOR i IN 0 .. buckets - 1 LOOP
+		result := array_append(result, nodes[map[i]]);
+	END LOOP;
+	RETURN result;
+END;
+$$;
+
+-- keys in first .. last not found by a query routed to one node
+CREATE FUNCTION hashmap_lost_rows(rel regclass, first int, last int) RETURNS int
+LANGUAGE plpgsql AS $$
+DECLARE
+	found_rows	int;
+	lost		int := 0;
+BEGIN
+	FOR i IN first .. last LOOP
+		EXECUTE format('SELECT count(*) FROM %s WHERE a = %s', rel, i) INTO found_rows;
+		IF found_rows <> 1 THEN
+			lost := lost + 1;
+		END IF;
+	END LOOP;
+	RETURN lost;
+END;
+$$;
+
+CREATE TABLE hashmap_tab (a int, b text) DISTRIBUTE BY HASHMAP(a);
+\d+ hashmap_tab
+-- only one column
+CREATE TABLE hashmap_bad (a int, b int) DISTRIBUTE BY HASHMAP(a, b);
+
+-- every bucket has a node, all nodes hold even shares of the buckets
+SELECT hashmap_bucket_nodes('hashmap_tab') AS map_before \gset
+SELECT array_length(:'map_before'::oid[], 1) AS buckets,
+       array_position(:'map_before'::oid[], NULL) IS NULL AS all_mapped,
+       (SELECT max(c) - min(c) <= 1 FROM
+         (SELECT count(*) AS c FROM unnest(:'map_before'::oid[]) n GROUP BY n) s) AS even,
+       (SELECT count(DISTINCT n) FROM unnest(:'map_before'::oid[]) n) =
+         (SELECT count(*) FROM pgxc_node WHERE node_type = 'D') AS all_nodes;
+
+-- routing
+INSERT INTO hashmap_tab SELECT i, 'row ' || i FROM generate_series(1, 1000) i;
+SELECT count(*), sum(a) FROM hashmap_tab;
+SELECT hashmap_lost_rows('hashmap_tab', 1, 1000) AS lost;
+UPDATE hashmap_tab SET b = 'updated' WHERE a = 7;
+SELECT * FROM hashmap_tab WHERE a = 7;
+DELETE FROM hashmap_tab WHERE a IN (1, 2, 3);
+SELECT count(*), sum(a) FROM hashmap_tab;
+
+-- tables with the same bucket map join on their nodes
+CREATE TABLE hashmap_tab2 (a int, c int) DISTRIBUTE BY HASHMAP(a);
+INSERT INTO hashmap_tab2 SELECT i, i * 2 FROM generate_series(1, 1000, 3) i;
+SELECT count(*), sum(c) FROM hashmap_tab t1 JOIN hashmap_tab2 t2 USING (a);
+
+-- removing a node moves only the buckets of that node
+DO $$
+DECLARE
+	node	name;
+BEGIN
+	SELECT node_name INTO node FROM pgxc_node WHERE node_type = 'D'
+	 ORDER BY node_name DESC LIMIT 1;
+	EXECUTE format('ALTER TABLE hashmap_tab DELETE NODE (%I)', node);
+END;
+$$;
+SELECT hashmap_bucket_nodes('hashmap_tab') AS map_deleted \gset
+SELECT count(*) AS moved
+  FROM unnest(:'map_before'::oid[], :'map_deleted'::oid[]) AS m(before, after)
+ WHERE before <> after AND before IN (SELECT unnest(:'map_deleted'::oid[]));
+SELECT array_position(:'map_deleted'::oid[], NULL) IS NULL AS all_mapped,
+       (SELECT max(c) - min(c) <= 1 FROM
+         (SELECT count(*) AS c FROM unnest(:'map_deleted'::oid[]) n GROUP BY n) s) AS even,
+       (SELECT count(DISTINCT n) FROM unnest(:'map_deleted'::oid[]) n) =
+         (SELECT count(*) - 1 FROM pgxc_node WHERE node_type = 'D') AS one_less;
+SELECT count(*), sum(a) FROM hashmap_tab;
+SELECT hashmap_lost_rows('hashmap_tab', 4, 1000) AS lost;
+
+-- adding it back moves buckets only to it
+DO $$
+DECLARE
+	node	name;
+BEGIN
+	SELECT node_name INTO node FROM pgxc_node WHERE node_type = 'D'
+	 ORDER BY node_name DESC LIMIT 1;
+	EXECUTE format('ALTER TABLE hashmap_tab ADD NODE (%I)', node);
+END;
+$$;
+SELECT hashmap_bucket_nodes('hashmap_tab') AS map_added \gset
+SELECT count(*) AS moved
+  FROM unnest(:'map_deleted'::oid[], :'map_added'::oid[]) AS m(before, after)
+ WHERE before <> after AND after IN (SELECT unnest(:'map_deleted'::oid[]));
+SELECT array_position(:'map_added'::oid[], NULL) IS NULL AS all_mapped,
+       (SELECT max(c) - min(c) <= 1 FROM
+         (SELECT count(*) AS c FROM unnest(:'map_added'::oid[]) n GROUP BY n) s) AS even,
+       (SELECT count(DISTINCT n) FROM unnest(:'map_added'::oid[]) n) =
+         (SELECT count(*) FROM pgxc_node WHERE node_type = 'D') AS all_nodes;
+SELECT count(*), sum(a) FROM hashmap_tab;
+SELECT hashmap_lost_rows('hashmap_tab', 4, 1000) AS lost;
+
+DROP TABLE hashmap_tab, hashmap_tab2;
+DROP FUNCTION hashmap_bucket_nodes(regclass);
+DROP FUNCTION hashmap_lost_rows(regclass, int, int);
@@ -0,0 +1,147 @@
+--
+-- Statements comparing the distribution column with a parameter
+--
+-- A generic plan of "WHERE a = $1" ships the statement to all the Datanodes
+-- of the table when planning, and the executor sends it to the only one
+-- the bound value is on. A custom plan has the value and prunes the other
+-- Datanodes when planning.
+--
+
+CREATE TABLE dp_hash (a int, b text) DISTRIBUTE BY HASH(a);
+CREATE TABLE dp_mod (a int, b text) DISTRIBUTE BY MODULO(a);
+CREATE TABLE dp_mark (a int) DISTRIBUTE BY REPLICATION;
+INSERT INTO dp_hash SELECT i, 'h' || i FROM generate_series(1, 100) i;
+INSERT INTO dp_mod SELECT i, 'm' || i FROM generate_series(1, 100) i;
+
+-- Datanodes the plan of stmt ships to, "one", "all" or their count, and the
+-- expression choosing one of them when executing
+CREATE FUNCTION dp_explain(stmt text, OUT nodes text, OUT node_expr text)
+LANGUAGE plpgsql AS $$
+DECLARE
+	total	int;
+	ln		text;
+	m		text;
+BEGIN
+	SELECT count(*) INTO total FROM pgxc_node WHERE node_type = 'D';
+	FOR ln IN EXECUTE 'EXPLAIN (verbose, costs off, num_nodes on) ' || stmt LOOP
+		m := substring(ln from ', node count=(\d+)');
+		IF m IS NOT NULL THEN
+			nodes := CASE m::int WHEN 1 THEN 'one' WHEN total THEN 'all' ELSE m END;
+		END IF;
+		m := substring(ln from 'Node expr: (.*)$');
+		IF m IS NOT NULL THEN
+			node_expr := m;
+		END IF;
+	END LOOP;
+END;
+$$;
+
+-- scans of rel on each of its Datanodes in their current transaction
+CREATE FUNCTION dp_scans(rel regclass) RETURNS bigint[]
+LANGUAGE plpgsql AS $$
+DECLARE
+	node	name;
+	scans	bigint;
+	res		bigint[] := '{}';
+BEGIN
+	FOR node IN SELECT n.node_name FROM pgxc_class c, pgxc_node n
+				 WHERE c.pcrelid = rel AND n.oid = ANY (c.nodeoids)
+				 ORDER BY n.node_name LOOP
+		EXECUTE format('EXECUTE DIRECT ON (%I) %L', node,
+					   format('SELECT coalesce(sum(seq_scan), 0) FROM pg_stat_xact_user_tables WHERE relname = %L',
+							  rel::text))
+		   INTO scans;
+		res := res || scans;
+	END LOOP;
+	RETURN res;
+END;
+$$;
+
+-- Datanodes of rel executing stmt scanned, "one", "all" or their count.
+-- Run it after a write to all the Datanodes in a transaction block, their
+-- statistics are not reported until the transaction ends then.
+CREATE FUNCTION dp_run(rel regclass, stmt text) RETURNS text
+LANGUAGE plpgsql AS $$
+DECLARE
+	before	bigint[];
+	after	bigint[];
+	n		int := 0;
+BEGIN
+	before := dp_scans(rel);
+	EXECUTE stmt;
+	after := dp_scans(rel);
+	FOR i IN 1 .. array_length(before, 1) LOOP
+		IF after[i] > before[i] THEN
+			n := n + 1;
+		END IF;
+	END LOOP;
+	RETURN CASE n WHEN 1 THEN 'one'
+				  WHEN array_length(before, 1) THEN 'all'
+				  ELSE n::text END;
+END;
+$$;
+
+-- a custom plan is pruned when planning
+SELECT * FROM dp_explain('SELECT * FROM dp_hash WHERE a = 7');
+SELECT * FROM dp_explain('SELECT * FROM dp_mod WHERE a = 7');
+
+-- a prepared statement on one table tries the generic plan first, and keeps
+-- it while the executor chooses the Datanode
+PREPARE dp_hash_sel(int) AS SELECT * FROM dp_hash WHERE a = $1;
+PREPARE dp_mod_sel(int) AS SELECT * FROM dp_mod WHERE a = $1;
+PREPARE dp_hash_upd(int, text) AS UPDATE dp_hash SET b = $2 WHERE a = $1;
+SELECT * FROM dp_explain('EXECUTE dp_hash_sel(7)');
+SELECT * FROM dp_explain('EXECUTE dp_mod_sel(7)');
+SELECT * FROM dp_explain('EXECUTE dp_hash_upd(7, ''u7'')');
+BEGIN;
+INSERT INTO dp_mark VALUES (1);
+SELECT i, dp_run('dp_hash', format('EXECUTE dp_hash_sel(%s)', i)) AS hash,
+	   dp_run('dp_mod', format('EXECUTE dp_mod_sel(%s)', i)) AS modulo,
+	   dp_run('dp_hash', format('EXECUTE dp_hash_upd(%s, %L)', i, 'u' || i)) AS hash_update
+  FROM generate_series(1, 7) i;
+COMMIT;
+EXECUTE dp_hash_sel(3);
+EXECUTE dp_mod_sel(3);
+SELECT count(*) FROM dp_hash WHERE b = 'u' || a;
+-- still generic
+SELECT * FROM dp_explain('EXECUTE dp_hash_sel(7)');
+
+-- a function runs five custom plans before the generic one, on one
+-- Datanode all the time
+CREATE FUNCTION dp_fn(v int) RETURNS text
+LANGUAGE plpgsql AS $$
+BEGIN
+	RETURN (SELECT b FROM dp_hash WHERE a = v);
+END;
+$$;
+BEGIN;
+INSERT INTO dp_mark VALUES (2);
+SELECT i, dp_run('dp_hash', format('SELECT dp_fn(%s)', i)) AS hash, dp_fn(i)
+  FROM generate_series(11, 18) i;
+COMMIT;
+
+-- a parameter not of the column type is compared in the type of the
+-- operator, the generic plan runs on all the Datanodes
+PREPARE dp_hash_big(bigint) AS SELECT * FROM dp_hash WHERE a = $1;
+EXECUTE dp_hash_big(9);
+EXECUTE dp_hash_big(9);
+EXECUTE dp_hash_big(9);
+EXECUTE dp_hash_big(9);
+EXECUTE dp_hash_big(9);
+SELECT * FROM dp_explain('EXECUTE dp_hash_big(9)');
+BEGIN;
+INSERT INTO dp_mark VALUES (3);
+SELECT dp_run('dp_hash', 'EXECUTE dp_hash_big(9)') AS hash;
+COMMIT;
+EXECUTE dp_hash_big(9);
+EXECUTE dp_hash_big(4294967296);
+
+DEALLOCATE dp_hash_sel;
+DEALLOCATE dp_mod_sel;
+DEALLOCATE dp_hash_upd;
+DEALLOCATE dp_hash_big;
+DROP TABLE dp_hash, dp_mod, dp_mark;
+DROP FUNCTION dp_fn(int);
+DROP FUNCTION dp_run(regclass, text);
+DROP FUNCTION dp_scans(regclass);
+DROP FUNCTION dp_explain(text);
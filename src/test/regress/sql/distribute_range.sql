@@ -0,0 +1,86 @@
+--
+-- DISTRIBUTE BY RANGE
+--
+
+-- Datanodes the plan of a query on range_tab runs on, and its rows
+CREATE FUNCTION range_query(cond text, OUT nodes int, OUT rows bigint)
+LANGUAGE plpgsql AS $$
+DECLARE
+	stmt	text := 'SELECT * FROM range_tab WHERE ' || cond;
+	ln		text;
+	m		text;
+BEGIN
+	FOR ln IN EXECUTE 'EXPLAIN (verbose, costs off, num_nodes on) ' || stmt LOOP
+		m := substring(ln from ', node count=(\d+)');
+		IF m IS NOT NULL THEN
+			nodes := m::int;
+			EXIT;
+		END IF;
+		m := substring(ln from 'Remote node: ([0-9,]+)');
+		IF m IS NOT NULL THEN
+			nodes := array_length(string_to_array(m, ','), 1);
+			EXIT;
+		END IF;
+	END LOOP;
+	EXECUTE 'SELECT count(*) FROM (' || stmt || ') s' INTO rows;
+END;
+$$;
+
+-- rows of range_tab stored on the n-th node of the table
+CREATE FUNCTION range_node_rows(n int, OUT rows bigint, OUT min int, OUT max int, OUT nulls bigint)
+LANGUAGE plpgsql AS $$
+DECLARE
+	node	name;
+BEGIN
+	SELECT node_name INTO node FROM pgxc_node
+	 WHERE oid = (SELECT nodeoids[n - 1] FROM pgxc_class
+				   WHERE pcrelid = 'range_tab'::regclass);
+	EXECUTE format('EXECUTE DIRECT ON (%I) %L', node,
+				   'SELECT count(*), min(a), max(a), count(*) - count(a) FROM range_tab')
+	   INTO rows, min, max, nulls;
+END;
+$$;
+
+-- bounds have to be increasing constants of the column type
+CREATE TABLE range_bad (a int) DISTRIBUTE BY RANGE(a, 10, 5);
+CREATE TABLE range_bad (a int) DISTRIBUTE BY RANGE(a, 10, 10);
+CREATE TABLE range_bad (a int) DISTRIBUTE BY RANGE(a, NULL);
+CREATE TABLE range_bad (a int) DISTRIBUTE BY RANGE(a, random());
+
+-- the first node takes NULL and values below 100, the second one the rest
+DO $$
+DECLARE
+	nodes	text;
+BEGIN
+	SELECT string_agg(quote_ident(node_name), ', ' ORDER BY node_name) INTO nodes
+	  FROM (SELECT node_name FROM pgxc_node WHERE node_type = 'D'
+			 ORDER BY node_name LIMIT 2) s;
+	EXECUTE 'CREATE TABLE range_tab (a int, b text) DISTRIBUTE BY RANGE(a, 100) TO NODE ('
+			|| nodes || ')';
+END;
+$$;
+SELECT pclocatortype, pcrangebounds FROM pgxc_class WHERE pcrelid = 'range_tab'::regclass;
+
+-- routing
+INSERT INTO range_tab SELECT i, 'row ' || i FROM generate_series(1, 200) i;
+INSERT INTO range_tab VALUES (NULL, 'null');
+SELECT count(*), sum(a) FROM range_tab;
+SELECT * FROM range_node_rows(1);
+SELECT * FROM range_node_rows(2);
+
+-- pruning
+SELECT cond, r.nodes, r.rows
+  FROM (VALUES ('a = 50'), ('a = 150'),
+			   ('a < 100'), ('a < 101'), ('a <= 99'), ('a <= 100'), ('a >= 100'),
+			   ('a BETWEEN 100 AND 200'), ('a BETWEEN 50 AND 150'),
+			   ('a IN (1, 2, 99)'), ('a IN (100, 200)'), ('a IN (1, 200)')) AS v(cond),
+	   LATERAL range_query(cond) r;
+UPDATE range_tab SET b = 'updated' WHERE a BETWEEN 95 AND 105;
+SELECT count(*) FROM range_tab WHERE b = 'updated';
+DELETE FROM range_tab WHERE a <= 10;
+SELECT * FROM range_node_rows(1);
+SELECT * FROM range_node_rows(2);
+
+DROP TABLE range_tab;
+DROP FUNCTION range_query(text);
+DROP FUNCTION range_node_rows(int);
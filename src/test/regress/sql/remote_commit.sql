@@ -0,0 +1,62 @@
+--
+-- Commit of a transaction on Datanodes
+--
+-- Only the Datanodes which wrote are prepared, and not even them when
+-- a single node wrote and Coordinator did not. PREPARE TRANSACTION fails
+-- on a Datanode whose transaction ran NOTIFY, so a NOTIFY on each node
+-- not prepared shows it is committed without two-phase commit.
+--
+
+-- a table on each of two Datanodes
+DO $$
+DECLARE
+	nodes	name[];
+BEGIN
+	SELECT array_agg(node_name ORDER BY node_name) INTO nodes
+	  FROM pgxc_node WHERE node_type = 'D';
+	EXECUTE format('CREATE TABLE rc_first (a int) DISTRIBUTE BY HASH(a) TO NODE (%I)',
+				   nodes[1]);
+	EXECUTE format('CREATE TABLE rc_second (a int) DISTRIBUTE BY HASH(a) TO NODE (%I)',
+				   nodes[2]);
+END;
+$$;
+
+-- NOTIFY in the transaction of the Datanode of rel
+CREATE FUNCTION rc_notify(rel regclass) RETURNS void
+LANGUAGE plpgsql AS $$
+DECLARE
+	node	name;
+BEGIN
+	SELECT n.node_name INTO node FROM pgxc_class c, pgxc_node n
+	 WHERE c.pcrelid = rel AND n.oid = c.nodeoids[0];
+	EXECUTE format('EXECUTE DIRECT ON (%I) %L', node,
+				   'SELECT pg_notify(''remote_commit'', '''')');
+END;
+$$;
+
+-- one node wrote, the other one read
+BEGIN;
+INSERT INTO rc_first VALUES (1);
+SELECT count(*) FROM rc_second;
+SELECT rc_notify('rc_first'), rc_notify('rc_second');
+COMMIT;
+SELECT count(*) FROM rc_first;
+
+-- Coordinator wrote too, the written node is prepared, the read one not
+BEGIN;
+INSERT INTO rc_first VALUES (2);
+SELECT count(*) FROM rc_second;
+SELECT pg_logical_emit_message(true, 'remote_commit', 'x') IS NOT NULL AS logged;
+SELECT rc_notify('rc_second');
+COMMIT;
+SELECT count(*) FROM rc_first;
+
+-- both nodes wrote, both are prepared
+BEGIN;
+INSERT INTO rc_first VALUES (3);
+INSERT INTO rc_second VALUES (3);
+COMMIT;
+SELECT (SELECT count(*) FROM rc_first) AS first, (SELECT count(*) FROM rc_second) AS second;
+
+DROP TABLE rc_first, rc_second;
+DROP FUNCTION rc_notify(regclass);
@@ -0,0 +1,102 @@
+--
+-- Statements prepared on remote sessions for shipped queries
+--
+-- A shipped query having parameters is prepared once on the remote session
+-- and executed by name later, the name is "adb_stmt_<pid>_<n>" where pid
+-- is the one of Coordinator backend. Functions below run their query by a
+-- custom plan for the first five calls, then by a generic one having
+-- parameters.
+--
+
+-- a table on one Datanode
+DO $$
+DECLARE
+	node	name;
+BEGIN
+	SELECT min(node_name) INTO node FROM pgxc_node WHERE node_type = 'D';
+	EXECUTE format('CREATE TABLE rs_tab (a int, b int) DISTRIBUTE BY HASH(a) TO NODE (%I)',
+				   node);
+END;
+$$;
+INSERT INTO rs_tab SELECT i, i % 10 FROM generate_series(1, 100) i;
+
+-- operators of statements backend pid prepared on the Datanode of rs_tab
+CREATE FUNCTION rs_stmts(pid int DEFAULT pg_backend_pid()) RETURNS text
+LANGUAGE plpgsql AS $$
+DECLARE
+	node	name;
+	query	text;
+	res		text;
+BEGIN
+	SELECT n.node_name INTO node FROM pgxc_class c, pgxc_node n
+	 WHERE c.pcrelid = 'rs_tab'::regclass AND n.oid = c.nodeoids[0];
+	query := format('SELECT string_agg(op, %L ORDER BY op COLLATE "C") FROM '
+					'(SELECT substring(statement from %L) AS op '
+					'FROM pg_prepared_statements WHERE name LIKE %L) s',
+					',', '[<>=]', 'adb\_stmt\_' || pid || '\_%');
+	EXECUTE format('EXECUTE DIRECT ON (%I) %L', node, query) INTO res;
+	RETURN coalesce(res, '-');
+END;
+$$;
+
+CREATE FUNCTION rs_eq(v int) RETURNS bigint
+LANGUAGE plpgsql AS $$
+BEGIN
+	RETURN (SELECT count(*) FROM rs_tab WHERE b = v);
+END;
+$$;
+CREATE FUNCTION rs_lt(v int) RETURNS bigint
+LANGUAGE plpgsql AS $$
+BEGIN
+	RETURN (SELECT count(*) FROM rs_tab WHERE b < v);
+END;
+$$;
+CREATE FUNCTION rs_gt(v int) RETURNS bigint
+LANGUAGE plpgsql AS $$
+BEGIN
+	RETURN (SELECT count(*) FROM rs_tab WHERE b > v);
+END;
+$$;
+
+-- a query of a custom plan has no parameters, it is not cached
+SELECT sum(rs_eq(3)) FROM generate_series(1, 5);
+SELECT rs_stmts();
+-- the generic plan is prepared once and reused by later calls
+SELECT sum(rs_eq(3)) FROM generate_series(1, 3);
+SELECT rs_stmts();
+SELECT sum(rs_eq(i % 10)) FROM generate_series(1, 10) i;
+SELECT rs_stmts();
+SELECT sum(rs_lt(3)) FROM generate_series(1, 8);
+SELECT rs_stmts();
+
+-- a full cache closes the least recently used statement for a new one
+SET remote_statement_cache_size = 2;
+SELECT sum(rs_gt(3)) FROM generate_series(1, 8);
+SELECT rs_stmts();
+SELECT rs_lt(5);
+SELECT rs_eq(5);
+SELECT rs_stmts();
+-- but not one used by current transaction, the new one is not cached
+BEGIN;
+SELECT rs_lt(5), rs_eq(5);
+SELECT rs_gt(5);
+SELECT rs_stmts();
+COMMIT;
+SELECT rs_gt(5);
+SELECT rs_stmts();
+RESET remote_statement_cache_size;
+
+-- statements of a backend are gone once pool manager resets its sessions,
+-- the session taken by a new backend has a new epoch and nothing cached
+SELECT pg_backend_pid() AS rs_old_pid \gset
+\c -
+SELECT rs_stmts(:rs_old_pid);
+SELECT rs_stmts();
+SELECT sum(rs_eq(3)) FROM generate_series(1, 8);
+SELECT rs_stmts();
+
+DROP TABLE rs_tab;
+DROP FUNCTION rs_eq(int);
+DROP FUNCTION rs_lt(int);
+DROP FUNCTION rs_gt(int);
+DROP FUNCTION rs_stmts(int);